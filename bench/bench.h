@@ -0,0 +1,54 @@
+#ifndef PEGAS_BENCH_BENCH_H
+#define PEGAS_BENCH_BENCH_H
+#pragma once
+
+//-----------------------------------------------------------------------------
+//	Shared parts of the benchmarks: the timer and the list of the IPhysics
+//	implementations the physics benchmarks compare. A new implementation
+//	goes to k_physicsImplementations, the first one is the reference.
+//-----------------------------------------------------------------------------
+#include "common.h"
+#include "physics/base_physics.h"
+
+#include <time.h>
+
+namespace pegas
+{
+namespace bench
+{
+	//seconds of the monotonic clock
+	inline double now()
+	{
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+
+		return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+	}
+
+	struct PhysicsImplementation
+	{
+		//class name, as in the JSON output
+		const char* _name;
+		//class name and broadphase, as in the tables
+		const char* _label;
+		IPhysics* (*_create)();
+	};
+
+	template<class Physics>
+	IPhysics* createPhysics()
+	{
+		return new Physics();
+	}
+
+	static const PhysicsImplementation k_physicsImplementations[] = {
+		{ "BasePhysics", "BasePhysics (cell grid)", &createPhysics<BasePhysics> },
+		{ "BasePhysics2", "BasePhysics2 (quad tree)", &createPhysics<BasePhysics2> },
+		{ "BasePhysics2BVH", "BasePhysics2BVH (aabb tree)", &createPhysics<BasePhysics2BVH> },
+		{ "BasePhysics3", "BasePhysics3 (sweep and prune)", &createPhysics<BasePhysics3> }
+	};
+
+	static const int32 k_numPhysicsImplementations = sizeof(k_physicsImplementations) / sizeof(k_physicsImplementations[0]);
+}
+}
+
+#endif
@@ -0,0 +1,220 @@
+//-----------------------------------------------------------------------------
+//	Broadphase comparison on a flappy birds like scene: columns (polygons of
+//	the obstacle and trigger groups) scroll to the left with a constant speed
+//	and wrap around, birds (circles) fly up and down across them.
+//	Runs BasePhysics (CellGrid), BasePhysics2 (QuadTree), BasePhysics2BVH
+//	(AABBTree) and BasePhysics3 (sweep and prune) through IPhysics and prints the time per frame and
+//	the per frame averages of the physics stats (IPhysics::getStats), then
+//	runs BasePhysics2 with 0, 1, 3 and 7 narrowphase worker threads and
+//	checks that every run reports the same pairs in the same order.
+//
+//	usage: physics_broadphase_bench [numColumns] [numBirds] [numFrames]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/base_physics.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	enum
+	{
+		k_groupBird = 1,
+		k_groupObstacle = 2,
+		k_groupTrigger = 3
+	};
+
+	const float k_worldHalfSize = 5000.0f;
+	const float k_columnSpacing = 200.0f;
+	const float k_columnWidth = 40.0f;
+	const float k_windowHeight = 160.0f;
+	const float k_scrollSpeed = 3.0f;
+	const float k_birdRadius = 20.0f;
+
+	void makeBox(IPhysics::PointList& points, float x1, float y1, float x2, float y2)
+	{
+		points.clear();
+		points.push_back(Vector3(x1, y1, 0.0f));
+		points.push_back(Vector3(x2, y1, 0.0f));
+		points.push_back(Vector3(x2, y2, 0.0f));
+		points.push_back(Vector3(x1, y2, 0.0f));
+	}
+
+	struct Result
+	{
+		double _msPerFrame;
+		int32 _pairsReported;
+		int32 _pairsEnded;
+		uint32 _pairsChecksum;
+		//sum of the stats of all frames
+		IPhysics::Stats _stats;
+	};
+
+	//FNV-1a over the pairs in the order they are reported
+	void addToChecksum(uint32& checksum, const IPhysics::CollisionPairList& pairs)
+	{
+		for(IPhysics::CollisionPairList::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+		{
+			checksum = (checksum ^ (uint32)it->first) * 16777619u;
+			checksum = (checksum ^ (uint32)it->second) * 16777619u;
+		}
+	}
+
+	Result run(IPhysics* physics, int32 numColumns, int32 numBirds, int32 numFrames)
+	{
+		Rect2D worldArea(Point2D(-k_worldHalfSize, -k_worldHalfSize),
+				Point2D(k_worldHalfSize, k_worldHalfSize));
+		physics->create(worldArea);
+
+		physics->setCollisionGroupFlag(k_groupBird, true);
+		physics->setCollisionGroupFlag(k_groupObstacle, false);
+		physics->setCollisionGroupFlag(k_groupTrigger, false);
+		physics->setCollisionPairGroupFlag(k_groupBird, k_groupObstacle, true);
+		physics->setCollisionPairGroupFlag(k_groupBird, k_groupTrigger, true);
+		physics->setCollisionPairGroupFlag(k_groupTrigger, k_groupObstacle, false);
+
+		//columns are laid out in up to 15 rows 600 units apart,
+		//long rows get denser to stay inside the world area
+		const int32 columnsPerRow = std::max(40, (numColumns + 14) / 15);
+		const float rowHeight = 600.0f;
+		const float columnSpacing = std::min(k_columnSpacing, 9000.0f / columnsPerRow);
+		const float scrollRange = columnsPerRow * columnSpacing;
+
+		int32 nextId = 1;
+		IPhysics::PointList points;
+		std::vector<float> columnX(numColumns);
+		std::vector<float> columnX0(numColumns);
+
+		for(int32 i = 0; i < numColumns; i++)
+		{
+			float x = -scrollRange * 0.5f + (i % columnsPerRow) * columnSpacing;
+			float y = -k_worldHalfSize + 400.0f + (i / columnsPerRow) * rowHeight;
+			float windowY = y + ((i * 37) % 5) * 20.0f;
+
+			columnX[i] = columnX0[i] = x;
+
+			makeBox(points, x, y - 300.0f, x + k_columnWidth, windowY - k_windowHeight * 0.5f);
+			physics->registerPoligon(nextId++, k_groupObstacle, points);
+
+			makeBox(points, x, windowY + k_windowHeight * 0.5f, x + k_columnWidth, y + 300.0f);
+			physics->registerPoligon(nextId++, k_groupObstacle, points);
+
+			makeBox(points, x + k_columnWidth, windowY - k_windowHeight * 0.5f,
+					x + k_columnWidth + 10.0f, windowY + k_windowHeight * 0.5f);
+			physics->registerPoligon(nextId++, k_groupTrigger, points);
+		}
+
+		int32 firstBirdId = nextId;
+		int32 numRows = (numColumns + columnsPerRow - 1) / columnsPerRow;
+		for(int32 i = 0; i < numBirds; i++)
+		{
+			physics->registerCircle(nextId++, k_groupBird, Vector3(), k_birdRadius);
+		}
+
+		Result result;
+		result._pairsReported = 0;
+		result._pairsEnded = 0;
+		result._pairsChecksum = 2166136261u;
+		PhysicsStats::reset(result._stats);
+
+		double startTime = bench::now();
+		for(int32 frame = 0; frame < numFrames; frame++)
+		{
+			for(int32 i = 0; i < numColumns; i++)
+			{
+				columnX[i] -= k_scrollSpeed;
+				if(columnX[i] < -scrollRange * 0.5f)
+				{
+					columnX[i] += scrollRange;
+				}
+
+				Vector3 offset(columnX[i] - columnX0[i], 0.0f, 0.0f);
+				int32 id = 1 + i * 3;
+				physics->moveObject(id, offset, true);
+				physics->moveObject(id + 1, offset, true);
+				physics->moveObject(id + 2, offset, true);
+			}
+
+			for(int32 i = 0; i < numBirds; i++)
+			{
+				int32 row = i % numRows;
+				float x = -100.0f + (i / numRows) * 53.0f;
+				float y = -k_worldHalfSize + 400.0f + row * rowHeight
+						+ 150.0f * sinf((frame + i * 13) * 0.05f);
+
+				physics->moveObject(firstBirdId + i, Vector3(x, y, 0.0f), true);
+			}
+
+			physics->update();
+			result._pairsReported += physics->getCollidedPairs().size();
+			result._pairsEnded += physics->getContactEndPairs().size();
+			addToChecksum(result._pairsChecksum, physics->getCollidedPairs());
+			addToChecksum(result._pairsChecksum, physics->getContactEndPairs());
+			PhysicsStats::accumulate(result._stats, physics->getStats());
+		}
+		double elapsed = bench::now() - startTime;
+
+		physics->destroy();
+
+		result._msPerFrame = elapsed * 1.0e3 / numFrames;
+
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numColumns = (argc > 1) ? atoi(argv[1]) : 400;
+	int32 numBirds = (argc > 2) ? atoi(argv[2]) : 16;
+	int32 numFrames = (argc > 3) ? atoi(argv[3]) : 300;
+
+	printf("columns: %d (%d hulls), birds: %d, frames: %d\n",
+			numColumns, numColumns * 3 + numBirds, numBirds, numFrames);
+
+	for(int32 i = 0; i < bench::k_numPhysicsImplementations; i++)
+	{
+		const bench::PhysicsImplementation& implementation = bench::k_physicsImplementations[i];
+		IPhysics* physics = implementation._create();
+		Result result = run(physics, numColumns, numBirds, numFrames);
+		delete physics;
+
+		printf("%-32s %10.4f ms/frame %8d pairs %8d ended\n", implementation._label,
+				result._msPerFrame, result._pairsReported, result._pairsEnded);
+
+		const IPhysics::Stats& stats = result._stats;
+		double frames = std::max(stats._numUpdates, 1);
+		printf("  per frame: %.1f candidates, %.1f tests, %.1f hits, %.1f nodes visited, %.1f reinsertions; "
+				"ms: broadphase %.4f, narrowphase %.4f, sweep %.4f, contacts %.4f\n",
+				stats._numCandidatePairs / frames, PhysicsStats::getNumTests(stats) / frames, stats._numHits / frames,
+				stats._numNodesVisited / frames, stats._numReinsertions / frames,
+				stats._phaseTime[IPhysics::Stats::k_phaseBroadphase] * 1.0e3 / frames,
+				stats._phaseTime[IPhysics::Stats::k_phaseNarrowphase] * 1.0e3 / frames,
+				stats._phaseTime[IPhysics::Stats::k_phaseSweep] * 1.0e3 / frames,
+				stats._phaseTime[IPhysics::Stats::k_phaseContacts] * 1.0e3 / frames);
+	}
+
+	printf("BasePhysics2 narrowphase threads (%d processors):\n", WorkerPool::getNumProcessors());
+
+	const int32 numThreads[] = { 0, 1, 3, 7 };
+	uint32 referenceChecksum = 0;
+
+	for(int32 i = 0; i < (int32)(sizeof(numThreads) / sizeof(numThreads[0])); i++)
+	{
+		BasePhysics2 physics;
+		physics.setNumWorkerThreads(numThreads[i]);
+
+		Result result = run(&physics, numColumns, numBirds, numFrames);
+		if(i == 0)
+		{
+			referenceChecksum = result._pairsChecksum;
+		}
+
+		printf("  %d worker threads %21s %10.4f ms/frame %8d pairs %8d ended  %s\n", numThreads[i], "",
+				result._msPerFrame, result._pairsReported, result._pairsEnded,
+				(result._pairsChecksum == referenceChecksum) ? "same pairs" : "PAIRS DIFFER");
+	}
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+//	Continuous collision: birds (circles) fly to the right through a row of
+//	thin columns, moving by a fixed step per physics update. With steps
+//	longer than a column plus the bird diameter a test of the final
+//	positions alone misses most of the columns; the swept test must report
+//	every bird/column pair on the way. Runs BasePhysics (CellGrid),
+//	BasePhysics2 (QuadTree), BasePhysics2BVH (AABBTree) and BasePhysics3
+//	(sweep and prune) with a slow and a fast step and prints the time per
+//	update and the missed pairs.
+//
+//	usage: physics_ccd_bench [numColumns] [numBirds]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/base_physics.h"
+#include "physics/collision_pairs.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	enum
+	{
+		k_groupBird = 1,
+		k_groupColumn = 2
+	};
+
+	const float k_worldHalfSize = 5000.0f;
+	const float k_columnSpacing = 100.0f;
+	const float k_columnWidth = 10.0f;
+	const float k_columnHalfHeight = 1000.0f;
+	const float k_birdRadius = 20.0f;
+	const float k_startX = -4900.0f;
+
+	struct Result
+	{
+		double _msPerUpdate;
+		int32 _numExpected;
+		int32 _numMissed;
+	};
+
+	Result run(IPhysics* physics, int32 numColumns, int32 numBirds, float step)
+	{
+		Rect2D worldArea(Point2D(-k_worldHalfSize, -k_worldHalfSize),
+				Point2D(k_worldHalfSize, k_worldHalfSize));
+		physics->create(worldArea);
+
+		physics->setCollisionGroupFlag(k_groupBird, true);
+		physics->setCollisionGroupFlag(k_groupColumn, false);
+		physics->setCollisionPairGroupFlag(k_groupBird, k_groupColumn, true);
+
+		int32 nextId = 1;
+		for(int32 i = 0; i < numColumns; i++)
+		{
+			float x = k_startX + 100.0f + i * k_columnSpacing;
+			Rect2D box(Point2D(x, -k_columnHalfHeight), Point2D(x + k_columnWidth, k_columnHalfHeight));
+			physics->registerBox(nextId++, k_groupColumn, box);
+		}
+
+		int32 firstBirdId = nextId;
+		for(int32 i = 0; i < numBirds; i++)
+		{
+			float y = -k_columnHalfHeight + 50.0f + i * ((2.0f * k_columnHalfHeight - 100.0f) / numBirds);
+			physics->registerCircle(nextId++, k_groupBird, Vector3(k_startX, y, 0.0f), k_birdRadius);
+		}
+
+		//the first update gives the birds their previous positions
+		physics->update();
+
+		CollisionPairSet reported;
+		float endX = k_startX + 200.0f + numColumns * k_columnSpacing;
+		int32 numUpdates = 0;
+
+		double startTime = bench::now();
+		for(float x = k_startX + step; x < endX; x += step)
+		{
+			for(int32 i = 0; i < numBirds; i++)
+			{
+				physics->moveObject(firstBirdId + i, Vector3(x - k_startX, 0.0f, 0.0f), true);
+			}
+
+			physics->update();
+			numUpdates++;
+
+			IPhysics::CollisionPairList& pairs = physics->getCollidedPairs();
+			for(IPhysics::CollisionPairList::iterator it = pairs.begin(); it != pairs.end(); ++it)
+			{
+				reported.insert(CollisionPairSet::makeKey(it->first, it->second));
+			}
+		}
+		double elapsed = bench::now() - startTime;
+
+		physics->destroy();
+
+		//every bird passes every column
+		Result result;
+		result._msPerUpdate = elapsed * 1.0e3 / std::max(numUpdates, 1);
+		result._numExpected = numColumns * numBirds;
+		result._numMissed = 0;
+
+		for(int32 i = 0; i < numColumns; i++)
+		{
+			for(int32 j = 0; j < numBirds; j++)
+			{
+				if(!reported.contains(CollisionPairSet::makeKey(1 + i, firstBirdId + j)))
+				{
+					result._numMissed++;
+				}
+			}
+		}
+
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numColumns = (argc > 1) ? atoi(argv[1]) : 90;
+	int32 numBirds = (argc > 2) ? atoi(argv[2]) : 32;
+
+	printf("columns: %d (%.0f wide), birds: %d (radius %.0f)\n",
+			numColumns, k_columnWidth, numBirds, k_birdRadius);
+
+	//the slow step is under the sweep threshold, the fast one
+	//jumps over a column and a half per update
+	const float steps[] = { 8.0f, 150.0f };
+
+	for(int32 s = 0; s < 2; s++)
+	{
+		printf("step %.0f per update:\n", steps[s]);
+
+		for(int32 i = 0; i < bench::k_numPhysicsImplementations; i++)
+		{
+			const bench::PhysicsImplementation& implementation = bench::k_physicsImplementations[i];
+			IPhysics* physics = implementation._create();
+			Result result = run(physics, numColumns, numBirds, steps[s]);
+			delete physics;
+
+			printf("  %-32s %10.4f ms/update %8d pairs %8d missed\n", implementation._label,
+					result._msPerUpdate, result._numExpected, result._numMissed);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+//-----------------------------------------------------------------------------
+//	Micro-benchmark of CollisionKernels: circle against polygons (boxes and
+//	hexagons, so both the vector loop and the scalar tail run) and batched
+//	circle/circle tests. Every test runs through the scalar and the vector
+//	kernel, results are compared (they must match exactly) and also checked
+//	against Intersections on PoligonCollisionHull/CircleCollisionHull.
+//
+//	usage: physics_kernels_bench [numPolygons] [numRounds]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/collisions.h"
+#include "physics/collision_kernels.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	float random(float minValue, float maxValue)
+	{
+		return minValue + (maxValue - minValue) * (rand() / (float)RAND_MAX);
+	}
+
+	//polygons packed the same way CollisionWorld packs them
+	struct PolygonSet
+	{
+		std::vector<float> _vertexX;
+		std::vector<float> _vertexY;
+		std::vector<float> _a;
+		std::vector<float> _b;
+		std::vector<float> _c;
+		std::vector<float> _lengthSq;
+		std::vector<int32> _first;
+		std::vector<int32> _numEdges;
+
+		void add(const IPhysics::PointList& points)
+		{
+			int32 first = _vertexX.size();
+			int32 numPoints = points.size();
+
+			for(int32 i = 0; i < numPoints; i++)
+			{
+				const Vector3& p0 = points[i];
+				const Vector3& p1 = points[(i == (numPoints - 1)) ? 0 : i + 1];
+
+				float a = p0._y - p1._y;
+				float b = p1._x - p0._x;
+
+				_vertexX.push_back(p0._x);
+				_vertexY.push_back(p0._y);
+				_a.push_back(a);
+				_b.push_back(b);
+				_c.push_back((p0._x * p1._y) - (p1._x * p0._y));
+				_lengthSq.push_back((a * a) + (b * b));
+			}
+
+			_first.push_back(first);
+			_numEdges.push_back(numPoints);
+		}
+
+		CollisionKernels::EdgeArrays getEdges() const
+		{
+			CollisionKernels::EdgeArrays edges;
+			edges._vertexX = &_vertexX[0];
+			edges._vertexY = &_vertexY[0];
+			edges._a = &_a[0];
+			edges._b = &_b[0];
+			edges._c = &_c[0];
+			edges._lengthSq = &_lengthSq[0];
+
+			return edges;
+		}
+	};
+
+	void makePolygon(IPhysics::PointList& points, float x, float y, int32 numPoints)
+	{
+		//clockwise in screen coordinates, like the game's boxes
+		float radius = random(10.0f, 40.0f);
+
+		points.clear();
+		for(int32 i = 0; i < numPoints; i++)
+		{
+			float angle = -i * (2.0f * 3.14159265f / numPoints);
+			points.push_back(Vector3(x + radius * cos(angle), y + radius * sin(angle), 0.0f));
+		}
+	}
+
+	typedef bool (*CirclePolygonKernel)(float, float, float, const CollisionKernels::EdgeArrays&, int32, int32);
+	typedef void (*CircleCircleKernel)(const float*, const float*, const float*,
+			const float*, const float*, const float*, int32, uint8*);
+}
+
+int main(int argc, char** argv)
+{
+	int32 numPolygons = (argc > 1) ? atoi(argv[1]) : 4096;
+	int32 numRounds = (argc > 2) ? atoi(argv[2]) : 200;
+
+	srand(1);
+
+#if defined(PEGAS_USE_SSE2)
+	printf("vector kernels: SSE2\n");
+#elif defined(PEGAS_USE_NEON)
+	printf("vector kernels: NEON\n");
+#else
+	printf("vector kernels: none (scalar fallback)\n");
+#endif
+
+	//one circle per polygon, placed near it
+	PolygonSet polygons;
+	std::vector<float> circleX, circleY, circleR;
+	std::vector<float> otherX, otherY, otherR;
+	std::vector<ICollisionHull*> polygonHulls, circleHulls;
+	IPhysics::PointList points;
+
+	for(int32 i = 0; i < numPolygons; i++)
+	{
+		float x = random(-1000.0f, 1000.0f);
+		float y = random(-1000.0f, 1000.0f);
+
+		makePolygon(points, x, y, (i % 2) ? 6 : 4);
+		polygons.add(points);
+		polygonHulls.push_back(new PoligonCollisionHull(i * 2 + 1, 0, points));
+
+		Vector3 position(x + random(-60.0f, 60.0f), y + random(-60.0f, 60.0f), 0.0f);
+		float radius = random(5.0f, 20.0f);
+
+		circleX.push_back(position._x);
+		circleY.push_back(position._y);
+		circleR.push_back(radius);
+		circleHulls.push_back(new CircleCollisionHull(i * 2 + 2, 0, position, radius));
+
+		otherX.push_back(position._x + random(-40.0f, 40.0f));
+		otherY.push_back(position._y + random(-40.0f, 40.0f));
+		otherR.push_back(random(5.0f, 20.0f));
+	}
+
+	CollisionKernels::EdgeArrays edges = polygons.getEdges();
+
+	//circle against polygons
+	const char* names[2] = { "circle/polygon scalar", "circle/polygon vector" };
+	CirclePolygonKernel kernels[2] = { &CollisionKernels::circlePolygonScalar, &CollisionKernels::circlePolygon };
+	std::vector<uint8> results[2];
+
+	for(int32 k = 0; k < 2; k++)
+	{
+		results[k].resize(numPolygons);
+
+		int32 hits = 0;
+		double start = bench::now();
+
+		for(int32 round = 0; round < numRounds; round++)
+		{
+			hits = 0;
+			for(int32 i = 0; i < numPolygons; i++)
+			{
+				results[k][i] = kernels[k](circleX[i], circleY[i], circleR[i],
+						edges, polygons._first[i], polygons._numEdges[i]) ? 1 : 0;
+				hits += results[k][i];
+			}
+		}
+
+		double ns = (bench::now() - start) * 1.0e9 / ((double)numRounds * numPolygons);
+		printf("%-24s %8.2f ns/test %8d hits\n", names[k], ns, hits);
+	}
+
+	int32 mismatches = 0;
+	int32 hullMismatches = 0;
+	for(int32 i = 0; i < numPolygons; i++)
+	{
+		mismatches += (results[0][i] != results[1][i]) ? 1 : 0;
+
+		uint8 hullResult = Intersections::isIntersects(circleHulls[i], polygonHulls[i]) ? 1 : 0;
+		hullMismatches += (results[0][i] != hullResult) ? 1 : 0;
+	}
+	printf("circle/polygon mismatches: vector %d, Intersections %d\n", mismatches, hullMismatches);
+
+	//circle against circle, every circle against one more circle near it
+	const char* circleNames[2] = { "circle/circle scalar", "circle/circle vector" };
+	CircleCircleKernel circleKernels[2] = { &CollisionKernels::circleCircleScalar, &CollisionKernels::circleCircle };
+	int32 numPairs = numPolygons;
+	std::vector<uint8> circleResults[2];
+
+	for(int32 k = 0; k < 2; k++)
+	{
+		circleResults[k].resize(numPairs);
+
+		double start = bench::now();
+
+		for(int32 round = 0; round < numRounds; round++)
+		{
+			for(int32 i = 0; i < numPairs; i += CollisionKernels::k_batchSize)
+			{
+				int32 count = std::min((int32)CollisionKernels::k_batchSize, numPairs - i);
+
+				circleKernels[k](&circleX[i], &circleY[i], &circleR[i],
+						&otherX[i], &otherY[i], &otherR[i], count, &circleResults[k][i]);
+			}
+		}
+
+		int32 hits = 0;
+		for(int32 i = 0; i < numPairs; i++)
+		{
+			hits += circleResults[k][i];
+		}
+
+		double ns = (bench::now() - start) * 1.0e9 / ((double)numRounds * numPairs);
+		printf("%-24s %8.2f ns/test %8d hits\n", circleNames[k], ns, hits);
+	}
+
+	mismatches = 0;
+	hullMismatches = 0;
+	for(int32 i = 0; i < numPairs; i++)
+	{
+		mismatches += (circleResults[0][i] != circleResults[1][i]) ? 1 : 0;
+
+		CircleCollisionHull other(1, 0, Vector3(otherX[i], otherY[i], 0.0f), otherR[i]);
+
+		uint8 hullResult = Intersections::isIntersects(circleHulls[i], &other) ? 1 : 0;
+		hullMismatches += (circleResults[0][i] != hullResult) ? 1 : 0;
+	}
+	printf("circle/circle mismatches: vector %d, Intersections %d\n", mismatches, hullMismatches);
+
+	for(int32 i = 0; i < numPolygons; i++)
+	{
+		delete polygonHulls[i];
+		delete circleHulls[i];
+	}
+
+	return 0;
+}
@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------------------
+//	Narrowphase cost per pair: runs the Intersections tests (point/polygon,
+//	circle/polygon, polygon/polygon, circle/box, type dispatch) and the CollisionWorld kernels over
+//	random hulls and counts heap allocations made during the tests.
+//	Global operator new is replaced to count the allocations, a test that
+//	allocates shows up as a non zero "allocs/pair".
+//
+//	usage: physics_narrowphase_bench [numPairs] [numRounds]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/collisions.h"
+#include "physics/collision_world.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+namespace
+{
+	long s_numAllocations = 0;
+}
+
+void* operator new(size_t size)
+{
+	s_numAllocations++;
+
+	void* p = malloc(size > 0 ? size : 1);
+	if(p == NULL)
+	{
+		throw std::bad_alloc();
+	}
+
+	return p;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+	free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+	free(p);
+}
+
+using namespace pegas;
+
+namespace
+{
+	typedef bool (*Checker)(ICollisionHull*, ICollisionHull*);
+
+	float random(float minValue, float maxValue)
+	{
+		return minValue + (maxValue - minValue) * (rand() / (float)RAND_MAX);
+	}
+
+	void makePolygon(IPhysics::PointList& points, float x, float y)
+	{
+		//convex hexagon of random size, clockwise in screen coordinates
+		float radius = random(10.0f, 40.0f);
+
+		points.clear();
+		for(int32 i = 0; i < 6; i++)
+		{
+			float angle = -i * (2.0f * 3.14159265f / 6.0f);
+			points.push_back(Vector3(x + radius * cos(angle), y + radius * sin(angle), 0.0f));
+		}
+	}
+
+	void makeRect(IPhysics::PointList& points, float x, float y)
+	{
+		float halfWidth = random(10.0f, 40.0f);
+		float halfHeight = random(10.0f, 80.0f);
+
+		Rect2D box(Point2D(x - halfWidth, y - halfHeight), Point2D(x + halfWidth, y + halfHeight));
+		BoxCollisionHull::makePoints(box, points);
+	}
+
+	struct Result
+	{
+		double _nsPerPair;
+		double _allocsPerPair;
+		int32 _hits;
+	};
+
+	Result runIntersections(Checker checker, std::vector<ICollisionHull*>& a,
+			std::vector<ICollisionHull*>& b, int32 numRounds)
+	{
+		Result result;
+		result._hits = 0;
+
+		long allocations = s_numAllocations;
+		double start = bench::now();
+
+		for(int32 round = 0; round < numRounds; round++)
+		{
+			for(size_t i = 0; i < a.size(); i++)
+			{
+				if(checker(a[i], b[i]))
+				{
+					result._hits++;
+				}
+			}
+		}
+
+		double numTests = (double)numRounds * a.size();
+		result._nsPerPair = (bench::now() - start) * 1.0e9 / numTests;
+		result._allocsPerPair = (s_numAllocations - allocations) / numTests;
+
+		return result;
+	}
+
+	Result runWorld(CollisionWorld& world, int32 numPairs, int32 numRounds)
+	{
+		Result result;
+		result._hits = 0;
+
+		long allocations = s_numAllocations;
+		double start = bench::now();
+
+		for(int32 round = 0; round < numRounds; round++)
+		{
+			for(int32 i = 0; i < numPairs; i++)
+			{
+				if(world.isIntersects(i * 2, i * 2 + 1))
+				{
+					result._hits++;
+				}
+			}
+		}
+
+		double numTests = (double)numRounds * numPairs;
+		result._nsPerPair = (bench::now() - start) * 1.0e9 / numTests;
+		result._allocsPerPair = (s_numAllocations - allocations) / numTests;
+
+		return result;
+	}
+
+	void print(const char* name, const Result& result)
+	{
+		printf("%-28s %10.1f ns/pair %8.3f allocs/pair %8d hits\n",
+				name, result._nsPerPair, result._allocsPerPair, result._hits);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	int32 numPairs = (argc > 1) ? atoi(argv[1]) : 4096;
+	int32 numRounds = (argc > 2) ? atoi(argv[2]) : 100;
+
+	srand(1);
+
+	std::vector<ICollisionHull*> points, circles, polygonsA, polygonsB, rectPolygons, boxes;
+	CollisionWorld pointWorld, circleWorld, polygonWorld, boxWorld;
+	IPhysics::PointList vertices;
+
+	for(int32 i = 0; i < numPairs; i++)
+	{
+		int32 id = i * 2;
+
+		//second hull of the pair lies near the first one, about a half of pairs overlap
+		float x = random(-1000.0f, 1000.0f);
+		float y = random(-1000.0f, 1000.0f);
+		float dx = random(-60.0f, 60.0f);
+		float dy = random(-60.0f, 60.0f);
+
+		Vector3 position(x + dx, y + dy, 0.0f);
+		float radius = random(5.0f, 20.0f);
+
+		makePolygon(vertices, x, y);
+		polygonsA.push_back(new PoligonCollisionHull(id, 0, vertices));
+		pointWorld.createPolygon(id, 0, vertices);
+		circleWorld.createPolygon(id, 0, vertices);
+		polygonWorld.createPolygon(id, 0, vertices);
+
+		points.push_back(new PointCollisionHull(id + 1, 0, position));
+		pointWorld.createPoint(id + 1, 0, position);
+
+		circles.push_back(new CircleCollisionHull(id + 1, 0, position, radius));
+		circleWorld.createCircle(id + 1, 0, position, radius);
+
+		makePolygon(vertices, position._x, position._y);
+		polygonsB.push_back(new PoligonCollisionHull(id + 1, 0, vertices));
+		polygonWorld.createPolygon(id + 1, 0, vertices);
+
+		//the same rectangle as a generic polygon and as a box
+		makeRect(vertices, x, y);
+		rectPolygons.push_back(new PoligonCollisionHull(id, 0, vertices));
+		boxes.push_back(new BoxCollisionHull(id, 0, vertices));
+		boxWorld.createPolygon(id, 0, vertices);
+		boxWorld.createCircle(id + 1, 0, position, radius);
+	}
+
+	printf("pairs: %d, rounds: %d\n", numPairs, numRounds);
+
+	print("Intersections point/poly", runIntersections(Intersections::isIntersectsPointPolygon,
+			points, polygonsA, numRounds));
+	print("Intersections circle/poly", runIntersections(Intersections::isIntersectsCirclePolygon,
+			circles, polygonsA, numRounds));
+	print("Intersections poly/poly", runIntersections(Intersections::isIntersectsPolygonPolygon,
+			polygonsA, polygonsB, numRounds));
+
+	print("Intersections dispatch c/p", runIntersections(Intersections::isIntersects,
+			circles, polygonsA, numRounds));
+
+	print("Intersections circle/rect", runIntersections(Intersections::isIntersects,
+			circles, rectPolygons, numRounds));
+	print("Intersections circle/box", runIntersections(Intersections::isIntersects,
+			circles, boxes, numRounds));
+
+	print("CollisionWorld point/poly", runWorld(pointWorld, numPairs, numRounds));
+	print("CollisionWorld circle/poly", runWorld(circleWorld, numPairs, numRounds));
+	print("CollisionWorld poly/poly", runWorld(polygonWorld, numPairs, numRounds));
+	print("CollisionWorld circle/box", runWorld(boxWorld, numPairs, numRounds));
+
+	for(int32 i = 0; i < numPairs; i++)
+	{
+		delete points[i];
+		delete circles[i];
+		delete polygonsA[i];
+		delete polygonsB[i];
+		delete rectPolygons[i];
+		delete boxes[i];
+	}
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------------
+//	Static scenes: fills a QuadTree object by object and a LinearQuadTree
+//	with one bulk build from the same random boxes, prints the build time
+//	of both and the time per rectangle and point query. Every query must
+//	find the same number of objects in both trees.
+//
+//	usage: quad_tree_build_bench [numObjects] [numQueries]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	const float k_worldHalfSize = 5000.0f;
+	const float k_minObjectSize = 5.0f;
+	const float k_maxObjectSize = 60.0f;
+	const float k_queryHalfSize = 250.0f;
+	const int32 k_numBuilds = 5;
+
+	//fixed sequence, every run builds the same scene
+	uint32 s_randomState = 12345u;
+
+	float random(float minValue, float maxValue)
+	{
+		s_randomState = s_randomState * 1664525u + 1013904223u;
+
+		return minValue + (maxValue - minValue) * ((s_randomState >> 8) / 16777216.0f);
+	}
+
+	class Counter
+	{
+	public:
+		Counter(): m_count(0) {}
+
+		void operator()(int32 object) { m_count++; }
+		int32 take() { int32 count = m_count; m_count = 0; return count; }
+
+	private:
+		int32 m_count;
+	};
+
+	typedef QuadTree<int32, QTLooseBoundsPolicy<125> > DynamicTree;
+	typedef LinearQuadTree<int32> StaticTree;
+
+	struct Result
+	{
+		double _buildMs;
+		double _nsPerRectQuery;
+		double _nsPerPointQuery;
+		int32 _numNodesVisited;
+	};
+
+	template<typename Tree>
+	void query(Tree& tree, const std::vector<Rect2D>& rects, const std::vector<Point2D>& points,
+			std::vector<int32>& counts, Result& result)
+	{
+		Counter counter;
+		counts.clear();
+
+		tree.resetNumNodesVisited();
+		double startTime = bench::now();
+		for(size_t i = 0; i < rects.size(); i++)
+		{
+			tree.query(rects[i], counter);
+			counts.push_back(counter.take());
+		}
+		result._nsPerRectQuery = (bench::now() - startTime) * 1.0e9 / rects.size();
+		result._numNodesVisited = tree.getNumNodesVisited() / (int32)rects.size();
+
+		startTime = bench::now();
+		for(size_t i = 0; i < points.size(); i++)
+		{
+			tree.query(points[i], counter);
+			counts.push_back(counter.take());
+		}
+		result._nsPerPointQuery = (bench::now() - startTime) * 1.0e9 / points.size();
+	}
+
+	void print(const char* name, const Result& result)
+	{
+		printf("  %-30s build %9.3f ms, rect query %9.1f ns (%5d nodes), point query %7.1f ns\n",
+				name, result._buildMs, result._nsPerRectQuery, result._numNodesVisited,
+				result._nsPerPointQuery);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numObjects = (argc > 1) ? atoi(argv[1]) : 20000;
+	int32 numQueries = (argc > 2) ? atoi(argv[2]) : 20000;
+
+	Rect2D worldArea(Point2D(-k_worldHalfSize, -k_worldHalfSize),
+			Point2D(k_worldHalfSize, k_worldHalfSize));
+	float sceneHalfSize = k_worldHalfSize - k_maxObjectSize;
+
+	std::vector<Rect2D> boxes;
+	for(int32 i = 0; i < numObjects; i++)
+	{
+		float x = random(-sceneHalfSize, sceneHalfSize);
+		float y = random(-sceneHalfSize, sceneHalfSize);
+		boxes.push_back(Rect2D(Point2D(x, y), Point2D(x + random(k_minObjectSize, k_maxObjectSize),
+				y + random(k_minObjectSize, k_maxObjectSize))));
+	}
+
+	std::vector<Rect2D> rects;
+	std::vector<Point2D> points;
+	for(int32 i = 0; i < numQueries; i++)
+	{
+		float x = random(-k_worldHalfSize, k_worldHalfSize);
+		float y = random(-k_worldHalfSize, k_worldHalfSize);
+		rects.push_back(Rect2D(Point2D(x - k_queryHalfSize, y - k_queryHalfSize),
+				Point2D(x + k_queryHalfSize, y + k_queryHalfSize)));
+		points.push_back(Point2D(random(-k_worldHalfSize, k_worldHalfSize),
+				random(-k_worldHalfSize, k_worldHalfSize)));
+	}
+
+	printf("objects: %d, queries: %d rect + %d point, builds: %d\n",
+			numObjects, numQueries, numQueries, k_numBuilds);
+
+	//the trees are rebuilt, the best time is taken
+	DynamicTree dynamicTree;
+	Result dynamicResult;
+	dynamicResult._buildMs = 1.0e9;
+	for(int32 build = 0; build < k_numBuilds; build++)
+	{
+		double startTime = bench::now();
+		dynamicTree.create(worldArea);
+		for(int32 i = 0; i < numObjects; i++)
+		{
+			dynamicTree.insertObject(i, boxes[i]);
+		}
+		dynamicResult._buildMs = std::min(dynamicResult._buildMs, (bench::now() - startTime) * 1.0e3);
+	}
+
+	StaticTree staticTree;
+	Result staticResult;
+	staticResult._buildMs = 1.0e9;
+	for(int32 build = 0; build < k_numBuilds; build++)
+	{
+		double startTime = bench::now();
+		staticTree.create(worldArea);
+		for(int32 i = 0; i < numObjects; i++)
+		{
+			staticTree.insertObject(i, boxes[i]);
+		}
+		staticTree.build();
+		staticResult._buildMs = std::min(staticResult._buildMs, (bench::now() - startTime) * 1.0e3);
+	}
+
+	std::vector<int32> dynamicCounts;
+	std::vector<int32> staticCounts;
+	query(dynamicTree, rects, points, dynamicCounts, dynamicResult);
+	query(staticTree, rects, points, staticCounts, staticResult);
+
+	int32 numMismatches = 0;
+	int32 numFound = 0;
+	for(size_t i = 0; i < dynamicCounts.size(); i++)
+	{
+		numFound += staticCounts[i];
+		if(dynamicCounts[i] != staticCounts[i])
+		{
+			numMismatches++;
+		}
+	}
+
+	print("QuadTree (insertObject)", dynamicResult);
+	print("LinearQuadTree (build)", staticResult);
+	printf("  %d objects found, %d nodes in LinearQuadTree, %d queries differ\n",
+			numFound, staticTree.getNumNodes(), numMismatches);
+
+	return (numMismatches == 0) ? 0 : 1;
+}
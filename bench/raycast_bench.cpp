@@ -0,0 +1,285 @@
+//-----------------------------------------------------------------------------
+//	Ray and circle casts: builds the same random scene (circles, hexagons
+//	and boxes of three collision groups) in BasePhysics (CellGrid),
+//	BasePhysics2 (QuadTree), BasePhysics2BVH (AABBTree) and BasePhysics3
+//	(sweep and prune), runs the same queries through IPhysics::castRay /
+//	castCircle and prints the time per query. Every answer is checked against a brute force cast over all
+//	hulls: the hit or miss, the distance and the hull id must agree.
+//
+//	usage: physics_raycast_bench [numHulls] [numQueries]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/base_physics.h"
+#include "physics/collisions.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	const float k_worldHalfSize = 5000.0f;
+	const float k_sceneHalfSize = 4000.0f;
+	const float k_maxDistance = 1500.0f;
+	const float k_castRadius = 15.0f;
+	const float k_distanceEpsilon = 1.0e-3f;
+
+	//fixed sequence, every run builds the same scene
+	uint32 s_randomState = 12345u;
+
+	float random(float minValue, float maxValue)
+	{
+		s_randomState = s_randomState * 1664525u + 1013904223u;
+
+		return minValue + (maxValue - minValue) * ((s_randomState >> 8) / 16777216.0f);
+	}
+
+	struct Query
+	{
+		Vector3 _origin;
+		Vector3 _direction;
+		float _radius;
+		uint32 _groupMask;
+	};
+
+	struct Answer
+	{
+		bool _found;
+		IPhysics::CastHit _hit;
+	};
+
+	void buildScene(int32 numHulls, std::vector<IPhysics::CollisionHullPtr>& hulls)
+	{
+		IPhysics::PointList points;
+
+		for(int32 i = 0; i < numHulls; i++)
+		{
+			int32 id = i + 1;
+			int32 group = 1 + (i % 3);
+			float x = random(-k_sceneHalfSize, k_sceneHalfSize);
+			float y = random(-k_sceneHalfSize, k_sceneHalfSize);
+
+			switch(i % 3)
+			{
+			case 0:
+				hulls.push_back(new CircleCollisionHull(id, group, Vector3(x, y, 0.0f), random(10.0f, 40.0f)));
+				break;
+			case 1:
+				{
+					float radius = random(20.0f, 50.0f);
+					float angle = random(0.0f, 1.0f);
+
+					points.clear();
+					for(int32 k = 0; k < 6; k++)
+					{
+						float a = angle + k * (3.14159265f / 3.0f);
+						points.push_back(Vector3(x + radius * cosf(a), y + radius * sinf(a), 0.0f));
+					}
+					hulls.push_back(new PoligonCollisionHull(id, group, points));
+				}
+				break;
+			default:
+				{
+					Rect2D box(Point2D(x, y), Point2D(x + random(20.0f, 80.0f), y + random(20.0f, 80.0f)));
+					BoxCollisionHull::makePoints(box, points);
+					hulls.push_back(new BoxCollisionHull(id, group, points));
+				}
+				break;
+			}
+		}
+	}
+
+	void registerScene(IPhysics* physics, const std::vector<IPhysics::CollisionHullPtr>& hulls)
+	{
+		Rect2D worldArea(Point2D(-k_worldHalfSize, -k_worldHalfSize),
+				Point2D(k_worldHalfSize, k_worldHalfSize));
+		physics->create(worldArea);
+
+		for(size_t i = 0; i < hulls.size(); i++)
+		{
+			ICollisionHull* hull = hulls[i].get();
+
+			if(hull->getType() == ICollisionHull::k_typeCircle)
+			{
+				CircleCollisionHull* circle = static_cast<CircleCollisionHull*>(hull);
+				physics->registerCircle(hull->getId(), hull->getCollisionGroup(),
+						circle->getCurrentPosition(), circle->getRadius());
+			}else
+			{
+				physics->registerPoligon(hull->getId(), hull->getCollisionGroup(),
+						static_cast<PoligonCollisionHull*>(hull)->getPoints());
+			}
+		}
+
+		physics->update();
+	}
+
+	//nearest hit over all hulls, ties resolved by the smaller id as IPhysics does
+	Answer bruteForce(const std::vector<IPhysics::CollisionHullPtr>& hulls, const Query& query)
+	{
+		Answer answer;
+		answer._found = false;
+
+		CollisionCasts::Ray ray;
+		if(!CollisionCasts::makeRay(query._origin, query._direction, query._radius, ray))
+		{
+			return answer;
+		}
+
+		CollisionCasts::Hit best;
+		int32 bestId = -1;
+
+		for(size_t i = 0; i < hulls.size(); i++)
+		{
+			ICollisionHull* hull = hulls[i].get();
+			if((query._groupMask & CollisionFilter::getBit(hull->getCollisionGroup())) == 0)
+			{
+				continue;
+			}
+
+			CollisionCasts::Hit hit;
+			if(!CollisionCasts::castHull(hull, ray, k_maxDistance, hit))
+			{
+				continue;
+			}
+
+			if(bestId < 0 || hit._distance < best._distance
+				|| (hit._distance == best._distance && hull->getId() < bestId))
+			{
+				best = hit;
+				bestId = hull->getId();
+			}
+		}
+
+		if(bestId >= 0)
+		{
+			answer._found = true;
+			CollisionCasts::makeCastHit(bestId, ray, best, answer._hit);
+		}
+
+		return answer;
+	}
+
+	struct Result
+	{
+		double _nsPerQuery;
+		int32 _numHits;
+		int32 _numMismatches;
+		int32 _numOtherIds;
+	};
+
+	Result run(IPhysics* physics, const std::vector<IPhysics::CollisionHullPtr>& hulls,
+			const std::vector<Query>& queries, const std::vector<Answer>& expected)
+	{
+		registerScene(physics, hulls);
+
+		std::vector<Answer> answers(queries.size());
+
+		double startTime = bench::now();
+		for(size_t i = 0; i < queries.size(); i++)
+		{
+			const Query& query = queries[i];
+			Answer& answer = answers[i];
+
+			if(query._radius > 0.0f)
+			{
+				answer._found = physics->castCircle(query._origin, query._radius, query._direction,
+						k_maxDistance, answer._hit, query._groupMask);
+			}else
+			{
+				answer._found = physics->castRay(query._origin, query._direction,
+						k_maxDistance, answer._hit, query._groupMask);
+			}
+		}
+		double elapsed = bench::now() - startTime;
+
+		physics->destroy();
+
+		Result result;
+		result._nsPerQuery = elapsed * 1.0e9 / queries.size();
+		result._numHits = 0;
+		result._numMismatches = 0;
+		result._numOtherIds = 0;
+
+		for(size_t i = 0; i < queries.size(); i++)
+		{
+			const Answer& answer = answers[i];
+			const Answer& reference = expected[i];
+
+			if(answer._found)
+			{
+				result._numHits++;
+			}
+
+			if(answer._found != reference._found)
+			{
+				result._numMismatches++;
+				continue;
+			}
+
+			if(!answer._found)
+			{
+				continue;
+			}
+
+			if(fabs(answer._hit._distance - reference._hit._distance) > k_distanceEpsilon)
+			{
+				result._numMismatches++;
+			}else if(answer._hit._id != reference._hit._id)
+			{
+				//another hull touched at the same distance (within the rounding)
+				result._numOtherIds++;
+			}
+		}
+
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numHulls = (argc > 1) ? atoi(argv[1]) : 3000;
+	int32 numQueries = (argc > 2) ? atoi(argv[2]) : 20000;
+
+	std::vector<IPhysics::CollisionHullPtr> hulls;
+	buildScene(numHulls, hulls);
+
+	//half rays and half circles, every fourth query sees the second group only
+	std::vector<Query> queries(numQueries);
+	for(int32 i = 0; i < numQueries; i++)
+	{
+		float angle = random(0.0f, 6.2831853f);
+
+		Query& query = queries[i];
+		query._origin = Vector3(random(-k_sceneHalfSize, k_sceneHalfSize),
+				random(-k_sceneHalfSize, k_sceneHalfSize), 0.0f);
+		query._direction = Vector3(cosf(angle), sinf(angle), 0.0f);
+		query._radius = (i % 2) ? k_castRadius : 0.0f;
+		query._groupMask = ((i % 4) == 3) ? CollisionFilter::getBit(2) : (uint32)IPhysics::k_allGroups;
+	}
+
+	std::vector<Answer> expected(numQueries);
+	double startTime = bench::now();
+	for(int32 i = 0; i < numQueries; i++)
+	{
+		expected[i] = bruteForce(hulls, queries[i]);
+	}
+	double bruteForceNs = (bench::now() - startTime) * 1.0e9 / numQueries;
+
+	printf("hulls: %d, queries: %d, max distance: %.0f\n", numHulls, numQueries, k_maxDistance);
+	printf("%-32s %10.1f ns/query\n", "brute force", bruteForceNs);
+
+	for(int32 i = 0; i < bench::k_numPhysicsImplementations; i++)
+	{
+		const bench::PhysicsImplementation& implementation = bench::k_physicsImplementations[i];
+		IPhysics* physics = implementation._create();
+		Result result = run(physics, hulls, queries, expected);
+		delete physics;
+
+		printf("%-32s %10.1f ns/query %8d hits %6d mismatches %6d other ids at equal distance\n",
+				implementation._label, result._nsPerQuery, result._numHits,
+				result._numMismatches, result._numOtherIds);
+	}
+
+	return 0;
+}
@@ -0,0 +1,367 @@
+//-----------------------------------------------------------------------------
+//	Broadphase scaling: synthetic worlds of 1k, 10k and 100k hulls, half
+//	circles and half convex polygons, spread with the same density over a
+//	square world. Circles and polygons alternate between two groups each,
+//	hulls of different groups collide. Every world runs in three modes:
+//	static (nothing moves), scroll (polygons move to the left with one speed
+//	and wrap around, circles stay) and random (every hull makes a random
+//	step). Runs every IPhysics implementation on the same worlds and prints
+//	JSON to stdout: time of the first update (the broadphase is built from
+//	scratch), time per frame (moves and update) and per update phase after
+//	it, contacts per frame, heap taken by the implementation after the first
+//	update and whether the contact set of every frame is the same as the
+//	one of the first implementation. A run stops early when its frames have
+//	taken more than maxSeconds (slow implementations on big worlds), the
+//	contact sets are compared on the frames both runs made; the exit code
+//	is 1 when any of them differs.
+//
+//	usage: physics_scaling_bench [numFrames] [maxHulls] [maxSeconds]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/base_physics.h"
+#include "physics/collision_pairs.h"
+
+#include <stdio.h>
+#include <malloc.h>
+
+using namespace pegas;
+
+namespace
+{
+	enum
+	{
+		k_groupCircleA = 1,
+		k_groupCircleB = 2,
+		k_groupPolygonA = 3,
+		k_groupPolygonB = 4,
+		k_minPolygonPoints = 3,
+		k_maxPolygonPoints = 6
+	};
+
+	enum Motion
+	{
+		k_motionStatic = 0,
+		k_motionScroll,
+		k_motionRandom,
+		k_numMotions
+	};
+
+	const char* k_motionNames[k_numMotions] = { "static", "scroll", "random" };
+
+	//world side per square root of the number of hulls, keeps the density
+	const float k_spacing = 40.0f;
+	const float k_minRadius = 3.0f;
+	const float k_maxRadius = 12.0f;
+	const float k_scrollSpeed = 3.0f;
+	const float k_randomStep = 4.0f;
+
+	//allocated from the heap and mmapped, big blocks are mmapped until
+	//the first of them is freed
+	size_t getHeapInUse()
+	{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+		struct mallinfo2 info = mallinfo2();
+
+		return info.uordblks + info.hblkhd;
+#else
+		struct mallinfo info = mallinfo();
+
+		return (size_t)info.uordblks + (size_t)info.hblkhd;
+#endif
+	}
+
+	//same sequence on every platform, unlike rand()
+	class Random
+	{
+	public:
+		Random(uint32 seed): m_state(seed) {}
+
+		float next(float from, float to)
+		{
+			m_state = m_state * 1664525u + 1013904223u;
+
+			return from + (to - from) * ((m_state >> 8) * (1.0f / 16777216.0f));
+		}
+
+	private:
+		uint32 m_state;
+	};
+
+	struct Hull
+	{
+		float _x;
+		float _y;
+		bool _isCircle;
+		float _radius;
+		//polygon vertices in the world, counter-clockwise
+		IPhysics::PointList _points;
+	};
+
+	//hulls are generated once per size, every implementation gets the same world
+	void makeWorld(int32 numHulls, std::vector<Hull>& hulls, float& side)
+	{
+		side = k_spacing * sqrtf((float)numHulls);
+
+		Random random(numHulls);
+		hulls.resize(numHulls);
+		for(int32 i = 0; i < numHulls; i++)
+		{
+			Hull& hull = hulls[i];
+			hull._x = random.next(-side * 0.5f, side * 0.5f);
+			hull._y = random.next(-side * 0.5f, side * 0.5f);
+			hull._isCircle = (i % 2) == 0;
+			hull._radius = random.next(k_minRadius, k_maxRadius);
+
+			hull._points.clear();
+			if(!hull._isCircle)
+			{
+				int32 numPoints = k_minPolygonPoints
+						+ (int32)random.next(0.0f, k_maxPolygonPoints - k_minPolygonPoints + 0.999f);
+				float angle = random.next(0.0f, 2.0f * Math::PI);
+				for(int32 j = 0; j < numPoints; j++)
+				{
+					float a = angle + (2.0f * Math::PI * j) / numPoints;
+					hull._points.push_back(Vector3(hull._x + hull._radius * cosf(a), hull._y + hull._radius * sinf(a), 0.0f));
+				}
+			}
+		}
+	}
+
+	struct Result
+	{
+		double _firstFrameMs;
+		double _msPerFrame;
+		double _phaseMs[IPhysics::Stats::k_numPhases];
+		double _updateMs;
+		double _contactsPerFrame;
+		double _candidatesPerFrame;
+		double _testsPerFrame;
+		double _nodesVisitedPerFrame;
+		double _reinsertionsPerFrame;
+		size_t _heapBytes;
+		int32 _numFrames;
+		//number of contacts and FNV-1a hash of the sorted contact keys, per frame
+		std::vector<int32> _contactCounts;
+		std::vector<uint32> _contactHashes;
+	};
+
+	void run(IPhysics* physics, const std::vector<Hull>& world, float side, Motion motion,
+			int32 numFrames, double maxSeconds, Result& result)
+	{
+		size_t heapBefore = getHeapInUse();
+
+		Rect2D worldArea(Point2D(-side, -side), Point2D(side, side));
+		physics->create(worldArea);
+
+		//pairs of different groups collide
+		const int32 groups[] = { k_groupCircleA, k_groupCircleB, k_groupPolygonA, k_groupPolygonB };
+		const int32 numGroups = sizeof(groups) / sizeof(groups[0]);
+		for(int32 i = 0; i < numGroups; i++)
+		{
+			physics->setCollisionGroupFlag(groups[i], true);
+			for(int32 j = i; j < numGroups; j++)
+			{
+				physics->setCollisionPairGroupFlag(groups[i], groups[j], i != j);
+			}
+		}
+
+		//hulls are registered in place: a circle moved from elsewhere would be
+		//swept across the world in the first update. An absolute move is
+		//relative to the registered position
+		int32 numHulls = world.size();
+		std::vector<float> x(numHulls);
+		std::vector<float> y(numHulls);
+		for(int32 i = 0; i < numHulls; i++)
+		{
+			const Hull& hull = world[i];
+			int32 id = i + 1;
+
+			if(hull._isCircle)
+			{
+				physics->registerCircle(id, (i % 4) ? k_groupCircleB : k_groupCircleA,
+						Vector3(hull._x, hull._y, 0.0f), hull._radius);
+			}else
+			{
+				physics->registerPoligon(id, (i % 4 == 1) ? k_groupPolygonA : k_groupPolygonB, hull._points);
+			}
+
+			x[i] = hull._x;
+			y[i] = hull._y;
+		}
+
+		Random random(numHulls + motion);
+		IPhysics::Stats total;
+		PhysicsStats::reset(total);
+
+		result._contactCounts.clear();
+		result._contactHashes.clear();
+		result._heapBytes = 0;
+
+		//frame 0 is the first update, not counted in the averages
+		std::vector<CollisionPairKey> contacts;
+		double elapsed = 0.0;
+		int32 frame = 0;
+		for(; frame <= numFrames && elapsed <= maxSeconds; frame++)
+		{
+			double startTime = bench::now();
+
+			if(motion == k_motionScroll && frame > 0)
+			{
+				for(int32 i = 1; i < numHulls; i += 2)
+				{
+					x[i] -= k_scrollSpeed;
+					if(x[i] < -side * 0.5f)
+					{
+						x[i] += side;
+					}
+					physics->moveObject(i + 1, Vector3(x[i] - world[i]._x, y[i] - world[i]._y, 0.0f), true);
+				}
+			}else if(motion == k_motionRandom && frame > 0)
+			{
+				for(int32 i = 0; i < numHulls; i++)
+				{
+					x[i] = std::max(-side * 0.5f, std::min(side * 0.5f, x[i] + random.next(-k_randomStep, k_randomStep)));
+					y[i] = std::max(-side * 0.5f, std::min(side * 0.5f, y[i] + random.next(-k_randomStep, k_randomStep)));
+					physics->moveObject(i + 1, Vector3(x[i] - world[i]._x, y[i] - world[i]._y, 0.0f), true);
+				}
+			}
+
+			physics->update();
+
+			if(frame == 0)
+			{
+				result._firstFrameMs = (bench::now() - startTime) * 1.0e3;
+				result._heapBytes = getHeapInUse() - heapBefore;
+			}else
+			{
+				elapsed += bench::now() - startTime;
+				PhysicsStats::accumulate(total, physics->getStats());
+			}
+
+			//begun and lasting contacts together are the contacts of the frame
+			contacts.clear();
+			IPhysics::CollisionPairList& begun = physics->getCollidedPairs();
+			IPhysics::CollisionPairList& stay = physics->getContactStayPairs();
+			for(IPhysics::CollisionPairList::iterator it = begun.begin(); it != begun.end(); ++it)
+			{
+				contacts.push_back(CollisionPairSet::makeKey(it->first, it->second));
+			}
+			for(IPhysics::CollisionPairList::iterator it = stay.begin(); it != stay.end(); ++it)
+			{
+				contacts.push_back(CollisionPairSet::makeKey(it->first, it->second));
+			}
+			std::sort(contacts.begin(), contacts.end());
+
+			uint32 hash = 2166136261u;
+			for(std::vector<CollisionPairKey>::iterator it = contacts.begin(); it != contacts.end(); ++it)
+			{
+				hash = (hash ^ (uint32)(*it)) * 16777619u;
+				hash = (hash ^ (uint32)(*it >> 32)) * 16777619u;
+			}
+
+			result._contactCounts.push_back(contacts.size());
+			result._contactHashes.push_back(hash);
+		}
+
+		physics->destroy();
+
+		result._numFrames = frame - 1;
+
+		double frames = std::max(result._numFrames, 1);
+		result._msPerFrame = elapsed * 1.0e3 / frames;
+		for(int32 i = 0; i < IPhysics::Stats::k_numPhases; i++)
+		{
+			result._phaseMs[i] = total._phaseTime[i] * 1.0e3 / frames;
+		}
+		result._updateMs = total._updateTime * 1.0e3 / frames;
+		result._candidatesPerFrame = total._numCandidatePairs / frames;
+		result._testsPerFrame = PhysicsStats::getNumTests(total) / frames;
+		result._nodesVisitedPerFrame = total._numNodesVisited / frames;
+		result._reinsertionsPerFrame = total._numReinsertions / frames;
+
+		int64 numContacts = 0;
+		for(std::vector<int32>::iterator it = result._contactCounts.begin(); it != result._contactCounts.end(); ++it)
+		{
+			numContacts += *it;
+		}
+		result._contactsPerFrame = numContacts / (double)result._contactCounts.size();
+	}
+
+	//frames whose contact set differs from the reference
+	int32 countMismatches(const Result& reference, const Result& result)
+	{
+		int32 mismatches = 0;
+		size_t numFrames = std::min(reference._contactHashes.size(), result._contactHashes.size());
+		for(size_t i = 0; i < numFrames; i++)
+		{
+			if(reference._contactCounts[i] != result._contactCounts[i]
+				|| reference._contactHashes[i] != result._contactHashes[i])
+			{
+				mismatches++;
+			}
+		}
+
+		return mismatches;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numFrames = (argc > 1) ? atoi(argv[1]) : 30;
+	int32 maxHulls = (argc > 2) ? atoi(argv[2]) : 100000;
+	double maxSeconds = (argc > 3) ? atof(argv[3]) : 2.0;
+
+	const int32 sizes[] = { 1000, 10000, 100000 };
+
+	printf("{\n\t\"frames\": %d,\n\t\"max_seconds\": %.2f,\n\t\"runs\": [", numFrames, maxSeconds);
+
+	bool firstRun = true;
+	bool allMatch = true;
+	std::vector<Hull> world;
+	Result reference;
+	Result result;
+
+	for(int32 s = 0; s < 3 && sizes[s] <= maxHulls; s++)
+	{
+		float side;
+		makeWorld(sizes[s], world, side);
+
+		for(int32 motion = 0; motion < k_numMotions; motion++)
+		{
+			for(int32 i = 0; i < bench::k_numPhysicsImplementations; i++)
+			{
+				const bench::PhysicsImplementation& implementation = bench::k_physicsImplementations[i];
+				Result& current = (i == 0) ? reference : result;
+				IPhysics* physics = implementation._create();
+				run(physics, world, side, (Motion)motion, numFrames, maxSeconds, current);
+				delete physics;
+
+				int32 mismatches = countMismatches(reference, current);
+				allMatch = allMatch && (mismatches == 0);
+
+				printf("%s\n\t\t{\"implementation\": \"%s\", \"hulls\": %d, \"motion\": \"%s\", "
+						"\"frames\": %d, \"first_frame_ms\": %.4f, \"ms_per_frame\": %.4f, \"update_ms\": %.4f, "
+						"\"phase_ms\": {\"broadphase\": %.4f, \"narrowphase\": %.4f, \"sweep\": %.4f, \"contacts\": %.4f}, "
+						"\"contacts_per_frame\": %.1f, \"candidates_per_frame\": %.1f, \"tests_per_frame\": %.1f, "
+						"\"nodes_visited_per_frame\": %.1f, \"reinsertions_per_frame\": %.1f, \"heap_bytes\": %lu, "
+						"\"mismatched_frames\": %d}",
+						firstRun ? "" : ",", implementation._name, sizes[s], k_motionNames[motion], current._numFrames, current._firstFrameMs,
+						current._msPerFrame, current._updateMs,
+						current._phaseMs[IPhysics::Stats::k_phaseBroadphase],
+						current._phaseMs[IPhysics::Stats::k_phaseNarrowphase],
+						current._phaseMs[IPhysics::Stats::k_phaseSweep],
+						current._phaseMs[IPhysics::Stats::k_phaseContacts],
+						current._contactsPerFrame, current._candidatesPerFrame, current._testsPerFrame,
+						current._nodesVisitedPerFrame, current._reinsertionsPerFrame,
+						(unsigned long)current._heapBytes, mismatches);
+				fflush(stdout);
+
+				firstRun = false;
+			}
+		}
+	}
+
+	printf("\n\t],\n\t\"same_contacts\": %s\n}\n", allMatch ? "true" : "false");
+
+	return allMatch ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+//-----------------------------------------------------------------------------
+//	Scroll layers: a row of columns (boxes) scrolls to the left past birds
+//	(circles) moving up and down in the world. The columns are moved either
+//	one by one with moveObject, as the game used to do, or all at once with
+//	the offset of a scroll layer. Runs BasePhysics (CellGrid), BasePhysics2
+//	(QuadTree), BasePhysics2BVH (AABBTree) and BasePhysics3 (sweep and
+//	prune), prints the time per update and checks that both ways report
+//	the same contacts in every update and the same hits of ray casts across
+//	the layers.
+//
+//	usage: physics_scroll_bench [numColumns] [numBirds] [numUpdates]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "physics/base_physics.h"
+#include "physics/collision_pairs.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	enum
+	{
+		k_groupBird = 1,
+		k_groupColumn = 2
+	};
+
+	const float k_worldHalfSize = 5000.0f;
+	const float k_columnSpacing = 60.0f;
+	const float k_columnWidth = 20.0f;
+	const float k_columnHeight = 300.0f;
+	const float k_firstColumnX = -1900.0f;
+	const float k_birdRadius = 12.0f;
+	const float k_scrollStep = 3.0f;
+	const int32 k_castInterval = 25;
+	const int32 k_numCasts = 16;
+
+	//contacts begun in every update and cast hits, in the order they were made
+	struct Trace
+	{
+		std::vector<CollisionPairKey> _pairs;
+		std::vector<int32> _pairCounts;
+		std::vector<int32> _castIds;
+		std::vector<float> _castDistances;
+	};
+
+	double run(IPhysics* physics, int32 numColumns, int32 numBirds, int32 numUpdates, bool useLayer, Trace& trace)
+	{
+		Rect2D worldArea(Point2D(-k_worldHalfSize, -k_worldHalfSize),
+				Point2D(k_worldHalfSize, k_worldHalfSize));
+		physics->create(worldArea);
+
+		//both groups active: BasePhysics2 walks up the tree from active hulls only,
+		//a column in a node below a bird is found from the column side
+		physics->setCollisionGroupFlag(k_groupBird, true);
+		physics->setCollisionGroupFlag(k_groupColumn, true);
+		physics->setCollisionPairGroupFlag(k_groupBird, k_groupBird, false);
+		physics->setCollisionPairGroupFlag(k_groupColumn, k_groupColumn, false);
+		physics->setCollisionPairGroupFlag(k_groupBird, k_groupColumn, true);
+
+		int32 layer = physics->createScrollLayer();
+
+		//columns above and below a window, the window height changes along the row
+		int32 nextId = 1;
+		for(int32 i = 0; i < numColumns; i++)
+		{
+			float x = k_firstColumnX + i * k_columnSpacing;
+			float window = 40.0f + 30.0f * (i % 5);
+
+			Rect2D upper(Point2D(x, window + k_columnHeight), Point2D(x + k_columnWidth, window));
+			Rect2D lower(Point2D(x, -window), Point2D(x + k_columnWidth, -window - k_columnHeight));
+
+			physics->registerBox(nextId, k_groupColumn, upper);
+			physics->registerBox(nextId + 1, k_groupColumn, lower);
+			if(useLayer)
+			{
+				physics->attachToScrollLayer(nextId, layer);
+				physics->attachToScrollLayer(nextId + 1, layer);
+			}
+			nextId += 2;
+		}
+		int32 numColumnHulls = nextId - 1;
+
+		int32 firstBirdId = nextId;
+		for(int32 i = 0; i < numBirds; i++)
+		{
+			physics->registerCircle(nextId++, k_groupBird, Vector3(-1500.0f + i * 40.0f, 0.0f, 0.0f), k_birdRadius);
+		}
+
+		trace._pairs.clear();
+		trace._pairCounts.clear();
+		trace._castIds.clear();
+		trace._castDistances.clear();
+
+		double elapsed = 0.0;
+		for(int32 update = 1; update <= numUpdates; update++)
+		{
+			double startTime = bench::now();
+
+			float scroll = -k_scrollStep * update;
+			if(useLayer)
+			{
+				physics->setScrollLayerOffset(layer, Vector3(scroll, 0.0f, 0.0f));
+			}else
+			{
+				for(int32 id = 1; id <= numColumnHulls; id++)
+				{
+					physics->moveObject(id, Vector3(scroll, 0.0f, 0.0f), true);
+				}
+			}
+
+			for(int32 i = 0; i < numBirds; i++)
+			{
+				float y = 120.0f * sinf((update + 7 * i) * 0.05f);
+				physics->moveObject(firstBirdId + i, Vector3(0.0f, y, 0.0f), true);
+			}
+
+			physics->update();
+
+			elapsed += bench::now() - startTime;
+
+			IPhysics::CollisionPairList& pairs = physics->getCollidedPairs();
+			size_t first = trace._pairs.size();
+			for(IPhysics::CollisionPairList::iterator it = pairs.begin(); it != pairs.end(); ++it)
+			{
+				trace._pairs.push_back(CollisionPairSet::makeKey(it->first, it->second));
+			}
+			std::sort(trace._pairs.begin() + first, trace._pairs.end());
+			trace._pairCounts.push_back(trace._pairs.size() - first);
+
+			//rays from the birds level across the row, both directions
+			if((update % k_castInterval) == 0)
+			{
+				for(int32 i = 0; i < k_numCasts; i++)
+				{
+					Vector3 origin(-1600.0f + i * 150.0f, -150.0f + i * 20.0f, 0.0f);
+					Vector3 direction((i % 2) ? 1.0f : -1.0f, 0.1f * (i % 3), 0.0f);
+
+					IPhysics::CastHit hit;
+					bool found = (i % 4 == 3)
+							? physics->castCircle(origin, 8.0f, direction, 1000.0f, hit)
+							: physics->castRay(origin, direction, 1000.0f, hit);
+
+					trace._castIds.push_back(found ? hit._id : -1);
+					trace._castDistances.push_back(found ? hit._distance : -1.0f);
+				}
+			}
+		}
+
+		physics->destroy();
+
+		return elapsed * 1.0e3 / numUpdates;
+	}
+
+	//updates with other contacts and casts with another hull or distance
+	void compare(const Trace& a, const Trace& b, int32& pairMismatches, int32& castMismatches)
+	{
+		pairMismatches = 0;
+		castMismatches = 0;
+
+		size_t offsetA = 0;
+		size_t offsetB = 0;
+		for(size_t i = 0; i < a._pairCounts.size(); i++)
+		{
+			int32 countA = a._pairCounts[i];
+			int32 countB = b._pairCounts[i];
+
+			if(countA != countB || !std::equal(a._pairs.begin() + offsetA, a._pairs.begin() + offsetA + countA,
+					b._pairs.begin() + offsetB))
+			{
+				pairMismatches++;
+			}
+
+			offsetA += countA;
+			offsetB += countB;
+		}
+
+		for(size_t i = 0; i < a._castIds.size(); i++)
+		{
+			if(a._castIds[i] != b._castIds[i] || fabs(a._castDistances[i] - b._castDistances[i]) > 1.0e-2f)
+			{
+				castMismatches++;
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numColumns = (argc > 1) ? atoi(argv[1]) : 60;
+	int32 numBirds = (argc > 2) ? atoi(argv[2]) : 32;
+	int32 numUpdates = (argc > 3) ? atoi(argv[3]) : 1000;
+
+	printf("columns: %d, birds: %d, updates: %d (scroll %.0f)\n",
+			numColumns, numBirds, numUpdates, k_scrollStep * numUpdates);
+
+	Trace moved;
+	Trace scrolled;
+
+	for(int32 i = 0; i < bench::k_numPhysicsImplementations; i++)
+	{
+		const bench::PhysicsImplementation& implementation = bench::k_physicsImplementations[i];
+		IPhysics* physics = implementation._create();
+		double movedMs = run(physics, numColumns, numBirds, numUpdates, false, moved);
+		double scrolledMs = run(physics, numColumns, numBirds, numUpdates, true, scrolled);
+		delete physics;
+
+		int32 pairMismatches;
+		int32 castMismatches;
+		compare(moved, scrolled, pairMismatches, castMismatches);
+
+		printf("  %-32s moveObject %8.4f ms/update, scroll layer %8.4f ms/update, "
+				"%7d/%d pairs, %d updates and %d of %d casts differ\n",
+				implementation._label, movedMs, scrolledMs, (int32)moved._pairs.size(), (int32)scrolled._pairs.size(),
+				pairMismatches, castMismatches, (int32)moved._castIds.size());
+	}
+
+	return 0;
+}
@@ -0,0 +1,311 @@
+//-----------------------------------------------------------------------------
+//	Snapshot queries: every frame moves all objects of a QuadTree by a
+//	random step. The serial run then makes the rectangle queries on the live
+//	tree, as the game does today. The overlapped run publishes a
+//	SpatialSnapshot of the tree through a SnapshotBuffer at the end of every
+//	frame, while reader threads keep querying the last published snapshot.
+//	Prints the time per frame of both runs and the queries the readers made.
+//	Every reader checks one query per snapshot against a brute force scan of
+//	the snapshot, and the first snapshot against the live tree.
+//
+//	usage: snapshot_bench [numObjects] [numFrames] [numReaders] [queriesPerFrame]
+//-----------------------------------------------------------------------------
+#include "bench.h"
+#include "system/worker_pool.h"
+#include "system/snapshot_buffer.h"
+
+#include <stdio.h>
+
+using namespace pegas;
+
+namespace
+{
+	const float k_worldHalfSize = 5000.0f;
+	const float k_minObjectSize = 5.0f;
+	const float k_maxObjectSize = 60.0f;
+	const float k_maxStep = 4.0f;
+	const float k_queryHalfSize = 250.0f;
+
+	//fixed sequence per generator, every run builds the same scene
+	float random(uint32& state, float minValue, float maxValue)
+	{
+		state = state * 1664525u + 1013904223u;
+
+		return minValue + (maxValue - minValue) * ((state >> 8) / 16777216.0f);
+	}
+
+	class HitCounter
+	{
+	public:
+		HitCounter(): m_count(0) {}
+
+		void operator()(int32 object) { m_count++; }
+		int32 take() { int32 count = m_count; m_count = 0; return count; }
+
+	private:
+		int32 m_count;
+	};
+
+	typedef QuadTree<int32, QTLooseBoundsPolicy<125> > Tree;
+	typedef SpatialSnapshot<int32> Snapshot;
+
+	class World
+	{
+	public:
+		World(int32 numObjects)
+			:m_randomState(12345u)
+		{
+			m_tree.create(Rect2D(Point2D(-k_worldHalfSize, -k_worldHalfSize),
+					Point2D(k_worldHalfSize, k_worldHalfSize)));
+
+			float sceneHalfSize = k_worldHalfSize - k_maxObjectSize - k_maxStep;
+			for(int32 i = 0; i < numObjects; i++)
+			{
+				float x = random(m_randomState, -sceneHalfSize, sceneHalfSize);
+				float y = random(m_randomState, -sceneHalfSize, sceneHalfSize);
+				m_boxes.push_back(Rect2D(Point2D(x, y),
+						Point2D(x + random(m_randomState, k_minObjectSize, k_maxObjectSize),
+								y + random(m_randomState, k_minObjectSize, k_maxObjectSize))));
+				m_handles.push_back(m_tree.insertObject(i, m_boxes.back()));
+			}
+		}
+
+		//objects step back from the border of the world
+		void update()
+		{
+			float sceneHalfSize = k_worldHalfSize - k_maxObjectSize - k_maxStep;
+			for(size_t i = 0; i < m_boxes.size(); i++)
+			{
+				Rect2D& box = m_boxes[i];
+				Point2D step(random(m_randomState, -k_maxStep, k_maxStep), random(m_randomState, -k_maxStep, k_maxStep));
+				if(fabs(box._topLeft._x + step._x) > sceneHalfSize) step._x = -step._x;
+				if(fabs(box._topLeft._y + step._y) > sceneHalfSize) step._y = -step._y;
+
+				box = Rect2D(box._topLeft + step, box._bottomRight + step);
+				m_tree.updateObject(m_handles[i], box);
+			}
+		}
+
+		Tree& getTree() { return m_tree; }
+
+	private:
+		Tree m_tree;
+		std::vector<Rect2D> m_boxes;
+		std::vector<SpatialHandle> m_handles;
+		uint32 m_randomState;
+	};
+
+	Rect2D makeQuery(uint32& state)
+	{
+		float x = random(state, -k_worldHalfSize, k_worldHalfSize);
+		float y = random(state, -k_worldHalfSize, k_worldHalfSize);
+
+		return Rect2D(Point2D(x - k_queryHalfSize, y - k_queryHalfSize),
+				Point2D(x + k_queryHalfSize, y + k_queryHalfSize));
+	}
+
+	int32 bruteForce(const Snapshot& snapshot, const Rect2D& queryAABB)
+	{
+		int32 count = 0;
+		for(int32 i = 0; i < snapshot.getNumObjects(); i++)
+		{
+			const Rect2D& rect = snapshot.getObjectAABB(i);
+			if(queryAABB.contains(rect) || rect.contains(queryAABB) || queryAABB.intersectsWith(rect))
+			{
+				count++;
+			}
+		}
+
+		return count;
+	}
+
+	//worker 0 runs the frames and publishes, the others read until the last frame is published
+	class OverlappedTask: public IWorkerTask
+	{
+	public:
+		OverlappedTask(World& world, int32 numObjects, int32 numFrames, int32 queriesPerFrame, int32 numWorkers)
+			:m_world(world), m_numObjects(numObjects), m_numFrames(numFrames), m_queriesPerFrame(queriesPerFrame),
+			 m_frameSeconds(0.0), m_publishSeconds(0.0),
+			 m_numQueries(numWorkers, 0), m_numSnapshots(numWorkers, 0), m_numMismatches(numWorkers, 0), m_numHits(numWorkers, 0)
+		{
+
+		}
+
+		virtual void run(int32 workerIndex, int32 numWorkers)
+		{
+			if(workerIndex == 0)
+			{
+				simulate();
+			}else
+			{
+				read(workerIndex);
+			}
+		}
+
+		double getFrameMs() const { return m_frameSeconds * 1.0e3 / m_numFrames; }
+		double getPublishMs() const { return m_publishSeconds * 1.0e3 / m_numFrames; }
+
+		int32 sum(const std::vector<int32>& values) const
+		{
+			int32 total = 0;
+			for(size_t i = 0; i < values.size(); i++)
+			{
+				total += values[i];
+			}
+
+			return total;
+		}
+
+		int32 getNumQueries() const { return sum(m_numQueries); }
+		int32 getNumSnapshots() const { return sum(m_numSnapshots); }
+		int32 getNumMismatches() const { return sum(m_numMismatches); }
+
+		double getHitsPerQuery() const
+		{
+			double numHits = 0.0;
+			for(size_t i = 0; i < m_numHits.size(); i++)
+			{
+				numHits += m_numHits[i];
+			}
+
+			return numHits / std::max(getNumQueries() - getNumSnapshots(), 1);
+		}
+
+	private:
+		void simulate()
+		{
+			double startTime = bench::now();
+			for(int32 frame = 1; frame <= m_numFrames; frame++)
+			{
+				m_world.update();
+
+				double publishTime = bench::now();
+				Snapshot& snapshot = m_snapshots.beginPublish();
+				snapshot.clear(frame);
+				m_world.getTree().appendToSnapshot(snapshot);
+				m_snapshots.endPublish();
+				m_publishSeconds += bench::now() - publishTime;
+
+				if(frame == 1)
+				{
+					checkAgainstTree(snapshot);
+				}
+			}
+			m_frameSeconds = bench::now() - startTime;
+		}
+
+		//the snapshot is published, the owner may still read it
+		void checkAgainstTree(const Snapshot& snapshot)
+		{
+			uint32 randomState = 777u;
+			HitCounter treeCounter;
+			HitCounter snapshotCounter;
+			for(int32 i = 0; i < m_queriesPerFrame; i++)
+			{
+				Rect2D queryAABB = makeQuery(randomState);
+				m_world.getTree().query(queryAABB, treeCounter);
+				snapshot.query(queryAABB, snapshotCounter);
+				if(treeCounter.take() != snapshotCounter.take())
+				{
+					m_numMismatches[0]++;
+				}
+			}
+		}
+
+		void read(int32 workerIndex)
+		{
+			uint32 randomState = 1000u + workerIndex;
+			HitCounter counter;
+			uint32 version = 0;
+			while(version < (uint32)m_numFrames)
+			{
+				const Snapshot* snapshot = m_snapshots.acquire();
+				version = snapshot->getVersion();
+				if(version > 0)
+				{
+					for(int32 i = 0; i < m_queriesPerFrame; i++)
+					{
+						snapshot->query(makeQuery(randomState), counter);
+						m_numHits[workerIndex] += counter.take();
+					}
+
+					Rect2D queryAABB = makeQuery(randomState);
+					snapshot->query(queryAABB, counter);
+					if(counter.take() != bruteForce(*snapshot, queryAABB)
+						|| snapshot->getNumObjects() != m_numObjects)
+					{
+						m_numMismatches[workerIndex]++;
+					}
+
+					m_numQueries[workerIndex] += m_queriesPerFrame + 1;
+					m_numSnapshots[workerIndex]++;
+				}
+				m_snapshots.release(snapshot);
+			}
+		}
+
+		World& m_world;
+		int32 m_numObjects;
+		int32 m_numFrames;
+		int32 m_queriesPerFrame;
+		SnapshotBuffer<Snapshot> m_snapshots;
+		double m_frameSeconds;
+		double m_publishSeconds;
+		//one slot per worker, read after execute() returns
+		std::vector<int32> m_numQueries;
+		std::vector<int32> m_numSnapshots;
+		std::vector<int32> m_numMismatches;
+		std::vector<double> m_numHits;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	int32 numObjects = (argc > 1) ? atoi(argv[1]) : 20000;
+	int32 numFrames = (argc > 2) ? atoi(argv[2]) : 200;
+	int32 numReaders = (argc > 3) ? atoi(argv[3]) : 3;
+	int32 queriesPerFrame = (argc > 4) ? atoi(argv[4]) : 2000;
+
+	printf("objects: %d, frames: %d, readers: %d, queries per frame: %d (%d processors)\n",
+			numObjects, numFrames, numReaders, queriesPerFrame, WorkerPool::getNumProcessors());
+
+	//serial: the queries wait for the update of the frame
+	double serialMs;
+	double serialHits = 0.0;
+	{
+		World world(numObjects);
+		uint32 randomState = 1001u;
+		HitCounter counter;
+
+		double startTime = bench::now();
+		for(int32 frame = 0; frame < numFrames; frame++)
+		{
+			world.update();
+			for(int32 i = 0; i < queriesPerFrame; i++)
+			{
+				world.getTree().query(makeQuery(randomState), counter);
+				serialHits += counter.take();
+			}
+		}
+		serialMs = (bench::now() - startTime) * 1.0e3 / numFrames;
+		serialHits /= (double)numFrames * queriesPerFrame;
+	}
+
+	World world(numObjects);
+	WorkerPool workers;
+	workers.create(std::max(numReaders, 1));
+
+	OverlappedTask task(world, numObjects, numFrames, queriesPerFrame, workers.getNumWorkers());
+	workers.execute(&task);
+	workers.destroy();
+
+	printf("  serial (update + queries)         %9.3f ms/frame, %d queries per frame, %.1f hits per query\n",
+			serialMs, queriesPerFrame, serialHits);
+	printf("  overlapped (update + publish)     %9.3f ms/frame, publish %.3f ms, "
+			"readers: %.1f queries per frame over %d snapshots, %.1f hits per query\n",
+			task.getFrameMs(), task.getPublishMs(), (double)task.getNumQueries() / numFrames,
+			task.getNumSnapshots(), task.getHitsPerQuery());
+	printf("  %d mismatches\n", task.getNumMismatches());
+
+	return (task.getNumMismatches() == 0) ? 0 : 1;
+}
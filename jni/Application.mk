@@ -1,6 +1,7 @@
 APP_ABI := armeabi
 #APP_ABI := x86
 APP_CPPFLAGS += -fexceptions
+APP_CPPFLAGS += -fno-rtti
 APP_STL := stlport_static
 APP_PLATFORM := android-14
 APP_MODULES := game
@@ -0,0 +1,121 @@
+#include "../common.h"
+#include "host_game_application.h"
+
+#include "../system/log.h"
+
+#ifdef PEGAS_HOST
+
+namespace pegas
+{
+	HostGameApplication::HostGameApplication(const std::string& assetsPath,
+			int32 canvasWidth, int32 canvasHeight)
+		:m_assetsPath(assetsPath),
+		 m_canvasWidth(canvasWidth),
+		 m_canvasHeight(canvasHeight),
+		 m_tapInterval(0),
+		 m_stepsDone(0)
+	{
+		//simulation runs at 60 steps per second regardless of the host speed,
+		//so a run of N steps is reproducible
+		m_timer.setFixedStep(1.0 / 60.0);
+	}
+
+	bool HostGameApplication::init()
+	{
+		LOGI("HostGameApplication::init");
+
+		if(!BaseGameApplication::init())
+		{
+			return false;
+		}
+
+		m_gfx = Gfx::createInstance(m_assetsPath, m_canvasWidth, m_canvasHeight);
+		if(!m_gfx.IsValid())
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	void HostGameApplication::cleanup()
+	{
+		LOGI("HostGameApplication::cleanup");
+
+		if(m_gfx.IsValid())
+		{
+			BaseGameApplication::cleanup();
+		}
+	}
+
+	void HostGameApplication::injectTap(float x, float y)
+	{
+		LOGI_LOOP("HostGameApplication::injectTap [x = %.2f, y = %.2f]", x, y);
+
+		for(std::list<IMouseController*>::iterator it = m_mouseInputHandlers.begin();
+				it != m_mouseInputHandlers.end(); ++it)
+		{
+			(*it)->onMouseButtonDown(k_mouseButtonLeft, x, y, 0);
+		}
+
+		for(std::list<IMouseController*>::iterator it = m_mouseInputHandlers.begin();
+				it != m_mouseInputHandlers.end(); ++it)
+		{
+			(*it)->onMouseButtonUp(k_mouseButtonLeft, x, y, 0);
+		}
+	}
+
+	//------------------------------------------------------------------------------------
+	//IActivityHandler implementation
+	//------------------------------------------------------------------------------------
+	status HostGameApplication::onActivate()
+	{
+		LOGI("HostGameApplication::onActivate");
+
+		if(!init())
+		{
+			return STATUS_KO;
+		}
+
+		return STATUS_OK;
+	}
+
+	void HostGameApplication::onDeactivate()
+	{
+		LOGI("HostGameApplication::onDeactivate");
+
+		cleanup();
+	}
+
+	status HostGameApplication::onStep()
+	{
+		if(m_tapInterval > 0 && (m_stepsDone % m_tapInterval) == (m_tapInterval - 1))
+		{
+			injectTap(m_canvasWidth * 0.5f, m_canvasHeight * 0.5f);
+		}
+		m_stepsDone++;
+
+		if(run())
+		{
+			return STATUS_KO;
+		}
+
+		return STATUS_OK;
+	}
+
+	void HostGameApplication::onGainFocus()
+	{
+		LOGI("HostGameApplication::onGainFocus");
+
+		activate(true);
+	}
+
+	void HostGameApplication::onLostFocus()
+	{
+		LOGI("HostGameApplication::onLostFocus");
+
+		activate(false);
+	}
+}
+
+#endif //PEGAS_HOST
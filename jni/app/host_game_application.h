@@ -0,0 +1,46 @@
+#ifndef PEGAS_APP_HOST_GAME_APPLICATION_H_
+#define PEGAS_APP_HOST_GAME_APPLICATION_H_
+
+#include "base_game_application.h"
+
+#ifdef PEGAS_HOST
+
+namespace pegas
+{
+	//headless desktop application: null Gfx, fixed time step
+	//and synthetic taps instead of touch input
+	class HostGameApplication: public BaseGameApplication,
+							   public IActivityHandler
+	{
+	public:
+		HostGameApplication(const std::string& assetsPath,
+				int32 canvasWidth = 480, int32 canvasHeight = 800);
+
+		virtual bool init();
+		virtual void cleanup();
+
+		//every 'steps' steps a tap is injected in the middle of the canvas (0 - no taps)
+		void setTapInterval(int32 steps) { m_tapInterval = steps; }
+		void injectTap(float x, float y);
+
+	public:
+		//IActivityHandler
+		virtual status onActivate();
+		virtual void onDeactivate();
+		virtual status onStep();
+
+		virtual void onGainFocus();
+		virtual void onLostFocus();
+
+	private:
+		std::string m_assetsPath;
+		int32 m_canvasWidth;
+		int32 m_canvasHeight;
+		int32 m_tapInterval;
+		int32 m_stepsDone;
+	};
+}
+
+#endif //PEGAS_HOST
+
+#endif /* APP_HOST_GAME_APPLICATION_H_ */
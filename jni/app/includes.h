@@ -16,6 +16,10 @@
 #include "game_state_manager.h"
 #include "waiting.h"
 #include "base_game_application.h"
+#ifdef ANDROID
 #include "android_game_application.h"
+#else
+#include "host_game_application.h"
+#endif
 
 #endif /* APP_INCLUDES_H_ */
@@ -161,6 +161,9 @@ namespace pegas
 		{
 			ProcessHandle handle = getNextHandle();
 			m_newProcesses.insert(std::make_pair(handle, process));
+			//handle is known to the process before it starts,
+			//so the owner can use it as an object id right after attaching
+			process->m_handle = handle;
 
 			return handle;
 		}
@@ -175,7 +178,7 @@ namespace pegas
 			}
 
 			found_it  = m_newProcesses.find(handle);
-			if(found_it != m_activeProcesses.end())
+			if(found_it != m_newProcesses.end())
 			{
 				return found_it->second;
 			}
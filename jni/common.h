@@ -1,6 +1,8 @@
 #ifndef PEGAS_ENGINE_H_
 #define PEGAS_ENGINE_H_
 
+#ifndef PEGAS_HOST
+
 #ifndef ANDROID
 #define ANDROID
 #endif
@@ -9,10 +11,28 @@
 #define PEGAS_USE_GLES_1x
 #endif
 
+#else
+
+#ifndef PEGAS_USE_NULL_GFX
+#define PEGAS_USE_NULL_GFX
+#endif
+
+#endif
+
 #ifndef PEGAS_USE_SCREEN_COORDS
 #define PEGAS_USE_SCREEN_COORDS
 #endif
 
+//vector instruction set for the collision kernels,
+//PEGAS_NO_SIMD forces the scalar path
+#ifndef PEGAS_NO_SIMD
+#if defined(__SSE2__)
+#define PEGAS_USE_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define PEGAS_USE_NEON
+#endif
+#endif
+
 //Standart lib
 #include <stdlib.h>
 #include <stdint.h>
@@ -38,6 +58,7 @@
 #include <limits>
 
 
+#ifdef ANDROID
 //Android
 #include <android_native_app_glue.h>
 
@@ -45,6 +66,11 @@
 #include <EGL/egl.h>
 #include <GLES/gl.h>
 #include <GLES/glext.h>
+#endif
+
+#ifdef PEGAS_USE_NULL_GFX
+#include "gfx/null_gl.h"
+#endif
 
 //Rapid XML
 #include "xml/rapidxml.hpp"
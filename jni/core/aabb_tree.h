@@ -0,0 +1,1079 @@
+#ifndef CORE_AABB_TREE_H_
+#define CORE_AABB_TREE_H_
+
+#include "../core/geometry.h"
+#include "../core/spatial_index.h"
+#include "../core/spatial_snapshot.h"
+#include "../system/log.h"
+
+namespace pegas
+{
+	//	  AABB (BVH):  -   ,  
+	//	   .   AABB ,  
+	//	FatPercent / 100     :   AABB  
+	//	 , updateObject   .     
+	//	   ,       ,
+	//	     ,   AVL-,  
+	//	     1.
+	//	         ,  
+	//	k_rebuildPercent  ,      
+	//	      :      
+	//	   ,       (SAH 
+	//	k_numBins      ).   
+	//	       ,  .   
+	//	  ,    AABB      handle,
+	//	  handle  .     
+	template<typename T, int32 FatPercent = 25>
+	class AABBTree
+	{
+	public:
+		AABBTree();
+
+		void create(const Rect2D& worldArea);
+		void destroy();
+
+		//handle   k_invalidSpatialHandle    
+		SpatialHandle insertObject(const T& object, const Rect2D& objectAABB);
+		//handle  k_invalidSpatialHandle
+		bool removeObject(SpatialHandle& handle);
+		//   , handle  k_invalidSpatialHandle
+		//  false
+		bool updateObject(SpatialHandle& handle, const Rect2D& objectAABB);
+		//handle    
+		bool removeAllObjects();
+
+		bool isValidHandle(SpatialHandle handle) const
+		{
+			return handle >= 0 && handle < (int32)m_leaves.size() && m_leaves[handle]._node != k_nullNode;
+		}
+
+		//     result
+		void query(const Rect2D& objectAABB, std::list<T>& result);
+		void query(const Point2D& queryPoint, std::list<T>& result);
+		void query(const Rect2D& objectAABB, std::vector<T>& result);
+		void query(const Point2D& queryPoint, std::vector<T>& result);
+
+		//   : visitor(object)     
+		template<typename Visitor>
+		void query(const Rect2D& objectAABB, Visitor& visitor);
+		template<typename Visitor>
+		void query(const Point2D& queryPoint, Visitor& visitor);
+
+		// ,  AABB,   radius,  origin + direction * t 
+		//  maxDistance.    , visitor(object, maxDistance)
+		//  maxDistance - ,   , 
+		template<typename Visitor>
+		void castRay(const Point2D& origin, const Point2D& direction, float radius,
+				float maxDistance, Visitor& visitor);
+
+		//,    castRay   
+		int32 getNumNodesVisited() const { return m_numNodesVisited; }
+		void resetNumNodesVisited() { m_numNodesVisited = 0; }
+		//,    AABB   ,   
+		int32 getNumReinsertions() const { return m_numReinsertions; }
+		void resetNumReinsertions() { m_numReinsertions = 0; }
+
+		//  ,   . handle   
+		void rebuild();
+
+		// :    ,    
+		uint32 getVersion() const { return m_version; }
+		//    ,  -     
+		void appendToSnapshot(SpatialSnapshot<T>& snapshot) const;
+
+	private:
+		enum
+		{
+			k_nullNode = -1,
+			k_displacementMultiplier = 4,
+			k_rebuildPercent = 50,
+			k_minRebuildObjects = 64,
+			k_numBins = 16
+		};
+
+		//    (min, max)   PEGAS_USE_SCREEN_COORDS
+		struct Node
+		{
+			Rect2D _bounds;
+			//   -  
+			int32 _parent;
+			int32 _child1;
+			//  - handle 
+			int32 _child2;
+			//  0,    -1
+			int32 _height;
+
+			bool isLeaf() const { return _child1 == k_nullNode; }
+		};
+
+		struct Leaf
+		{
+			T _object;
+			Rect2D _objectAABB;
+			// , k_nullNode   handle
+			int32 _node;
+		};
+
+		//  :   AABB   
+		struct BuildEntry
+		{
+			SpatialHandle _handle;
+			Rect2D _bounds;
+			float _centerX;
+			float _centerY;
+		};
+
+		//    ,    
+		struct BuildTask
+		{
+			int32 _node;
+			int32 _begin;
+			int32 _end;
+		};
+
+		//       
+		struct CastEntry
+		{
+			int32 _node;
+			float _distance;
+		};
+
+		static Rect2D getBounds(const Rect2D& rect);
+		static Rect2D getFatBounds(const Rect2D& objectAABB);
+		static Rect2D merge(const Rect2D& a, const Rect2D& b);
+		static float getPerimeter(const Rect2D& bounds);
+		static bool contains(const Rect2D& bounds, const Rect2D& other);
+		static bool overlaps(const Rect2D& bounds, const Rect2D& other);
+
+		int32 allocateNode();
+		void freeNode(int32 index);
+		int32 getNumObjects() const { return (int32)(m_leaves.size() - m_freeHandles.size()); }
+		//,      
+		void rebuildIfChanged();
+		//  [begin, end)    ,   
+		int32 splitBuildEntries(int32 begin, int32 end);
+		void insertLeaf(int32 leaf);
+		void removeLeaf(int32 leaf);
+		//     index  ,   
+		void refit(int32 index);
+		//  index,  ,    
+		int32 balance(int32 index);
+		void appendNode(int32 index, SpatialSnapshot<T>& snapshot) const;
+
+		std::vector<Node> m_nodes;
+		int32 m_root;
+		int32 m_firstFreeNode;
+		std::vector<Leaf> m_leaves;
+		std::vector<SpatialHandle> m_freeHandles;
+		//,      
+		int32 m_numChanges;
+		// ,  
+		std::vector<int32> m_stack;
+		std::vector<CastEntry> m_castStack;
+		// ,  
+		std::vector<BuildEntry> m_buildEntries;
+		std::vector<BuildTask> m_buildTasks;
+		int32 m_numNodesVisited;
+		int32 m_numReinsertions;
+		uint32 m_version;
+
+	private:
+		AABBTree(const AABBTree& other);
+		AABBTree& operator=(const AABBTree& other);
+	};
+
+	//-----------------------------------------------------------------------------
+	//	AABBTree class implementation
+	//-----------------------------------------------------------------------------
+	template<typename T, int32 FatPercent>
+	inline AABBTree<T, FatPercent>::AABBTree()
+		:m_root(k_nullNode), m_firstFreeNode(k_nullNode), m_numChanges(0), m_numNodesVisited(0),
+		 m_numReinsertions(0), m_version(0)
+	{
+
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::create(const Rect2D& worldArea)
+	{
+		LOGD_LOOP("AABBTree::create [worldArea: x1  = %.2f, y1  = %.2f, x2  = %.2f, y2  = %.2f]",
+				worldArea._topLeft._x, worldArea._topLeft._y,
+				worldArea._bottomRight._x, worldArea._bottomRight._y);
+
+		destroy();
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::destroy()
+	{
+		removeAllObjects();
+	}
+
+	template<typename T, int32 FatPercent>
+	inline bool AABBTree<T, FatPercent>::removeAllObjects()
+	{
+		//     
+		m_nodes.clear();
+		m_leaves.clear();
+		m_freeHandles.clear();
+		m_root = k_nullNode;
+		m_firstFreeNode = k_nullNode;
+		m_numChanges = 0;
+		m_version++;
+
+		return true;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline SpatialHandle AABBTree<T, FatPercent>::insertObject(const T& object, const Rect2D& objectAABB)
+	{
+		if(objectAABB.width() == 0.0f || objectAABB.height() == 0.0f)
+		{
+			LOGE("could not insert null sized object");
+			return k_invalidSpatialHandle;
+		}
+
+		SpatialHandle handle;
+		if(m_freeHandles.empty())
+		{
+			handle = (SpatialHandle)m_leaves.size();
+			m_leaves.push_back(Leaf());
+		}else
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}
+
+		int32 leaf = allocateNode();
+		Node& node = m_nodes[leaf];
+		node._bounds = getFatBounds(objectAABB);
+		node._child2 = handle;
+		node._height = 0;
+
+		Leaf& entry = m_leaves[handle];
+		entry._object = object;
+		entry._objectAABB = objectAABB;
+		entry._node = leaf;
+
+		insertLeaf(leaf);
+		m_numChanges++;
+		m_version++;
+
+		return handle;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline bool AABBTree<T, FatPercent>::removeObject(SpatialHandle& handle)
+	{
+		if(!isValidHandle(handle))
+		{
+			return false;
+		}
+
+		Leaf& entry = m_leaves[handle];
+		removeLeaf(entry._node);
+		freeNode(entry._node);
+		entry._object = T();
+		entry._node = k_nullNode;
+		m_freeHandles.push_back(handle);
+
+		handle = k_invalidSpatialHandle;
+		m_numChanges++;
+		m_version++;
+
+		return true;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline bool AABBTree<T, FatPercent>::updateObject(SpatialHandle& handle, const Rect2D& objectAABB)
+	{
+		assert(isValidHandle(handle) && "updating an object that is not in the aabb tree");
+
+		if(objectAABB.width() == 0.0f || objectAABB.height() == 0.0f)
+		{
+			LOGE("could not insert null sized object");
+
+			removeObject(handle);
+			return false;
+		}
+
+		Leaf& entry = m_leaves[handle];
+		Node& node = m_nodes[entry._node];
+		Rect2D oldBounds = getBounds(entry._objectAABB);
+		Rect2D newBounds = getBounds(objectAABB);
+		entry._objectAABB = objectAABB;
+		m_version++;
+
+		if(contains(node._bounds, newBounds))
+		{
+			return true;
+		}
+
+		// AABB    : , 
+		//   ,  k_displacementMultiplier    
+		Rect2D fatBounds = getFatBounds(objectAABB);
+		float dx = (newBounds._topLeft._x - oldBounds._topLeft._x) * k_displacementMultiplier;
+		float dy = (newBounds._topLeft._y - oldBounds._topLeft._y) * k_displacementMultiplier;
+		if(dx < 0.0f)
+		{
+			fatBounds._topLeft._x += dx;
+		}else
+		{
+			fatBounds._bottomRight._x += dx;
+		}
+
+		if(dy < 0.0f)
+		{
+			fatBounds._topLeft._y += dy;
+		}else
+		{
+			fatBounds._bottomRight._y += dy;
+		}
+
+		int32 leaf = entry._node;
+		removeLeaf(leaf);
+		m_nodes[leaf]._bounds = fatBounds;
+		insertLeaf(leaf);
+		m_numReinsertions++;
+		m_numChanges++;
+
+		return true;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline int32 AABBTree<T, FatPercent>::allocateNode()
+	{
+		if(m_firstFreeNode == k_nullNode)
+		{
+			m_nodes.push_back(Node());
+			m_nodes.back()._parent = k_nullNode;
+			m_firstFreeNode = (int32)m_nodes.size() - 1;
+		}
+
+		int32 index = m_firstFreeNode;
+		Node& node = m_nodes[index];
+		m_firstFreeNode = node._parent;
+
+		node._parent = k_nullNode;
+		node._child1 = k_nullNode;
+		node._child2 = k_nullNode;
+		node._height = 0;
+
+		return index;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::freeNode(int32 index)
+	{
+		Node& node = m_nodes[index];
+		node._parent = m_firstFreeNode;
+		node._height = -1;
+		m_firstFreeNode = index;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::rebuildIfChanged()
+	{
+		int32 numObjects = getNumObjects();
+		if(numObjects >= k_minRebuildObjects && m_numChanges * 100 >= numObjects * k_rebuildPercent)
+		{
+			rebuild();
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::rebuild()
+	{
+		m_numChanges = 0;
+
+		m_buildEntries.clear();
+		for(SpatialHandle handle = 0; handle < (SpatialHandle)m_leaves.size(); handle++)
+		{
+			int32 leaf = m_leaves[handle]._node;
+			if(leaf != k_nullNode)
+			{
+				BuildEntry entry;
+				entry._handle = handle;
+				entry._bounds = m_nodes[leaf]._bounds;
+				entry._centerX = entry._bounds._topLeft._x + entry._bounds._bottomRight._x;
+				entry._centerY = entry._bounds._topLeft._y + entry._bounds._bottomRight._y;
+				m_buildEntries.push_back(entry);
+			}
+		}
+
+		int32 numEntries = (int32)m_buildEntries.size();
+		m_nodes.clear();
+		m_firstFreeNode = k_nullNode;
+		m_root = k_nullNode;
+		if(numEntries == 0)
+		{
+			return;
+		}
+
+		//     ,  -   
+		m_nodes.resize(2 * numEntries - 1);
+		m_root = 0;
+		m_nodes[m_root]._parent = k_nullNode;
+		int32 numNodes = 1;
+
+		BuildTask task;
+		task._node = m_root;
+		task._begin = 0;
+		task._end = numEntries;
+		m_buildTasks.clear();
+		m_buildTasks.push_back(task);
+
+		while(!m_buildTasks.empty())
+		{
+			task = m_buildTasks.back();
+			m_buildTasks.pop_back();
+
+			Node& node = m_nodes[task._node];
+			if(task._end - task._begin == 1)
+			{
+				const BuildEntry& entry = m_buildEntries[task._begin];
+				node._bounds = entry._bounds;
+				node._child1 = k_nullNode;
+				node._child2 = entry._handle;
+				node._height = 0;
+				m_leaves[entry._handle]._node = task._node;
+				continue;
+			}
+
+			int32 split = splitBuildEntries(task._begin, task._end);
+			node._child1 = numNodes;
+			node._child2 = numNodes + 1;
+			m_nodes[node._child1]._parent = task._node;
+			m_nodes[node._child2]._parent = task._node;
+			numNodes += 2;
+
+			//   ,      
+			BuildTask second;
+			second._node = node._child2;
+			second._begin = split;
+			second._end = task._end;
+			m_buildTasks.push_back(second);
+
+			task._node = node._child1;
+			task._end = split;
+			m_buildTasks.push_back(task);
+		}
+
+		//   ,      
+		for(int32 index = numNodes - 1; index >= 0; index--)
+		{
+			Node& node = m_nodes[index];
+			if(!node.isLeaf())
+			{
+				const Node& child1 = m_nodes[node._child1];
+				const Node& child2 = m_nodes[node._child2];
+				node._bounds = merge(child1._bounds, child2._bounds);
+				node._height = 1 + std::max(child1._height, child2._height);
+			}
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	inline int32 AABBTree<T, FatPercent>::splitBuildEntries(int32 begin, int32 end)
+	{
+		//     
+		float minX = m_buildEntries[begin]._centerX;
+		float minY = m_buildEntries[begin]._centerY;
+		float maxX = minX;
+		float maxY = minY;
+		for(int32 i = begin + 1; i < end; i++)
+		{
+			const BuildEntry& entry = m_buildEntries[i];
+			minX = std::min(minX, entry._centerX);
+			minY = std::min(minY, entry._centerY);
+			maxX = std::max(maxX, entry._centerX);
+			maxY = std::max(maxY, entry._centerY);
+		}
+
+		bool alongX = (maxX - minX) >= (maxY - minY);
+		float minCenter = alongX ? minX : minY;
+		float extent = alongX ? (maxX - minX) : (maxY - minY);
+		if(extent <= 0.0f)
+		{
+			// ,   
+			return (begin + end) / 2;
+		}
+
+		Rect2D binBounds[k_numBins];
+		int32 binCounts[k_numBins];
+		for(int32 bin = 0; bin < k_numBins; bin++)
+		{
+			binCounts[bin] = 0;
+		}
+
+		float binScale = k_numBins / extent;
+		for(int32 i = begin; i < end; i++)
+		{
+			const BuildEntry& entry = m_buildEntries[i];
+			int32 bin = std::min((int32)(((alongX ? entry._centerX : entry._centerY) - minCenter) * binScale),
+					(int32)k_numBins - 1);
+			binBounds[bin] = (binCounts[bin] == 0) ? entry._bounds : merge(binBounds[bin], entry._bounds);
+			binCounts[bin]++;
+		}
+
+		//    bin:   ,      
+		float rightCosts[k_numBins];
+		Rect2D bounds;
+		int32 count = 0;
+		for(int32 bin = k_numBins - 1; bin > 0; bin--)
+		{
+			if(binCounts[bin] > 0)
+			{
+				bounds = (count == 0) ? binBounds[bin] : merge(bounds, binBounds[bin]);
+				count += binCounts[bin];
+			}
+			rightCosts[bin] = count * getPerimeter(bounds);
+		}
+
+		//     ,     
+		int32 splitBin = 0;
+		float splitCost = std::numeric_limits<float>::max();
+		count = 0;
+		for(int32 bin = 0; bin < k_numBins - 1; bin++)
+		{
+			if(binCounts[bin] > 0)
+			{
+				bounds = (count == 0) ? binBounds[bin] : merge(bounds, binBounds[bin]);
+				count += binCounts[bin];
+			}
+
+			if(count > 0 && count < end - begin)
+			{
+				float cost = count * getPerimeter(bounds) + rightCosts[bin + 1];
+				if(cost < splitCost)
+				{
+					splitCost = cost;
+					splitBin = bin;
+				}
+			}
+		}
+
+		int32 first = begin;
+		int32 last = end - 1;
+		while(first <= last)
+		{
+			const BuildEntry& entry = m_buildEntries[first];
+			int32 bin = std::min((int32)(((alongX ? entry._centerX : entry._centerY) - minCenter) * binScale),
+					(int32)k_numBins - 1);
+			if(bin <= splitBin)
+			{
+				first++;
+			}else
+			{
+				std::swap(m_buildEntries[first], m_buildEntries[last]);
+				last--;
+			}
+		}
+
+		return first;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::insertLeaf(int32 leaf)
+	{
+		if(m_root == k_nullNode)
+		{
+			m_root = leaf;
+			m_nodes[leaf]._parent = k_nullNode;
+			return;
+		}
+
+		//,     ,      .
+		// -        
+		Rect2D leafBounds = m_nodes[leaf]._bounds;
+		int32 index = m_root;
+		while(!m_nodes[index].isLeaf())
+		{
+			const Node& node = m_nodes[index];
+
+			float perimeter = getPerimeter(node._bounds);
+			float combinedPerimeter = getPerimeter(merge(node._bounds, leafBounds));
+
+			float cost = 2.0f * combinedPerimeter;
+			float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+			float childCosts[2];
+			int32 childs[2] = { node._child1, node._child2 };
+			for(int32 i = 0; i < 2; i++)
+			{
+				const Node& child = m_nodes[childs[i]];
+				float childPerimeter = getPerimeter(merge(child._bounds, leafBounds));
+				if(!child.isLeaf())
+				{
+					childPerimeter -= getPerimeter(child._bounds);
+				}
+
+				childCosts[i] = childPerimeter + inheritanceCost;
+			}
+
+			if(cost < childCosts[0] && cost < childCosts[1])
+			{
+				break;
+			}
+
+			index = (childCosts[0] < childCosts[1]) ? childs[0] : childs[1];
+		}
+
+		int32 sibling = index;
+		int32 oldParent = m_nodes[sibling]._parent;
+		int32 newParent = allocateNode();
+
+		Node& parent = m_nodes[newParent];
+		parent._parent = oldParent;
+		parent._bounds = merge(leafBounds, m_nodes[sibling]._bounds);
+		parent._height = m_nodes[sibling]._height + 1;
+		parent._child1 = sibling;
+		parent._child2 = leaf;
+
+		if(oldParent != k_nullNode)
+		{
+			if(m_nodes[oldParent]._child1 == sibling)
+			{
+				m_nodes[oldParent]._child1 = newParent;
+			}else
+			{
+				m_nodes[oldParent]._child2 = newParent;
+			}
+		}else
+		{
+			m_root = newParent;
+		}
+
+		m_nodes[sibling]._parent = newParent;
+		m_nodes[leaf]._parent = newParent;
+
+		refit(m_nodes[leaf]._parent);
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::removeLeaf(int32 leaf)
+	{
+		if(leaf == m_root)
+		{
+			m_root = k_nullNode;
+			return;
+		}
+
+		int32 parent = m_nodes[leaf]._parent;
+		int32 grandParent = m_nodes[parent]._parent;
+		int32 sibling = (m_nodes[parent]._child1 == leaf) ? m_nodes[parent]._child2 : m_nodes[parent]._child1;
+
+		//     
+		if(grandParent != k_nullNode)
+		{
+			if(m_nodes[grandParent]._child1 == parent)
+			{
+				m_nodes[grandParent]._child1 = sibling;
+			}else
+			{
+				m_nodes[grandParent]._child2 = sibling;
+			}
+		}else
+		{
+			m_root = sibling;
+		}
+
+		m_nodes[sibling]._parent = grandParent;
+		freeNode(parent);
+
+		refit(grandParent);
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::refit(int32 index)
+	{
+		while(index != k_nullNode)
+		{
+			index = balance(index);
+
+			Node& node = m_nodes[index];
+			const Node& child1 = m_nodes[node._child1];
+			const Node& child2 = m_nodes[node._child2];
+			node._height = 1 + std::max(child1._height, child2._height);
+			node._bounds = merge(child1._bounds, child2._bounds);
+
+			index = node._parent;
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	inline int32 AABBTree<T, FatPercent>::balance(int32 iA)
+	{
+		Node& A = m_nodes[iA];
+		if(A.isLeaf() || A._height < 2)
+		{
+			return iA;
+		}
+
+		int32 iB = A._child1;
+		int32 iC = A._child2;
+		Node& B = m_nodes[iB];
+		Node& C = m_nodes[iC];
+
+		int32 difference = C._height - B._height;
+
+		//C    A, A   C   
+		if(difference > 1)
+		{
+			int32 iF = C._child1;
+			int32 iG = C._child2;
+			Node& F = m_nodes[iF];
+			Node& G = m_nodes[iG];
+
+			C._child1 = iA;
+			C._parent = A._parent;
+			A._parent = iC;
+
+			if(C._parent != k_nullNode)
+			{
+				if(m_nodes[C._parent]._child1 == iA)
+				{
+					m_nodes[C._parent]._child1 = iC;
+				}else
+				{
+					m_nodes[C._parent]._child2 = iC;
+				}
+			}else
+			{
+				m_root = iC;
+			}
+
+			if(F._height > G._height)
+			{
+				C._child2 = iF;
+				A._child2 = iG;
+				G._parent = iA;
+				A._bounds = merge(B._bounds, G._bounds);
+				C._bounds = merge(A._bounds, F._bounds);
+				A._height = 1 + std::max(B._height, G._height);
+				C._height = 1 + std::max(A._height, F._height);
+			}else
+			{
+				C._child2 = iG;
+				A._child2 = iF;
+				F._parent = iA;
+				A._bounds = merge(B._bounds, F._bounds);
+				C._bounds = merge(A._bounds, G._bounds);
+				A._height = 1 + std::max(B._height, F._height);
+				C._height = 1 + std::max(A._height, G._height);
+			}
+
+			return iC;
+		}
+
+		//   B
+		if(difference < -1)
+		{
+			int32 iD = B._child1;
+			int32 iE = B._child2;
+			Node& D = m_nodes[iD];
+			Node& E = m_nodes[iE];
+
+			B._child1 = iA;
+			B._parent = A._parent;
+			A._parent = iB;
+
+			if(B._parent != k_nullNode)
+			{
+				if(m_nodes[B._parent]._child1 == iA)
+				{
+					m_nodes[B._parent]._child1 = iB;
+				}else
+				{
+					m_nodes[B._parent]._child2 = iB;
+				}
+			}else
+			{
+				m_root = iB;
+			}
+
+			if(D._height > E._height)
+			{
+				B._child2 = iD;
+				A._child1 = iE;
+				E._parent = iA;
+				A._bounds = merge(C._bounds, E._bounds);
+				B._bounds = merge(A._bounds, D._bounds);
+				A._height = 1 + std::max(C._height, E._height);
+				B._height = 1 + std::max(A._height, D._height);
+			}else
+			{
+				B._child2 = iE;
+				A._child1 = iD;
+				D._parent = iA;
+				A._bounds = merge(C._bounds, D._bounds);
+				B._bounds = merge(A._bounds, E._bounds);
+				A._height = 1 + std::max(C._height, D._height);
+				B._height = 1 + std::max(A._height, E._height);
+			}
+
+			return iB;
+		}
+
+		return iA;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline Rect2D AABBTree<T, FatPercent>::getBounds(const Rect2D& rect)
+	{
+		return Rect2D(Point2D(std::min(rect._topLeft._x, rect._bottomRight._x), std::min(rect._topLeft._y, rect._bottomRight._y)),
+				Point2D(std::max(rect._topLeft._x, rect._bottomRight._x), std::max(rect._topLeft._y, rect._bottomRight._y)));
+	}
+
+	template<typename T, int32 FatPercent>
+	inline Rect2D AABBTree<T, FatPercent>::getFatBounds(const Rect2D& objectAABB)
+	{
+		Rect2D bounds = getBounds(objectAABB);
+		float marginX = bounds.width() * (FatPercent / 100.0f);
+		float marginY = bounds.height() * (FatPercent / 100.0f);
+
+		return Rect2D(Point2D(bounds._topLeft._x - marginX, bounds._topLeft._y - marginY),
+				Point2D(bounds._bottomRight._x + marginX, bounds._bottomRight._y + marginY));
+	}
+
+	template<typename T, int32 FatPercent>
+	inline Rect2D AABBTree<T, FatPercent>::merge(const Rect2D& a, const Rect2D& b)
+	{
+		return Rect2D(Point2D(std::min(a._topLeft._x, b._topLeft._x), std::min(a._topLeft._y, b._topLeft._y)),
+				Point2D(std::max(a._bottomRight._x, b._bottomRight._x), std::max(a._bottomRight._y, b._bottomRight._y)));
+	}
+
+	template<typename T, int32 FatPercent>
+	inline float AABBTree<T, FatPercent>::getPerimeter(const Rect2D& bounds)
+	{
+		return 2.0f * ((bounds._bottomRight._x - bounds._topLeft._x) + (bounds._bottomRight._y - bounds._topLeft._y));
+	}
+
+	template<typename T, int32 FatPercent>
+	inline bool AABBTree<T, FatPercent>::contains(const Rect2D& bounds, const Rect2D& other)
+	{
+		return other._topLeft._x >= bounds._topLeft._x && other._topLeft._y >= bounds._topLeft._y
+			&& other._bottomRight._x <= bounds._bottomRight._x && other._bottomRight._y <= bounds._bottomRight._y;
+	}
+
+	template<typename T, int32 FatPercent>
+	inline bool AABBTree<T, FatPercent>::overlaps(const Rect2D& bounds, const Rect2D& other)
+	{
+		return other._topLeft._x <= bounds._bottomRight._x && other._bottomRight._x >= bounds._topLeft._x
+			&& other._topLeft._y <= bounds._bottomRight._y && other._bottomRight._y >= bounds._topLeft._y;
+	}
+
+	template<typename T, int32 FatPercent>
+	template<typename Visitor>
+	inline void AABBTree<T, FatPercent>::query(const Rect2D& queryAABB, Visitor& visitor)
+	{
+		rebuildIfChanged();
+
+		Rect2D queryBounds = getBounds(queryAABB);
+		if(m_root == k_nullNode || !overlaps(m_nodes[m_root]._bounds, queryBounds))
+		{
+			return;
+		}
+
+		m_stack.clear();
+		m_stack.push_back(m_root);
+		while(!m_stack.empty())
+		{
+			const Node& node = m_nodes[m_stack.back()];
+			m_stack.pop_back();
+			m_numNodesVisited++;
+
+			if(node.isLeaf())
+			{
+				//  ,   QuadTree
+				const Leaf& leaf = m_leaves[node._child2];
+				const Rect2D& rect = leaf._objectAABB;
+				if(queryAABB.contains(rect) || rect.contains(queryAABB) || queryAABB.intersectsWith(rect))
+				{
+					visitor(leaf._object);
+				}
+			}else
+			{
+				//    ,  
+				if(overlaps(m_nodes[node._child2]._bounds, queryBounds))
+				{
+					m_stack.push_back(node._child2);
+				}
+
+				if(overlaps(m_nodes[node._child1]._bounds, queryBounds))
+				{
+					m_stack.push_back(node._child1);
+				}
+			}
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	template<typename Visitor>
+	inline void AABBTree<T, FatPercent>::query(const Point2D& queryPoint, Visitor& visitor)
+	{
+		rebuildIfChanged();
+
+		Rect2D queryBounds(queryPoint, queryPoint);
+		if(m_root == k_nullNode || !overlaps(m_nodes[m_root]._bounds, queryBounds))
+		{
+			return;
+		}
+
+		m_stack.clear();
+		m_stack.push_back(m_root);
+		while(!m_stack.empty())
+		{
+			const Node& node = m_nodes[m_stack.back()];
+			m_stack.pop_back();
+			m_numNodesVisited++;
+
+			if(node.isLeaf())
+			{
+				const Leaf& leaf = m_leaves[node._child2];
+				if(leaf._objectAABB.contains(queryPoint))
+				{
+					visitor(leaf._object);
+				}
+			}else
+			{
+				//    ,  
+				if(overlaps(m_nodes[node._child2]._bounds, queryBounds))
+				{
+					m_stack.push_back(node._child2);
+				}
+
+				if(overlaps(m_nodes[node._child1]._bounds, queryBounds))
+				{
+					m_stack.push_back(node._child1);
+				}
+			}
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	template<typename Visitor>
+	inline void AABBTree<T, FatPercent>::castRay(const Point2D& origin, const Point2D& direction, float radius,
+			float maxDistance, Visitor& visitor)
+	{
+		rebuildIfChanged();
+
+		CastEntry entry;
+		if(m_root == k_nullNode
+			|| !intersectRayRect(origin, direction, m_nodes[m_root]._bounds, radius, maxDistance, entry._distance))
+		{
+			return;
+		}
+
+		entry._node = m_root;
+		m_castStack.clear();
+		m_castStack.push_back(entry);
+
+		while(!m_castStack.empty())
+		{
+			entry = m_castStack.back();
+			m_castStack.pop_back();
+
+			if(entry._distance > maxDistance)
+			{
+				continue;
+			}
+
+			const Node& node = m_nodes[entry._node];
+			m_numNodesVisited++;
+
+			float distance;
+			if(node.isLeaf())
+			{
+				const Leaf& leaf = m_leaves[node._child2];
+				if(intersectRayRect(origin, direction, leaf._objectAABB, radius, maxDistance, distance))
+				{
+					visitor(leaf._object, maxDistance);
+				}
+
+				continue;
+			}
+
+			//      
+			CastEntry childs[2];
+			int32 numChilds = 0;
+			int32 childIndices[2] = { node._child1, node._child2 };
+			for(int32 i = 0; i < 2; i++)
+			{
+				if(intersectRayRect(origin, direction, m_nodes[childIndices[i]]._bounds, radius, maxDistance, distance))
+				{
+					childs[numChilds]._node = childIndices[i];
+					childs[numChilds]._distance = distance;
+					numChilds++;
+				}
+			}
+
+			if(numChilds == 2 && childs[0]._distance < childs[1]._distance)
+			{
+				std::swap(childs[0], childs[1]);
+			}
+
+			for(int32 i = 0; i < numChilds; i++)
+			{
+				m_castStack.push_back(childs[i]);
+			}
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::appendToSnapshot(SpatialSnapshot<T>& snapshot) const
+	{
+		if(m_root != k_nullNode)
+		{
+			appendNode(m_root, snapshot);
+		}
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::appendNode(int32 index, SpatialSnapshot<T>& snapshot) const
+	{
+		const Node& node = m_nodes[index];
+		int32 snapshotNode = snapshot.beginNode();
+		if(node.isLeaf())
+		{
+			const Leaf& leaf = m_leaves[node._child2];
+			snapshot.addObject(leaf._object, leaf._objectAABB);
+		}else
+		{
+			appendNode(node._child1, snapshot);
+			appendNode(node._child2, snapshot);
+		}
+
+		snapshot.endNode(snapshotNode);
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::query(const Rect2D& objectAABB, std::list<T>& result)
+	{
+		SpatialCollector<T, std::list<T> > collector(result);
+		query(objectAABB, collector);
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::query(const Point2D& queryPoint, std::list<T>& result)
+	{
+		SpatialCollector<T, std::list<T> > collector(result);
+		query(queryPoint, collector);
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::query(const Rect2D& objectAABB, std::vector<T>& result)
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		query(objectAABB, collector);
+	}
+
+	template<typename T, int32 FatPercent>
+	inline void AABBTree<T, FatPercent>::query(const Point2D& queryPoint, std::vector<T>& result)
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		query(queryPoint, collector);
+	}
+}
+
+#endif /* CORE_AABB_TREE_H_ */
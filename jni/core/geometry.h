@@ -125,6 +125,56 @@ namespace pegas
 		Point2D _topLeft;
 		Point2D _bottomRight;
 	};
+
+	//  origin + direction * t (0 <= t <= maxDistance)  ,
+	//  margin   . distance -  t    
+	//(0,    ).     , t    
+	inline bool intersectRayRect(const Point2D& origin, const Point2D& direction, const Rect2D& rect,
+			float margin, float maxDistance, float& distance)
+	{
+		float minValues[2] = { std::min(rect._topLeft._x, rect._bottomRight._x) - margin,
+				std::min(rect._topLeft._y, rect._bottomRight._y) - margin };
+		float maxValues[2] = { std::max(rect._topLeft._x, rect._bottomRight._x) + margin,
+				std::max(rect._topLeft._y, rect._bottomRight._y) + margin };
+		float origins[2] = { origin._x, origin._y };
+		float directions[2] = { direction._x, direction._y };
+
+		float enter = 0.0f;
+		float exit = maxDistance;
+
+		for(int32 axis = 0; axis < 2; axis++)
+		{
+			if(directions[axis] == 0.0f)
+			{
+				//  ,    
+				if(origins[axis] < minValues[axis] || origins[axis] > maxValues[axis])
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			float inverse = 1.0f / directions[axis];
+			float t1 = (minValues[axis] - origins[axis]) * inverse;
+			float t2 = (maxValues[axis] - origins[axis]) * inverse;
+			if(t1 > t2)
+			{
+				std::swap(t1, t2);
+			}
+
+			enter = std::max(enter, t1);
+			exit = std::min(exit, t2);
+			if(enter > exit)
+			{
+				return false;
+			}
+		}
+
+		distance = enter;
+
+		return true;
+	}
 }
 
 
@@ -16,7 +16,10 @@
 #include "vectors.h"
 #include "matrix.h"
 #include "geometry.h"
+#include "spatial_snapshot.h"
 #include "quad_tree.h"
+#include "linear_quad_tree.h"
+#include "aabb_tree.h"
 
 
 #endif /* CORE_INCLUDES_H_ */
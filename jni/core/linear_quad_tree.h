@@ -0,0 +1,491 @@
+#ifndef CORE_LINEAR_QUAD_TREE_H_
+#define CORE_LINEAR_QUAD_TREE_H_
+
+#include "../core/geometry.h"
+#include "../core/spatial_index.h"
+#include "../core/spatial_snapshot.h"
+#include "../system/log.h"
+
+namespace pegas
+{
+	//	   ,    .  
+	//	insertObject, build                 :    ,
+	//	          . 
+	//	    , ,     nodeCapacity
+	//	,    .   ,   QuadTree
+	template<typename T>
+	class LinearQuadTree
+	{
+	public:
+		enum
+		{
+			k_defaultMaxDepth = 8,
+			k_defaultNodeCapacity = 8,
+			//     - 2 * maxDepth 
+			k_maxDepth = 15
+		};
+
+		LinearQuadTree();
+
+		void create(const Rect2D& worldArea, int32 maxDepth = k_defaultMaxDepth,
+				int32 nodeCapacity = k_defaultNodeCapacity);
+		void destroy();
+
+		//      build, false -    
+		bool insertObject(const T& object, const Rect2D& objectAABB);
+		void build();
+		bool removeAllObjects();
+		int32 getNumObjects() const { return (int32)m_items.size(); }
+		int32 getNumNodes() const { return (int32)m_nodes.size(); }
+
+		//     result
+		void query(const Rect2D& objectAABB, std::list<T>& result);
+		void query(const Point2D& queryPoint, std::list<T>& result);
+		void query(const Rect2D& objectAABB, std::vector<T>& result);
+		void query(const Point2D& queryPoint, std::vector<T>& result);
+
+		//   : visitor(object)     
+		template<typename Visitor>
+		void query(const Rect2D& objectAABB, Visitor& visitor);
+		template<typename Visitor>
+		void query(const Point2D& queryPoint, Visitor& visitor);
+
+		//,     
+		int32 getNumNodesVisited() const { return m_numNodesVisited; }
+		void resetNumNodesVisited() { m_numNodesVisited = 0; }
+
+		// :    build  removeAllObjects
+		uint32 getVersion() const { return m_version; }
+		//     
+		void appendToSnapshot(SpatialSnapshot<T>& snapshot) const;
+
+	private:
+		struct Item
+		{
+			T _object;
+			Rect2D _objectAABB;
+			//       
+			uint32 _code;
+			int32 _depth;
+		};
+
+		struct Node
+		{
+			//  
+			float _minX;
+			float _minY;
+			float _maxX;
+			float _maxY;
+			uint32 _code;
+			int32 _depth;
+			//  - [_firstItem, _firstItem + _numItems),
+			//  - [_firstItem, _endItem)
+			int32 _firstItem;
+			int32 _numItems;
+			int32 _endItem;
+			//   
+			int32 _next;
+		};
+
+		static bool isItemLess(const Item& a, const Item& b)
+		{
+			return (a._code != b._code) ? (a._code < b._code) : (a._depth < b._depth);
+		}
+
+		static uint32 interleave(uint32 x);
+		static void getBounds(const Rect2D& rect, float& minX, float& minY, float& maxX, float& maxY);
+
+		//     
+		bool isInNode(const Node& node, const Item& item) const
+		{
+			int32 shift = 2 * (m_maxDepth - node._depth);
+
+			return item._depth >= node._depth && (item._code >> shift) == (node._code >> shift);
+		}
+
+		void pushNode(uint32 code, int32 depth, int32 firstItem);
+		void popNode(int32 endItem);
+		//     index
+		int32 appendNode(int32 index, SpatialSnapshot<T>& snapshot) const;
+		bool isOutside(const Node& node, float minX, float minY, float maxX, float maxY) const
+		{
+			return node._maxX < minX || node._minX > maxX || node._maxY < minY || node._minY > maxY;
+		}
+
+		Rect2D m_worldArea;
+		float m_worldMinX;
+		float m_worldMinY;
+		//      
+		float m_cellsPerUnitX;
+		float m_cellsPerUnitY;
+		int32 m_maxDepth;
+		int32 m_nodeCapacity;
+		std::vector<Item> m_items;
+		std::vector<Node> m_nodes;
+		//       
+		std::vector<int32> m_path;
+		bool m_built;
+		int32 m_numNodesVisited;
+		uint32 m_version;
+
+	private:
+		LinearQuadTree(const LinearQuadTree& other);
+		LinearQuadTree& operator=(const LinearQuadTree& other);
+	};
+
+	//-----------------------------------------------------------------------------
+	//	LinearQuadTree class implementation
+	//-----------------------------------------------------------------------------
+	template<typename T>
+	inline LinearQuadTree<T>::LinearQuadTree()
+		:m_worldMinX(0.0f), m_worldMinY(0.0f), m_cellsPerUnitX(0.0f), m_cellsPerUnitY(0.0f),
+		 m_maxDepth(0), m_nodeCapacity(0), m_built(false), m_numNodesVisited(0),
+		 m_version(0)
+	{
+
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::create(const Rect2D& worldArea, int32 maxDepth, int32 nodeCapacity)
+	{
+		LOGD_LOOP("LinearQuadTree::create [worldArea: x1  = %.2f, y1  = %.2f, x2  = %.2f, y2  = %.2f]",
+				worldArea._topLeft._x, worldArea._topLeft._y,
+				worldArea._bottomRight._x, worldArea._bottomRight._y);
+
+		assert(maxDepth >= 0 && maxDepth <= k_maxDepth && "invalid linear quad tree depth");
+		assert(nodeCapacity >= 0);
+
+		destroy();
+
+		float maxX, maxY;
+		getBounds(worldArea, m_worldMinX, m_worldMinY, maxX, maxY);
+
+		m_worldArea = worldArea;
+		m_maxDepth = maxDepth;
+		m_nodeCapacity = nodeCapacity;
+		m_cellsPerUnitX = (1 << maxDepth) / (maxX - m_worldMinX);
+		m_cellsPerUnitY = (1 << maxDepth) / (maxY - m_worldMinY);
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::destroy()
+	{
+		removeAllObjects();
+	}
+
+	template<typename T>
+	inline bool LinearQuadTree<T>::insertObject(const T& object, const Rect2D& objectAABB)
+	{
+		if(objectAABB.width() == 0.0f || objectAABB.height() == 0.0f)
+		{
+			LOGE("could not insert null sized object");
+			return false;
+		}
+
+		if(!m_worldArea.contains(objectAABB))
+		{
+			LOGW("object is out of the linear quad tree area");
+			return false;
+		}
+
+		float minX, minY, maxX, maxY;
+		getBounds(objectAABB, minX, minY, maxX, maxY);
+
+		//       ,     :   
+		//   ,     ,    .
+		//   -     
+		int32 lastCell = (1 << m_maxDepth) - 1;
+		float size = std::max((maxX - minX) * m_cellsPerUnitX, (maxY - minY) * m_cellsPerUnitY);
+		uint32 x = (uint32)std::min(std::max((int32)(((minX + maxX) / 2 - m_worldMinX) * m_cellsPerUnitX), 0), lastCell);
+		uint32 y = (uint32)std::min(std::max((int32)(((minY + maxY) / 2 - m_worldMinY) * m_cellsPerUnitY), 0), lastCell);
+
+		int32 shift = 0;
+		while(shift < m_maxDepth && (float)(1 << shift) < size)
+		{
+			shift++;
+		}
+
+		Item item;
+		item._object = object;
+		item._objectAABB = objectAABB;
+		item._code = interleave((x >> shift) << shift) | (interleave((y >> shift) << shift) << 1);
+		item._depth = m_maxDepth - shift;
+
+		m_items.push_back(item);
+		m_built = false;
+
+		return true;
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::build()
+	{
+		LOGD_LOOP("LinearQuadTree::build [objects: %d]", m_items.size());
+
+		m_nodes.clear();
+		m_path.clear();
+		m_built = true;
+		m_version++;
+
+		std::sort(m_items.begin(), m_items.end(), isItemLess);
+
+		for(int32 i = 0; i < (int32)m_items.size(); i++)
+		{
+			const Item& item = m_items[i];
+
+			while(!m_path.empty() && !isInNode(m_nodes[m_path.back()], item))
+			{
+				popNode(i);
+			}
+
+			if(m_path.empty())
+			{
+				pushNode(0, 0, i);
+			}
+
+			//      
+			while(m_nodes[m_path.back()]._depth < item._depth)
+			{
+				int32 depth = m_nodes[m_path.back()]._depth + 1;
+				int32 shift = 2 * (m_maxDepth - depth);
+				pushNode((item._code >> shift) << shift, depth, i);
+			}
+
+			Node& node = m_nodes[m_path.back()];
+			node._numItems++;
+
+			float minX, minY, maxX, maxY;
+			getBounds(item._objectAABB, minX, minY, maxX, maxY);
+			node._minX = std::min(node._minX, minX);
+			node._minY = std::min(node._minY, minY);
+			node._maxX = std::max(node._maxX, maxX);
+			node._maxY = std::max(node._maxY, maxY);
+		}
+
+		while(!m_path.empty())
+		{
+			popNode((int32)m_items.size());
+		}
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::pushNode(uint32 code, int32 depth, int32 firstItem)
+	{
+		Node node;
+		node._minX = std::numeric_limits<float>::max();
+		node._minY = std::numeric_limits<float>::max();
+		node._maxX = -std::numeric_limits<float>::max();
+		node._maxY = -std::numeric_limits<float>::max();
+		node._code = code;
+		node._depth = depth;
+		node._firstItem = firstItem;
+		node._numItems = 0;
+		node._endItem = firstItem;
+		node._next = -1;
+
+		m_path.push_back((int32)m_nodes.size());
+		m_nodes.push_back(node);
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::popNode(int32 endItem)
+	{
+		int32 index = m_path.back();
+		m_path.pop_back();
+
+		Node& node = m_nodes[index];
+		node._endItem = endItem;
+		if(endItem - node._firstItem <= m_nodeCapacity)
+		{
+			//  -   ,       
+			node._numItems = endItem - node._firstItem;
+			m_nodes.resize(index + 1);
+		}
+		node._next = (int32)m_nodes.size();
+
+		if(!m_path.empty())
+		{
+			Node& parent = m_nodes[m_path.back()];
+			parent._minX = std::min(parent._minX, node._minX);
+			parent._minY = std::min(parent._minY, node._minY);
+			parent._maxX = std::max(parent._maxX, node._maxX);
+			parent._maxY = std::max(parent._maxY, node._maxY);
+		}
+	}
+
+	template<typename T>
+	inline bool LinearQuadTree<T>::removeAllObjects()
+	{
+		m_items.clear();
+		m_nodes.clear();
+		m_built = false;
+		m_version++;
+
+		return true;
+	}
+
+	template<typename T>
+	inline uint32 LinearQuadTree<T>::interleave(uint32 x)
+	{
+		// x  : ...b2 0 b1 0 b0
+		x &= 0x0000ffff;
+		x = (x | (x << 8)) & 0x00ff00ff;
+		x = (x | (x << 4)) & 0x0f0f0f0f;
+		x = (x | (x << 2)) & 0x33333333;
+		x = (x | (x << 1)) & 0x55555555;
+
+		return x;
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::getBounds(const Rect2D& rect, float& minX, float& minY, float& maxX, float& maxY)
+	{
+		minX = std::min(rect._topLeft._x, rect._bottomRight._x);
+		minY = std::min(rect._topLeft._y, rect._bottomRight._y);
+		maxX = std::max(rect._topLeft._x, rect._bottomRight._x);
+		maxY = std::max(rect._topLeft._y, rect._bottomRight._y);
+	}
+
+	template<typename T>
+	template<typename Visitor>
+	inline void LinearQuadTree<T>::query(const Rect2D& queryAABB, Visitor& visitor)
+	{
+		assert((m_built || m_items.empty()) && "querying a linear quad tree that is not built");
+
+		float minX, minY, maxX, maxY;
+		getBounds(queryAABB, minX, minY, maxX, maxY);
+
+		int32 numNodes = (int32)m_nodes.size();
+		int32 index = 0;
+		while(index < numNodes)
+		{
+			const Node& node = m_nodes[index];
+			m_numNodesVisited++;
+
+			if(isOutside(node, minX, minY, maxX, maxY))
+			{
+				index = node._next;
+				continue;
+			}
+
+			if(node._minX >= minX && node._maxX <= maxX && node._minY >= minY && node._maxY <= maxY)
+			{
+				//     
+				for(int32 i = node._firstItem; i < node._endItem; i++)
+				{
+					visitor(m_items[i]._object);
+				}
+
+				index = node._next;
+				continue;
+			}
+
+			for(int32 i = node._firstItem; i < node._firstItem + node._numItems; i++)
+			{
+				const Item& item = m_items[i];
+				const Rect2D& rect = item._objectAABB;
+				if(queryAABB.contains(rect) || rect.contains(queryAABB) || queryAABB.intersectsWith(rect))
+				{
+					visitor(item._object);
+				}
+			}
+
+			index++;
+		}
+	}
+
+	template<typename T>
+	template<typename Visitor>
+	inline void LinearQuadTree<T>::query(const Point2D& queryPoint, Visitor& visitor)
+	{
+		assert((m_built || m_items.empty()) && "querying a linear quad tree that is not built");
+
+		int32 numNodes = (int32)m_nodes.size();
+		int32 index = 0;
+		while(index < numNodes)
+		{
+			const Node& node = m_nodes[index];
+			m_numNodesVisited++;
+
+			if(isOutside(node, queryPoint._x, queryPoint._y, queryPoint._x, queryPoint._y))
+			{
+				index = node._next;
+				continue;
+			}
+
+			for(int32 i = node._firstItem; i < node._firstItem + node._numItems; i++)
+			{
+				const Item& item = m_items[i];
+				if(item._objectAABB.contains(queryPoint))
+				{
+					visitor(item._object);
+				}
+			}
+
+			index++;
+		}
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::appendToSnapshot(SpatialSnapshot<T>& snapshot) const
+	{
+		assert((m_built || m_items.empty()) && "taking a snapshot of a linear quad tree that is not built");
+
+		int32 index = 0;
+		while(index < (int32)m_nodes.size())
+		{
+			index = appendNode(index, snapshot);
+		}
+	}
+
+	template<typename T>
+	inline int32 LinearQuadTree<T>::appendNode(int32 index, SpatialSnapshot<T>& snapshot) const
+	{
+		const Node& node = m_nodes[index];
+		int32 snapshotNode = snapshot.beginNode();
+		for(int32 i = node._firstItem; i < node._firstItem + node._numItems; i++)
+		{
+			snapshot.addObject(m_items[i]._object, m_items[i]._objectAABB);
+		}
+
+		int32 child = index + 1;
+		while(child < node._next)
+		{
+			child = appendNode(child, snapshot);
+		}
+
+		snapshot.endNode(snapshotNode);
+
+		return node._next;
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::query(const Rect2D& objectAABB, std::list<T>& result)
+	{
+		SpatialCollector<T, std::list<T> > collector(result);
+		query(objectAABB, collector);
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::query(const Point2D& queryPoint, std::list<T>& result)
+	{
+		SpatialCollector<T, std::list<T> > collector(result);
+		query(queryPoint, collector);
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::query(const Rect2D& objectAABB, std::vector<T>& result)
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		query(objectAABB, collector);
+	}
+
+	template<typename T>
+	inline void LinearQuadTree<T>::query(const Point2D& queryPoint, std::vector<T>& result)
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		query(queryPoint, collector);
+	}
+}
+
+#endif /* CORE_LINEAR_QUAD_TREE_H_ */
@@ -2,23 +2,126 @@
 #define CORE_QUAD_TREE_H_
 
 #include "../core/geometry.h"
-#include "../system./log.h"
+#include "../core/spatial_index.h"
+#include "../core/spatial_snapshot.h"
+#include "../system/log.h"
 
 namespace pegas
 {
-	template<typename T, typename K>
-	class QTKeyGenPolicy
+	template<typename T>
+	struct QuadTreeItem
+	{
+		QuadTreeItem()
+			:_object(), _objectAABB(), _handle(k_invalidSpatialHandle)
+		{
+
+		}
+
+		QuadTreeItem(const T& object, const Rect2D& objectAABB, SpatialHandle handle)
+			:_object(object), _objectAABB(objectAABB), _handle(handle)
+		{
+
+		}
+
+		T _object;
+		Rect2D _objectAABB;
+		SpatialHandle _handle;
+	};
+
+	//	   :      ,
+	//	  .       ,
+	//	     
+	class QTTightBoundsPolicy
 	{
 	public:
-		K getKeyFromObject(const T& object)
+		static Rect2D getLooseAABB(const Rect2D& AABB)
 		{
-			return const_cast<K>(object);
+			return AABB;
+		}
+
+		static bool fits(const Rect2D& AABB, const Rect2D&, const Rect2D& objectAABB)
+		{
+			return AABB.contains(objectAABB);
 		}
 	};
 
-	template<typename T>
+	//	"" :     LoosenessPercent / 100  
+	//	 ,    ,   ,  
+	//	    .      
+	//	   ,    ,  ,   
+	//	   ,    (. QuadTree::updateObject)
+	template<int32 LoosenessPercent = 200>
+	class QTLooseBoundsPolicy
+	{
+	public:
+		static Rect2D getLooseAABB(const Rect2D& AABB)
+		{
+			Point2D margin = (AABB._bottomRight - AABB._topLeft) * ((LoosenessPercent - 100) / 200.0f);
+
+			return Rect2D(AABB._topLeft - margin, AABB._bottomRight + margin);
+		}
+
+		static bool fits(const Rect2D& AABB, const Rect2D& looseAABB, const Rect2D& objectAABB)
+		{
+			Point2D center = objectAABB._topLeft + (objectAABB._bottomRight - objectAABB._topLeft) / 2;
+
+			return AABB.contains(center) && looseAABB.contains(objectAABB);
+		}
+	};
+
+	template<typename T, typename BoundsPolicy = QTTightBoundsPolicy>
+	class QuadTreeNode;
+
+	//	      .   
+	//	   ,      .
+	//	,    ,     8, 16, 32... ,
+	//	      .    
+	//	    ,     , 
+	//	     
+	template<typename Node>
+	class QuadTreeNodePool
+	{
+	public:
+		typedef typename Node::Item Item;
+
+		enum
+		{
+			k_quadsPerBlock = 64,
+			k_minItemArraySize = 8,
+			k_numItemArraySizes = 24
+		};
+
+		QuadTreeNodePool();
+		~QuadTreeNodePool();
+
+		//   parent,   
+		Node* allocateQuad(Node* parent);
+		void freeQuad(Node* quad);
+
+		//     size ,  sizeClass -    freeItems
+		Item* allocateItems(int32 size, int32& sizeClass);
+		void freeItems(Item* items, int32 sizeClass);
+
+		static int32 getItemArraySize(int32 sizeClass) { return k_minItemArraySize << sizeClass; }
+
+	private:
+		std::vector<Node*> m_nodeBlocks;
+		Node* m_freeQuads;
+		std::vector<Item*> m_itemArrays;
+		std::vector<Item*> m_freeItems[k_numItemArraySizes];
+		int32 m_numItemArrays[k_numItemArraySizes];
+
+	private:
+		QuadTreeNodePool(const QuadTreeNodePool& other);
+		QuadTreeNodePool& operator=(const QuadTreeNodePool& other);
+	};
+
+	template<typename T, typename BoundsPolicy>
 	class QuadTreeNode
 	{
+		friend class QuadTreeNodePool<QuadTreeNode>;
+		template<typename, typename> friend class QuadTree;
+
 	public:
 		class IIterator
 		{
@@ -32,56 +135,50 @@ namespace pegas
 		QuadTreeNode(QuadTreeNode* parentNode = NULL);
 		virtual ~QuadTreeNode();
 
-		QuadTreeNode<T>* insertObject(const T& object, const Rect2D& objectAABB);
-		bool removeObject(const T& object);
 		bool removeAllObjects();
-		void query(const Rect2D& objectAABB, std::list<T>& result);
-		void query(const Point2D& queryPoint, std::list<T>& result);
-		void query(std::list<T>& result);
+		//visitor(object)     ,
+		//    
+		template<typename Visitor>
+		int32 query(const Rect2D& objectAABB, Visitor& visitor);
+		template<typename Visitor>
+		int32 query(const Point2D& queryPoint, Visitor& visitor);
+		//     
+		template<typename Visitor>
+		int32 query(Visitor& visitor);
 		void setAABB(const Rect2D& AABB);
 
-		QuadTreeNode<T>* getParentNode();
+		// ,  AABB,   radius,  origin + direction * t 
+		//  maxDistance.       , visitor(object, maxDistance)
+		//  maxDistance - ,   , 
+		template<typename Visitor>
+		int32 castRay(const Point2D& origin, const Point2D& direction, float radius,
+				float& maxDistance, Visitor& visitor);
+
+		QuadTreeNode<T, BoundsPolicy>* getParentNode();
 		IIterator* getIterator();
 	private:
-		template <typename E>
-		struct TQuadTreeItem
-		{
-			TQuadTreeItem(const E& object, const Rect2D& objectAABB)
-				:_object(object), _objectAABB(objectAABB)
-			{
-
-			}
-
-			bool operator==(const TQuadTreeItem<E>& other) const
-			{
-				return _object == other._object;
-			}
-
-			E _object;
-			Rect2D _objectAABB;
-		};
-
-		typedef TQuadTreeItem<T> QuadTreeItem;
-		typedef std::list<QuadTreeItem> ObjectList;
-		typedef typename ObjectList::iterator ObjectListIt;
+		typedef QuadTreeItem<T> Item;
+		typedef QuadTreeNodePool<QuadTreeNode> Pool;
 
 		class Iterator: public IIterator
 		{
 		public:
-			Iterator(): m_objects(NULL) {}
+			Iterator(): m_node(NULL), m_index(0) {}
 
-			void create(ObjectList* objects) { m_objects = objects; }
-			void rewind() { m_currentIterator = m_objects->begin(); }
+			void create(QuadTreeNode* node) { m_node = node; }
+			void rewind() { m_index = 0; }
 
-			virtual T current() { return (*m_currentIterator)._object; }
-			virtual void next() { m_currentIterator++; }
-			virtual bool end() { return m_currentIterator == m_objects->end(); }
+			virtual T current() { return m_node->getItem(m_index)._object; }
+			virtual void next() { m_index++; }
+			virtual bool end() { return m_index >= m_node->m_numItems; }
 
 		private:
-			ObjectList* m_objects;
-			ObjectListIt m_currentIterator;
+			QuadTreeNode* m_node;
+			int32 m_index;
 		};
 
+		friend class Iterator;
+
 		enum
 		{
 			k_childNorthWest,
@@ -91,10 +188,52 @@ namespace pegas
 			k_childTotal
 		};
 
+		enum
+		{
+			//        
+			k_inlineItems = 4
+		};
+
+		Item& getItem(int32 index)
+		{
+			return (index < k_inlineItems) ? m_items[index] : m_overflow[index - k_inlineItems];
+		}
+
+		const Item& getItem(int32 index) const
+		{
+			return (index < k_inlineItems) ? m_items[index] : m_overflow[index - k_inlineItems];
+		}
+
+		Rect2D getChildAABB(int32 child) const;
+		//          (. BoundsPolicy::fits)
+		bool fits(const Rect2D& objectAABB) const { return BoundsPolicy::fits(m_AABB, m_looseAABB, objectAABB); }
+		//  ,    objectAABB,  -1
+		int32 getChildIndex(const Rect2D& objectAABB) const;
+		void createChilds();
+		void freeChilds();
+		void addItem(const Item& item);
+		//      ,   handle
+		//(k_invalidSpatialHandle,   )
+		SpatialHandle removeItem(int32 index);
+		void clearItems();
+		//     ,     nodeCapacity
+		// (     ), true -     
+		bool collapse(int32 nodeCapacity);
+
 		QuadTreeNode* m_childs[k_childTotal];
 		QuadTreeNode* m_parentNode;
+		Pool* m_pool;
+		//  ,    
+		QuadTreeNode* m_nextFree;
 		Rect2D m_AABB;
-		ObjectList m_objects;
+		//,        
+		Rect2D m_looseAABB;
+		Item m_items[k_inlineItems];
+		Item* m_overflow;
+		int32 m_overflowSizeClass;
+		int32 m_numItems;
+		//  0
+		int32 m_depth;
 		Iterator   m_objectIterator;
 
 	private:
@@ -102,81 +241,190 @@ namespace pegas
 		QuadTreeNode& operator=(const QuadTreeNode& other);
 	};
 
-	template<typename T, typename  K, typename KeyGenPolicy = QTKeyGenPolicy<T, K> >
-	class QuadTree: public KeyGenPolicy
+	template<typename T, typename BoundsPolicy = QTTightBoundsPolicy>
+	class QuadTree
 	{
-		using KeyGenPolicy::getKeyFromObject;
-
 	public:
+		typedef QuadTreeNode<T, BoundsPolicy> Node;
+
 		QuadTree();
 		virtual ~QuadTree();
 
-		void create(const Rect2D& worldArea);
+		enum
+		{
+			k_defaultMaxDepth = 8,
+			k_defaultNodeCapacity = 8
+		};
+
+		// ,     nodeCapacity ,    maxDepth
+		void create(const Rect2D& worldArea, int32 maxDepth = k_defaultMaxDepth,
+				int32 nodeCapacity = k_defaultNodeCapacity);
+		//          create
 		void destroy();
 
-		bool insertObject(const T& object, const Rect2D& objectAABB);
-		bool removeObject(const T& object);
+		//handle   k_invalidSpatialHandle,      .
+		//      ,     handle
+		SpatialHandle insertObject(const T& object, const Rect2D& objectAABB);
+		//handle  k_invalidSpatialHandle
+		bool removeObject(SpatialHandle& handle);
+		// AABB :     ,     () 
+		//             ,  
+		//   ,   .       ,
+		//handle  k_invalidSpatialHandle   false
+		bool updateObject(SpatialHandle& handle, const Rect2D& objectAABB);
+		//handle    
 		bool removeAllObjects();
+		//     result
 		void query(const Rect2D& objectAABB, std::list<T>& result);
 		void query(const Point2D& queryPoint, std::list<T>& result);
+		void query(const Rect2D& objectAABB, std::vector<T>& result);
+		void query(const Point2D& queryPoint, std::vector<T>& result);
+
+		//   : visitor(object)     
+		template<typename Visitor>
+		void query(const Rect2D& objectAABB, Visitor& visitor)
+		{
+			if(m_rootNode)
+			{
+				m_numNodesVisited += m_rootNode->query(objectAABB, visitor);
+			}
+		}
+
+		template<typename Visitor>
+		void query(const Point2D& queryPoint, Visitor& visitor)
+		{
+			if(m_rootNode)
+			{
+				m_numNodesVisited += m_rootNode->query(queryPoint, visitor);
+			}
+		}
+
+		template<typename Visitor>
+		void castRay(const Point2D& origin, const Point2D& direction, float radius,
+				float maxDistance, Visitor& visitor)
+		{
+			if(m_rootNode)
+			{
+				m_numNodesVisited += m_rootNode->castRay(origin, direction, radius, maxDistance, visitor);
+			}
+		}
+
+		bool isValidHandle(SpatialHandle handle) const
+		{
+			return handle >= 0 && handle < (int32)m_handles.size() && m_handles[handle]._node != NULL;
+		}
 
-		QuadTreeNode<T>* getNodeByObject(const T& object);
+		//,    castRay   
+		int32 getNumNodesVisited() const { return m_numNodesVisited; }
+		void resetNumNodesVisited() { m_numNodesVisited = 0; }
+		//,  updateObject   ,   
+		int32 getNumReinsertions() const { return m_numReinsertions; }
+		void resetNumReinsertions() { m_numReinsertions = 0; }
+
+		// :    ,    
+		uint32 getVersion() const { return m_version; }
+		//     ,    -  
+		void appendToSnapshot(SpatialSnapshot<T>& snapshot) const;
 	private:
-		typedef std::map<K, QuadTreeNode<T>*> ObjectNodeLookupTable;
-		typedef typename ObjectNodeLookupTable::iterator ObjectNodeLookupTableIt;
+		typedef typename Node::Item Item;
 
-		QuadTreeNode<T>* 		m_rootNode;
-		ObjectNodeLookupTable   m_lookupTable;
+		//     ;    _node == NULL,
+		//  _index -   
+		struct HandleEntry
+		{
+			Node* _node;
+			int32 _index;
+		};
+		typedef std::vector<HandleEntry> HandleTable;
+
+		SpatialHandle allocateHandle();
+		void freeHandle(SpatialHandle handle);
+		//   node,    ,  ,   
+		void insertItem(Node* node, const Item& item);
+		//        ,    
+		void splitNode(Node* node);
+		//       node
+		void setItemPlace(SpatialHandle handle, Node* node);
+		//   , handle  
+		void removeItem(const HandleEntry& entry);
+		//   node    
+		void collapseBranch(QuadTreeNode<T, BoundsPolicy>* node);
+		void appendNode(const Node* node, SpatialSnapshot<T>& snapshot) const;
+
+		QuadTreeNodePool<Node>	m_pool;
+		Node					m_root;
+		Node* 					m_rootNode;
+		HandleTable				m_handles;
+		SpatialHandle			m_firstFreeHandle;
+		int32					m_maxDepth;
+		int32					m_nodeCapacity;
+		int32					m_numNodesVisited;
+		int32					m_numReinsertions;
+		uint32					m_version;
 	private:
-		QuadTree(const QuadTree<T, K, KeyGenPolicy>& other);
-		QuadTree& operator=(const QuadTree<T, K, KeyGenPolicy>& other);
+		QuadTree(const QuadTree& other);
+		QuadTree& operator=(const QuadTree& other);
 	};
 
 	//-----------------------------------------------------------------------------
 	//	QuadTree class implementation
 	//-----------------------------------------------------------------------------
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline QuadTree<T, K, KeyGenPolicy>::QuadTree()
-		:m_rootNode(NULL)
+	template<typename T, typename BoundsPolicy>
+	inline QuadTree<T, BoundsPolicy>::QuadTree()
+		:m_rootNode(NULL), m_firstFreeHandle(k_invalidSpatialHandle),
+		 m_maxDepth(k_defaultMaxDepth), m_nodeCapacity(k_defaultNodeCapacity),
+		 m_numNodesVisited(0), m_numReinsertions(0), m_version(0)
 	{
 		LOGD_LOOP("QuadTree constructor");
+
+		m_root.m_pool = &m_pool;
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline QuadTree<T, K, KeyGenPolicy>::~QuadTree()
+	template<typename T, typename BoundsPolicy>
+	inline QuadTree<T, BoundsPolicy>::~QuadTree()
 	{
 		LOGD_LOOP("QuadTree destructor");
 
 		destroy();
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline void QuadTree<T, K, KeyGenPolicy>::create(const Rect2D& worldArea)
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::create(const Rect2D& worldArea, int32 maxDepth, int32 nodeCapacity)
 	{
 		LOGD_LOOP("QuadTree::create [worldArea: x1  = %.2f, y1  = %.2f, x2  = %.2f, y2  = %.2f]",
 				worldArea._topLeft._x, worldArea._topLeft._y,
 				worldArea._bottomRight._x, worldArea._bottomRight._y);
 
+		assert(maxDepth >= 0 && nodeCapacity >= 0);
+
 		destroy();
 
-		m_rootNode = new QuadTreeNode<T>();
+		m_maxDepth = maxDepth;
+		m_nodeCapacity = nodeCapacity;
+		m_version++;
+
+		m_rootNode = &m_root;
 		m_rootNode->setAABB(worldArea);
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline void QuadTree<T, K, KeyGenPolicy>::destroy()
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::destroy()
 	{
 		LOGD_LOOP("QuadTree::destroy");
 
 		if(m_rootNode)
 		{
-			delete m_rootNode;
+			m_rootNode->removeAllObjects();
 			m_rootNode = NULL;
 		}
+
+		m_handles.clear();
+		m_firstFreeHandle = k_invalidSpatialHandle;
+		m_version++;
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline bool QuadTree<T, K, KeyGenPolicy>::insertObject(const T& object, const Rect2D& objectAABB)
+	template<typename T, typename BoundsPolicy>
+	inline SpatialHandle QuadTree<T, BoundsPolicy>::insertObject(const T& object, const Rect2D& objectAABB)
 	{
 		LOGD_LOOP("QuadTree::insertObject");
 		LOGD_LOOP("[objectAABB: x1 = %0.2f, y1 = %0.2f, x2 = %0.2f, y2 = %0.2f]",
@@ -186,91 +434,377 @@ namespace pegas
 		if(objectAABB.width() == 0.0f || objectAABB.height() == 0.0f)
 		{
 			LOGE("could not insert null sized object");
+			return k_invalidSpatialHandle;
+		}
+
+		if(m_rootNode && m_rootNode->fits(objectAABB))
+		{
+			SpatialHandle handle = allocateHandle();
+			insertItem(m_rootNode, Item(object, objectAABB, handle));
+			m_version++;
+
+			return handle;
+		}
+
+		return k_invalidSpatialHandle;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline bool QuadTree<T, BoundsPolicy>::removeObject(SpatialHandle& handle)
+	{
+		if(!isValidHandle(handle))
+		{
 			return false;
 		}
 
-		if(m_rootNode)
+		HandleEntry entry = m_handles[handle];
+		removeItem(entry);
+		freeHandle(handle);
+		handle = k_invalidSpatialHandle;
+		m_version++;
+
+		collapseBranch(entry._node);
+
+		return true;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline bool QuadTree<T, BoundsPolicy>::updateObject(SpatialHandle& handle, const Rect2D& objectAABB)
+	{
+		assert(isValidHandle(handle) && "updating an object that is not in the quad tree");
+
+		if(objectAABB.width() == 0.0f || objectAABB.height() == 0.0f)
+		{
+			LOGE("could not insert null sized object");
+
+			removeObject(handle);
+			return false;
+		}
+
+		HandleEntry entry = m_handles[handle];
+		Node* node = entry._node;
+		Item& item = node->getItem(entry._index);
+		m_version++;
+
+		if(node->m_looseAABB.contains(objectAABB)
+			&& (node->m_childs[0] == NULL || node->getChildIndex(objectAABB) < 0))
+		{
+			item._objectAABB = objectAABB;
+			return true;
+		}
+
+		Item moved(item._object, objectAABB, handle);
+		removeItem(entry);
+		m_numReinsertions++;
+
+		//         ,    
+		//   ,     
+		Node* ancestor = node;
+		while(ancestor != NULL && !ancestor->fits(objectAABB))
 		{
-			QuadTreeNode<T>* node = m_rootNode->insertObject(object, objectAABB);
-			if(node)
+			ancestor = ancestor->getParentNode();
+		}
+
+		bool inserted = (ancestor != NULL);
+		if(inserted)
+		{
+			insertItem(ancestor, moved);
+		}else
+		{
+			LOGW("object left the quad tree area");
+
+			freeHandle(handle);
+			handle = k_invalidSpatialHandle;
+		}
+
+		collapseBranch(node);
+
+		return inserted;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline SpatialHandle QuadTree<T, BoundsPolicy>::allocateHandle()
+	{
+		if(m_firstFreeHandle == k_invalidSpatialHandle)
+		{
+			m_handles.push_back(HandleEntry());
+			m_handles.back()._index = k_invalidSpatialHandle;
+			m_firstFreeHandle = (SpatialHandle)m_handles.size() - 1;
+		}
+
+		SpatialHandle handle = m_firstFreeHandle;
+		m_firstFreeHandle = m_handles[handle]._index;
+
+		return handle;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::freeHandle(SpatialHandle handle)
+	{
+		m_handles[handle]._node = NULL;
+		m_handles[handle]._index = m_firstFreeHandle;
+		m_firstFreeHandle = handle;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::insertItem(Node* node, const Item& item)
+	{
+		LOGD_LOOP("QuadTree::insertItem [node: 0x%X]", node);
+
+		while(true)
+		{
+			if(node->m_childs[0] != NULL)
 			{
-				K key = getKeyFromObject(object);
-				if(m_lookupTable.count(key) == 0)
+				int32 child = node->getChildIndex(item._objectAABB);
+				if(child < 0)
 				{
-					m_lookupTable[key] = node;
-					return true;
+					break;
 				}
+
+				node = node->m_childs[child];
+			}else if(node->m_numItems >= m_nodeCapacity && node->m_depth < m_maxDepth)
+			{
+				splitNode(node);
+			}else
+			{
+				break;
 			}
 		}
 
-		return false;
+		LOGD_LOOP("inserting object to node 0x%X", node);
+
+		node->addItem(item);
+		setItemPlace(item._handle, node);
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline bool QuadTree<T, K, KeyGenPolicy>::removeObject(const T& object)
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::splitNode(Node* node)
 	{
-		K key = getKeyFromObject(object);
-		if(m_lookupTable.count(key) > 0)
+		node->createChilds();
+
+		//     ,  
+		for(int32 i = node->m_numItems - 1; i >= 0; i--)
 		{
-			QuadTreeNode<T>* node = m_lookupTable[key];
-			bool result = node->removeObject(object);
-			m_lookupTable.erase(key);
+			Item item = node->getItem(i);
+			int32 child = node->getChildIndex(item._objectAABB);
+			if(child >= 0)
+			{
+				removeItem(m_handles[item._handle]);
+				node->m_childs[child]->addItem(item);
+				setItemPlace(item._handle, node->m_childs[child]);
+			}
+		}
+	}
 
-			return result;
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::setItemPlace(SpatialHandle handle, Node* node)
+	{
+		m_handles[handle]._node = node;
+		m_handles[handle]._index = node->m_numItems - 1;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::removeItem(const HandleEntry& entry)
+	{
+		SpatialHandle moved = entry._node->removeItem(entry._index);
+		if(moved != k_invalidSpatialHandle)
+		{
+			m_handles[moved]._index = entry._index;
 		}
+	}
 
-		return false;
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::collapseBranch(QuadTreeNode<T, BoundsPolicy>* node)
+	{
+		while(node != NULL && node->collapse(m_nodeCapacity))
+		{
+			node = node->getParentNode();
+		}
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline bool QuadTree<T, K, KeyGenPolicy>::removeAllObjects()
+	template<typename T, typename BoundsPolicy>
+	inline bool QuadTree<T, BoundsPolicy>::removeAllObjects()
 	{
 		if(m_rootNode)
 		{
+			m_handles.clear();
+			m_firstFreeHandle = k_invalidSpatialHandle;
+			m_version++;
+
 			return m_rootNode->removeAllObjects();
 		}
 
 		return false;
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline void QuadTree<T, K, KeyGenPolicy>::query(const Rect2D& objectAABB, std::list<T>& result)
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::appendToSnapshot(SpatialSnapshot<T>& snapshot) const
 	{
 		if(m_rootNode)
 		{
-			m_rootNode->query(objectAABB, result);
+			appendNode(m_rootNode, snapshot);
 		}
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline void QuadTree<T, K, KeyGenPolicy>::query(const Point2D& queryPoint, std::list<T>& result)
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::appendNode(const Node* node, SpatialSnapshot<T>& snapshot) const
 	{
-		if(m_rootNode)
+		int32 index = snapshot.beginNode();
+		for(int32 i = 0; i < node->m_numItems; i++)
 		{
-			m_rootNode->query(queryPoint, result);
+			const Item& item = node->getItem(i);
+			snapshot.addObject(item._object, item._objectAABB);
 		}
+
+		for(int32 i = 0; i < Node::k_childTotal; i++)
+		{
+			if(node->m_childs[i])
+			{
+				appendNode(node->m_childs[i], snapshot);
+			}
+		}
+
+		snapshot.endNode(index);
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::query(const Rect2D& objectAABB, std::list<T>& result)
+	{
+		SpatialCollector<T, std::list<T> > collector(result);
+		query(objectAABB, collector);
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::query(const Point2D& queryPoint, std::list<T>& result)
+	{
+		SpatialCollector<T, std::list<T> > collector(result);
+		query(queryPoint, collector);
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::query(const Rect2D& objectAABB, std::vector<T>& result)
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		query(objectAABB, collector);
 	}
 
-	template<typename T, typename  K, typename KeyGenPolicy>
-	inline QuadTreeNode<T>* QuadTree<T, K, KeyGenPolicy>::getNodeByObject(const T& object)
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTree<T, BoundsPolicy>::query(const Point2D& queryPoint, std::vector<T>& result)
 	{
-		K key = getKeyFromObject(object);
-		if(m_lookupTable.count(key) > 0)
+		SpatialCollector<T, std::vector<T> > collector(result);
+		query(queryPoint, collector);
+	}
+
+	//----------------------------------------------------------------------------
+	//  QuadTreeNodePool class implementation
+	//----------------------------------------------------------------------------
+	template<typename Node>
+	inline QuadTreeNodePool<Node>::QuadTreeNodePool()
+		:m_freeQuads(NULL)
+	{
+		for(int32 i = 0; i < k_numItemArraySizes; i++)
 		{
-			return m_lookupTable[key];
+			m_numItemArrays[i] = 0;
 		}
+	}
 
-		return NULL;
+	template<typename Node>
+	inline QuadTreeNodePool<Node>::~QuadTreeNodePool()
+	{
+		for(size_t i = 0; i < m_nodeBlocks.size(); i++)
+		{
+			delete[] m_nodeBlocks[i];
+		}
+
+		for(size_t i = 0; i < m_itemArrays.size(); i++)
+		{
+			delete[] m_itemArrays[i];
+		}
 	}
 
+	template<typename Node>
+	inline Node* QuadTreeNodePool<Node>::allocateQuad(Node* parent)
+	{
+		if(m_freeQuads == NULL)
+		{
+			LOGD_LOOP("QuadTreeNodePool: new block of %d nodes", k_quadsPerBlock * Node::k_childTotal);
+
+			Node* block = new Node[k_quadsPerBlock * Node::k_childTotal];
+			m_nodeBlocks.push_back(block);
+
+			for(int32 i = k_quadsPerBlock - 1; i >= 0; i--)
+			{
+				block[i * Node::k_childTotal].m_nextFree = m_freeQuads;
+				m_freeQuads = &block[i * Node::k_childTotal];
+			}
+		}
+
+		Node* quad = m_freeQuads;
+		m_freeQuads = quad->m_nextFree;
+
+		for(int32 i = 0; i < Node::k_childTotal; i++)
+		{
+			quad[i].m_parentNode = parent;
+			quad[i].m_pool = this;
+			quad[i].m_nextFree = NULL;
+		}
+
+		return quad;
+	}
+
+	template<typename Node>
+	inline void QuadTreeNodePool<Node>::freeQuad(Node* quad)
+	{
+		for(int32 i = 0; i < Node::k_childTotal; i++)
+		{
+			assert(quad[i].m_numItems == 0 && quad[i].m_childs[0] == NULL && "freeing a non empty quad tree node");
+		}
+
+		quad->m_nextFree = m_freeQuads;
+		m_freeQuads = quad;
+	}
+
+	template<typename Node>
+	inline typename QuadTreeNodePool<Node>::Item* QuadTreeNodePool<Node>::allocateItems(int32 size, int32& sizeClass)
+	{
+		sizeClass = 0;
+		while(getItemArraySize(sizeClass) < size)
+		{
+			sizeClass++;
+		}
+		assert(sizeClass < k_numItemArraySizes && "too many objects in a quad tree node");
+
+		std::vector<Item*>& freeItems = m_freeItems[sizeClass];
+		if(!freeItems.empty())
+		{
+			Item* items = freeItems.back();
+			freeItems.pop_back();
+
+			return items;
+		}
+
+		Item* items = new Item[getItemArraySize(sizeClass)];
+		m_itemArrays.push_back(items);
+		//     ,  freeItems   
+		freeItems.reserve(++m_numItemArrays[sizeClass]);
+
+		return items;
+	}
+
+	template<typename Node>
+	inline void QuadTreeNodePool<Node>::freeItems(Item* items, int32 sizeClass)
+	{
+		m_freeItems[sizeClass].push_back(items);
+	}
 
 	//----------------------------------------------------------------------------
 	//  QuadTreeNode class implementation
 	//----------------------------------------------------------------------------
 
-	template<typename T>
-	inline QuadTreeNode<T>::QuadTreeNode(QuadTreeNode* parentNode)
-		:m_parentNode(parentNode)
+	template<typename T, typename BoundsPolicy>
+	inline QuadTreeNode<T, BoundsPolicy>::QuadTreeNode(QuadTreeNode* parentNode)
+		:m_parentNode(parentNode), m_pool(NULL), m_nextFree(NULL),
+		 m_overflow(NULL), m_overflowSizeClass(0), m_numItems(0), m_depth(0)
 	{
 		LOGD_LOOP("QuadTreeNode constructor [this: 0x%X]", this);
 
@@ -279,36 +813,79 @@ namespace pegas
 			m_childs[i] = NULL;
 		}
 
-		m_objectIterator.create(&m_objects);
+		m_objectIterator.create(this);
 	}
 
-	template<typename T>
-	inline QuadTreeNode<T>::~QuadTreeNode()
+	template<typename T, typename BoundsPolicy>
+	inline QuadTreeNode<T, BoundsPolicy>::~QuadTreeNode()
 	{
 		LOGD_LOOP("QuadTreeNode destructor [this: 0x%X]", this);
 
-		for(int i = 0; i < k_childTotal; i++)
-		{
-			if(m_childs[i]) delete m_childs[i];
-		}
+		//      
 	}
 
-	template<typename T>
-	inline QuadTreeNode<T>* QuadTreeNode<T>::getParentNode()
+	template<typename T, typename BoundsPolicy>
+	inline QuadTreeNode<T, BoundsPolicy>* QuadTreeNode<T, BoundsPolicy>::getParentNode()
 	{
 		return m_parentNode;
 	}
 
-	template<typename T>
-	inline typename QuadTreeNode<T>::IIterator* QuadTreeNode<T>::getIterator()
+	template<typename T, typename BoundsPolicy>
+	inline typename QuadTreeNode<T, BoundsPolicy>::IIterator* QuadTreeNode<T, BoundsPolicy>::getIterator()
 	{
 		m_objectIterator.rewind();
 
 		return &m_objectIterator;
 	}
 
-	template<typename T>
-	void QuadTreeNode<T>::setAABB(const Rect2D& AABB)
+	template<typename T, typename BoundsPolicy>
+	inline Rect2D QuadTreeNode<T, BoundsPolicy>::getChildAABB(int32 child) const
+	{
+		Point2D half = (m_AABB._bottomRight - m_AABB._topLeft) / 2;
+		Point2D center = m_AABB._topLeft + half;
+
+		Rect2D childAABB;
+		switch(child)
+		{
+		case k_childNorthWest:
+			childAABB._topLeft = m_AABB._topLeft;
+			childAABB._bottomRight = center;
+			break;
+		case k_childNorthEast:
+			childAABB._topLeft = Point2D(center._x, m_AABB._topLeft._y);
+			childAABB._bottomRight = Point2D(m_AABB._bottomRight._x, center._y);
+			break;
+		case k_childSouthEast:
+			childAABB._topLeft = center;
+			childAABB._bottomRight = m_AABB._bottomRight;
+			break;
+		case k_childSouthWest:
+			childAABB._topLeft = Point2D(m_AABB._topLeft._x, center._y);
+			childAABB._bottomRight = Point2D(center._x, m_AABB._bottomRight._y);
+			break;
+		}
+
+		return childAABB;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline int32 QuadTreeNode<T, BoundsPolicy>::getChildIndex(const Rect2D& objectAABB) const
+	{
+		assert(m_childs[0] != NULL && "quad tree node has no child nodes");
+
+		for(int32 i = 0; i < k_childTotal; i++)
+		{
+			if(m_childs[i]->fits(objectAABB))
+			{
+				return i;
+			}
+		}
+
+		return -1;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	void QuadTreeNode<T, BoundsPolicy>::setAABB(const Rect2D& AABB)
 	{
 		LOGD_LOOP("QuadTreeNode<T>::setAABB [this: 0x%X]", this);
 		LOGD_LOOP("[AABB: x1 = %0.2f, y1 = %0.2f, x2 = %0.2f, y2 = %0.2f]",
@@ -316,205 +893,307 @@ namespace pegas
 				AABB._bottomRight._x, AABB._bottomRight._y);
 
 		m_AABB = AABB;
+		m_looseAABB = BoundsPolicy::getLooseAABB(AABB);
 
 		if(m_childs[0] != NULL)
 		{
-			Point2D half = (AABB._bottomRight - AABB._topLeft) / 2;
-			Point2D center = AABB._topLeft + half;
-			Point2D centerLeftEdge(AABB._topLeft._x, center._y);
-			Point2D centerRightEdge(AABB._bottomRight._x, center._y);
-			Point2D centerUpEdge(center._x, AABB._topLeft._y);
-			Point2D centerBottomEdge(center._x, AABB._bottomRight._y);
-
-			Rect2D childAABB;
-
-			LOGD_LOOP("setup AABB for NorthWest child node");
-			childAABB._topLeft = AABB._topLeft;
-			childAABB._bottomRight = center;
-			m_childs[k_childNorthWest]->setAABB(childAABB);
-
-			LOGD_LOOP("setup AABB for NorthEast child node");
-			childAABB._topLeft = centerUpEdge;
-			childAABB._bottomRight = centerRightEdge;
-			m_childs[k_childNorthEast]->setAABB(childAABB);
+			for(int32 i = 0; i < k_childTotal; i++)
+			{
+				m_childs[i]->setAABB(getChildAABB(i));
+			}
+		}
+	}
 
-			LOGD_LOOP("setup AABB for SouthEast child node");
-			childAABB._topLeft = center;
-			childAABB._bottomRight = AABB._bottomRight;
-			m_childs[k_childSouthEast]->setAABB(childAABB);
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTreeNode<T, BoundsPolicy>::createChilds()
+	{
+		LOGD_LOOP("creating child nodes");
 
-			LOGD_LOOP("setup AABB for SouthWest child node");
-			childAABB._topLeft = centerLeftEdge;
-			childAABB._bottomRight = centerBottomEdge;
-			m_childs[k_childSouthWest]->setAABB(childAABB);
+		QuadTreeNode<T, BoundsPolicy>* quad = m_pool->allocateQuad(this);
+		for(int32 i = 0; i < k_childTotal; i++)
+		{
+			m_childs[i] = &quad[i];
+			m_childs[i]->m_depth = m_depth + 1;
 		}
+		setAABB(m_AABB);
 	}
 
-	template<typename T>
-	inline QuadTreeNode<T>* QuadTreeNode<T>::insertObject(const T& object, const Rect2D& objectAABB)
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTreeNode<T, BoundsPolicy>::freeChilds()
 	{
-		LOGD_LOOP("QuadTreeNode<T>::insertObject [this: 0x%X]", this);
-		LOGD_LOOP("[objectAABB: x1 = %0.2f, y1 = %0.2f, x2 = %0.2f, y2 = %0.2f]",
-				objectAABB._topLeft._x, objectAABB._topLeft._y,
-				objectAABB._bottomRight._x, objectAABB._bottomRight._y);
+		m_pool->freeQuad(m_childs[0]);
 
-		if(!m_AABB.contains(objectAABB))
+		for(int32 i = 0; i < k_childTotal; i++)
 		{
-			LOGW("!m_AABB.contains(objectAABB)");
+			m_childs[i] = NULL;
+		}
+	}
 
-			return NULL;
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTreeNode<T, BoundsPolicy>::addItem(const Item& item)
+	{
+		if(m_numItems < k_inlineItems)
+		{
+			m_items[m_numItems++] = item;
+			return;
 		}
 
-		if(m_childs[0] == NULL)
+		int32 index = m_numItems - k_inlineItems;
+		if(m_overflow == NULL || index >= Pool::getItemArraySize(m_overflowSizeClass))
 		{
-			LOGD_LOOP("creating child nodes");
+			int32 sizeClass;
+			Item* overflow = m_pool->allocateItems(index + 1, sizeClass);
+			for(int32 i = 0; i < index; i++)
+			{
+				overflow[i] = m_overflow[i];
+				m_overflow[i] = Item();
+			}
 
-			for(int i = 0; i < k_childTotal; i++)
+			if(m_overflow != NULL)
 			{
-				m_childs[i] = new QuadTreeNode<T>(this);
+				m_pool->freeItems(m_overflow, m_overflowSizeClass);
 			}
-			setAABB(m_AABB);
+			m_overflow = overflow;
+			m_overflowSizeClass = sizeClass;
 		}
 
-		LOGD_LOOP("try insert object into child nodes");
-		for(int i = 0; i < k_childTotal; i++)
+		m_overflow[index] = item;
+		m_numItems++;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline void QuadTreeNode<T, BoundsPolicy>::clearItems()
+	{
+		for(int32 i = 0; i < m_numItems; i++)
 		{
-			if(m_childs[i]->insertObject(object, objectAABB))
-			{
-				return m_childs[i];
-			}
+			getItem(i) = Item();
 		}
+		m_numItems = 0;
 
-		QuadTreeItem item(object, objectAABB);
-		ObjectListIt foundIt = std::find(m_objects.begin(), m_objects.end(), item);
-		if(foundIt == m_objects.end())
+		if(m_overflow != NULL)
 		{
-			LOGD_LOOP("inserting object to node 0x%X", this);
+			m_pool->freeItems(m_overflow, m_overflowSizeClass);
+			m_overflow = NULL;
+		}
+	}
+
+	template<typename T, typename BoundsPolicy>
+	inline bool QuadTreeNode<T, BoundsPolicy>::collapse(int32 nodeCapacity)
+	{
+		if(m_childs[0] != NULL && m_numItems < nodeCapacity)
+		{
+			for(int32 i = 0; i < k_childTotal; i++)
+			{
+				if(m_childs[i]->m_numItems > 0 || m_childs[i]->m_childs[0] != NULL)
+				{
+					return false;
+				}
+			}
 
-			m_objects.push_back(item);
-			return this;
+			freeChilds();
 		}
 
-		return NULL;
+		return m_numItems == 0;
 	}
 
-	template<typename T>
-	inline bool QuadTreeNode<T>::removeObject(const T& object)
+	template<typename T, typename BoundsPolicy>
+	inline SpatialHandle QuadTreeNode<T, BoundsPolicy>::removeItem(int32 index)
 	{
-		LOGD_LOOP("QuadTreeNode::removeObject [this: 0x%X]", this);
+		SpatialHandle moved = k_invalidSpatialHandle;
 
-		QuadTreeItem item(object, Rect2D());
-		ObjectListIt foundIt = std::find(m_objects.begin(), m_objects.end(), item);
-		if(foundIt != m_objects.end())
+		m_numItems--;
+		if(index < m_numItems)
 		{
-			m_objects.erase(foundIt);
-			return true;
+			getItem(index) = getItem(m_numItems);
+			moved = getItem(index)._handle;
 		}
+		getItem(m_numItems) = Item();
 
-		return false;
+		if(m_numItems <= k_inlineItems && m_overflow != NULL)
+		{
+			m_pool->freeItems(m_overflow, m_overflowSizeClass);
+			m_overflow = NULL;
+		}
+
+		return moved;
 	}
 
-	template<typename T>
-	inline bool QuadTreeNode<T>::removeAllObjects()
+	template<typename T, typename BoundsPolicy>
+	inline bool QuadTreeNode<T, BoundsPolicy>::removeAllObjects()
 	{
 		LOGD_LOOP("QuadTreeNode::removeAllObjects [this: 0x%X]", this);
 
-		m_objects.clear();
+		clearItems();
 
-		for(int i = 0; i < k_childTotal; i++)
+		if(m_childs[0] != NULL)
 		{
-			if(m_childs[i])
+			for(int i = 0; i < k_childTotal; i++)
 			{
 				m_childs[i]->removeAllObjects();
-			}
-		}//for(int i = 0; i < k_childTotal; i++)
+			}//for(int i = 0; i < k_childTotal; i++)
+
+			freeChilds();
+		}
+
+		return true;
 	}
 
-	template<typename T>
-	inline void QuadTreeNode<T>::query(const Rect2D& queryAABB, std::list<T>& result)
+	template<typename T, typename BoundsPolicy>
+	template<typename Visitor>
+	inline int32 QuadTreeNode<T, BoundsPolicy>::query(const Rect2D& queryAABB, Visitor& visitor)
 	{
 		//LOGD_LOOP("QuadTreeNode::query [this: 0x%X]", this);
 
-		if(queryAABB.contains(m_AABB))
+		if(queryAABB.contains(m_looseAABB))
 		{
 			//     
 			//-        
-			//LOGW("queryAABB.contains(m_AABB)");
+			//LOGW("queryAABB.contains(m_looseAABB)");
 
-			query(result);
-			return;
+			return query(visitor);
 		}
 
-		if(!m_AABB.intersectsWith(queryAABB) && !m_AABB.contains(queryAABB))
+		if(!m_looseAABB.intersectsWith(queryAABB) && !m_looseAABB.contains(queryAABB))
 		{
 			//      
 			//      -    , 
-			//LOGW("!m_AABB.intersectsWith(queryAABB) && !m_AABB.contains(queryAABB)");
+			//LOGW("!m_looseAABB.intersectsWith(queryAABB) && !m_looseAABB.contains(queryAABB)");
 
-			return;
+			return 1;
 		}
 
-		for(ObjectListIt it = m_objects.begin(); it != m_objects.end(); ++it)
+		for(int32 i = 0; i < m_numItems; i++)
 		{
-			Rect2D rect = (*it)._objectAABB;
+			const Item& item = getItem(i);
+			const Rect2D& rect = item._objectAABB;
 			if(queryAABB.contains(rect) //     - 
 				|| rect.contains(queryAABB) //  ,     - 
 				|| queryAABB.intersectsWith(rect)) //      - 
 			{
-				result.push_back((*it)._object);
+				visitor(item._object);
 			}
 		}
 
+		int32 numVisited = 1;
 		for(int i = 0; i < k_childTotal; i++)
 		{
 			if(m_childs[i])
 			{
-				m_childs[i]->query(queryAABB, result);
+				numVisited += m_childs[i]->query(queryAABB, visitor);
 			}
 		}//for(int i = 0; i < k_childTotal; i++)
+
+		return numVisited;
 	}
 
-	template<typename T>
-	inline void QuadTreeNode<T>::query(const Point2D& queryPoint, std::list<T>& result)
+	template<typename T, typename BoundsPolicy>
+	template<typename Visitor>
+	inline int32 QuadTreeNode<T, BoundsPolicy>::query(const Point2D& queryPoint, Visitor& visitor)
 	{
-		if(!m_AABB.contains(queryPoint))
+		if(!m_looseAABB.contains(queryPoint))
 		{
-			return;
+			return 1;
 		}
 
-		for(ObjectListIt it = m_objects.begin(); it != m_objects.end(); ++it)
+		for(int32 i = 0; i < m_numItems; i++)
 		{
-			Rect2D rect = (*it)._objectAABB;
-			if(rect.contains(queryPoint))
+			const Item& item = getItem(i);
+			if(item._objectAABB.contains(queryPoint))
 			{
-				result.push_back((*it)._object);
+				visitor(item._object);
 			}
 		}
 
+		int32 numVisited = 1;
 		for(int i = 0; i < k_childTotal; i++)
 		{
 			if(m_childs[i])
 			{
-				m_childs[i]->query(queryPoint, result);
+				numVisited += m_childs[i]->query(queryPoint, visitor);
 			}
 		}//for(int i = 0; i < k_childTotal; i++)
+
+		return numVisited;
 	}
 
-	template<typename T>
-	inline void QuadTreeNode<T>::query(std::list<T>& result)
+	template<typename T, typename BoundsPolicy>
+	template<typename Visitor>
+	inline int32 QuadTreeNode<T, BoundsPolicy>::castRay(const Point2D& origin, const Point2D& direction, float radius,
+			float& maxDistance, Visitor& visitor)
+	{
+		float distance;
+
+		for(int32 i = 0; i < m_numItems; i++)
+		{
+			const Item& item = getItem(i);
+			if(intersectRayRect(origin, direction, item._objectAABB, radius, maxDistance, distance))
+			{
+				visitor(item._object, maxDistance);
+			}
+		}
+
+		if(m_childs[0] == NULL)
+		{
+			return 1;
+		}
+
+		//        
+		QuadTreeNode<T, BoundsPolicy>* childs[k_childTotal];
+		float distances[k_childTotal];
+		int32 numChilds = 0;
+
+		for(int i = 0; i < k_childTotal; i++)
+		{
+			if(!intersectRayRect(origin, direction, m_childs[i]->m_looseAABB, radius, maxDistance, distance))
+			{
+				continue;
+			}
+
+			int32 j = numChilds++;
+			while(j > 0 && distances[j - 1] > distance)
+			{
+				childs[j] = childs[j - 1];
+				distances[j] = distances[j - 1];
+				j--;
+			}
+
+			childs[j] = m_childs[i];
+			distances[j] = distance;
+		}
+
+		int32 numVisited = 1;
+		for(int32 i = 0; i < numChilds; i++)
+		{
+			if(distances[i] > maxDistance)
+			{
+				break;
+			}
+
+			numVisited += childs[i]->castRay(origin, direction, radius, maxDistance, visitor);
+		}
+
+		return numVisited;
+	}
+
+	template<typename T, typename BoundsPolicy>
+	template<typename Visitor>
+	inline int32 QuadTreeNode<T, BoundsPolicy>::query(Visitor& visitor)
 	{
-		for(ObjectListIt it = m_objects.begin(); it != m_objects.end(); ++it)
+		for(int32 i = 0; i < m_numItems; i++)
 		{
-			result.push_back((*it)._object);
+			visitor(getItem(i)._object);
 		}
 
+		int32 numVisited = 1;
 		for(int i = 0; i < k_childTotal; i++)
 		{
 			if(m_childs[i])
 			{
-				m_childs[i]->query(result);
+				numVisited += m_childs[i]->query(visitor);
 			}
 		}//for(int i = 0; i < k_childTotal; i++)
+
+		return numVisited;
 	}
 }
 
@@ -0,0 +1,39 @@
+#ifndef CORE_SPATIAL_INDEX_H_
+#define CORE_SPATIAL_INDEX_H_
+
+#include "../core/types.h"
+
+namespace pegas
+{
+	//	  -   SpatialSceneManager  SpatialPhysics.
+	//	QuadTree  AABBTree  :
+	//		create(worldArea), destroy(), removeAllObjects()
+	//		SpatialHandle insertObject(object, AABB)
+	//		bool removeObject(SpatialHandle&), bool updateObject(SpatialHandle&, AABB)
+	//		bool isValidHandle(SpatialHandle)
+	//		query(Rect2D | Point2D, std::list | std::vector | visitor)
+	//		castRay(origin, direction, radius, maxDistance, visitor)
+	//		getNumNodesVisited(), getNumReinsertions()   
+	//		getVersion(), appendToSnapshot(SpatialSnapshot&) - . spatial_snapshot.h
+
+	//	   :  insertObject    ,
+	//	        .  ,
+	//	   
+	typedef int32 SpatialHandle;
+	const SpatialHandle k_invalidSpatialHandle = -1;
+
+	//    :      result
+	template<typename T, typename Container>
+	class SpatialCollector
+	{
+	public:
+		SpatialCollector(Container& result): m_result(result) {}
+
+		void operator()(const T& object) { m_result.push_back(object); }
+
+	private:
+		Container& m_result;
+	};
+}
+
+#endif /* CORE_SPATIAL_INDEX_H_ */
@@ -0,0 +1,320 @@
+#ifndef CORE_SPATIAL_SNAPSHOT_H_
+#define CORE_SPATIAL_SNAPSHOT_H_
+
+#include "../core/geometry.h"
+#include "../core/spatial_index.h"
+#include "../system/log.h"
+
+namespace pegas
+{
+	//	        .
+	//	QuadTree, AABBTree  LinearQuadTree      (appendToSnapshot)
+	//	    ,   LinearQuadTree:     ,
+	//	    ,       
+	//	 .      .  
+	//	   ,     ,     ,
+	//	         .
+	//	   :    ,   -
+	//	  
+	template<typename T>
+	class SpatialSnapshot
+	{
+	public:
+		SpatialSnapshot();
+
+		// ,  appendToSnapshot   
+		void clear(uint32 version);
+		uint32 getVersion() const { return m_version; }
+		int32 getNumObjects() const { return (int32)m_items.size(); }
+		int32 getNumNodes() const { return (int32)m_nodes.size(); }
+		const T& getObject(int32 index) const { return m_items[index]._object; }
+		const Rect2D& getObjectAABB(int32 index) const { return m_items[index]._objectAABB; }
+
+		//: beginNode  ,  addObject    ,
+		//   , endNode     false,   
+		int32 beginNode();
+		void addObject(const T& object, const Rect2D& objectAABB);
+		bool endNode(int32 index);
+
+		//     result,     
+		int32 query(const Rect2D& objectAABB, std::vector<T>& result) const;
+		int32 query(const Point2D& queryPoint, std::vector<T>& result) const;
+
+		//visitor(object)     ,   ,   QuadTree
+		template<typename Visitor>
+		int32 query(const Rect2D& objectAABB, Visitor& visitor) const;
+		template<typename Visitor>
+		int32 query(const Point2D& queryPoint, Visitor& visitor) const;
+
+		// ,  AABB,   radius,  origin + direction * t 
+		//  maxDistance; visitor(object, maxDistance)   maxDistance.
+		//    ,      
+		template<typename Visitor>
+		int32 castRay(const Point2D& origin, const Point2D& direction, float radius,
+				float maxDistance, Visitor& visitor) const;
+
+	private:
+		struct Item
+		{
+			T _object;
+			Rect2D _objectAABB;
+		};
+
+		struct Node
+		{
+			//  
+			float _minX;
+			float _minY;
+			float _maxX;
+			float _maxY;
+			//  - [_firstItem, _firstItem + _numItems),
+			//  - [_firstItem, _endItem)
+			int32 _firstItem;
+			int32 _numItems;
+			int32 _endItem;
+			//   
+			int32 _next;
+		};
+
+		static void getBounds(const Rect2D& rect, float& minX, float& minY, float& maxX, float& maxY);
+		static bool isOutside(const Node& node, float minX, float minY, float maxX, float maxY)
+		{
+			return node._maxX < minX || node._minX > maxX || node._maxY < minY || node._minY > maxY;
+		}
+
+		std::vector<Item> m_items;
+		std::vector<Node> m_nodes;
+		uint32 m_version;
+
+	private:
+		SpatialSnapshot(const SpatialSnapshot& other);
+		SpatialSnapshot& operator=(const SpatialSnapshot& other);
+	};
+
+	//-----------------------------------------------------------------------------
+	//	SpatialSnapshot class implementation
+	//-----------------------------------------------------------------------------
+	template<typename T>
+	inline SpatialSnapshot<T>::SpatialSnapshot()
+		:m_version(0)
+	{
+
+	}
+
+	template<typename T>
+	inline void SpatialSnapshot<T>::clear(uint32 version)
+	{
+		//     
+		m_items.clear();
+		m_nodes.clear();
+		m_version = version;
+	}
+
+	template<typename T>
+	inline int32 SpatialSnapshot<T>::beginNode()
+	{
+		Node node;
+		node._minX = std::numeric_limits<float>::max();
+		node._minY = std::numeric_limits<float>::max();
+		node._maxX = -std::numeric_limits<float>::max();
+		node._maxY = -std::numeric_limits<float>::max();
+		node._firstItem = (int32)m_items.size();
+		node._numItems = 0;
+		node._endItem = node._firstItem;
+		node._next = -1;
+
+		m_nodes.push_back(node);
+
+		return (int32)m_nodes.size() - 1;
+	}
+
+	template<typename T>
+	inline void SpatialSnapshot<T>::addObject(const T& object, const Rect2D& objectAABB)
+	{
+		Node& node = m_nodes.back();
+		assert(node._next < 0 && node._firstItem + node._numItems == (int32)m_items.size()
+				&& "objects of a snapshot node must be added before its childs");
+
+		Item item;
+		item._object = object;
+		item._objectAABB = objectAABB;
+		m_items.push_back(item);
+		node._numItems++;
+
+		float minX, minY, maxX, maxY;
+		getBounds(objectAABB, minX, minY, maxX, maxY);
+		node._minX = std::min(node._minX, minX);
+		node._minY = std::min(node._minY, minY);
+		node._maxX = std::max(node._maxX, maxX);
+		node._maxY = std::max(node._maxY, maxY);
+	}
+
+	template<typename T>
+	inline bool SpatialSnapshot<T>::endNode(int32 index)
+	{
+		Node& node = m_nodes[index];
+		if(node._numItems == 0 && index == (int32)m_nodes.size() - 1)
+		{
+			m_nodes.pop_back();
+			return false;
+		}
+
+		node._endItem = (int32)m_items.size();
+		node._next = (int32)m_nodes.size();
+
+		//  -   ,    
+		for(int32 child = index + 1; child < node._next; child = m_nodes[child]._next)
+		{
+			const Node& childNode = m_nodes[child];
+			node._minX = std::min(node._minX, childNode._minX);
+			node._minY = std::min(node._minY, childNode._minY);
+			node._maxX = std::max(node._maxX, childNode._maxX);
+			node._maxY = std::max(node._maxY, childNode._maxY);
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	inline void SpatialSnapshot<T>::getBounds(const Rect2D& rect, float& minX, float& minY, float& maxX, float& maxY)
+	{
+		minX = std::min(rect._topLeft._x, rect._bottomRight._x);
+		minY = std::min(rect._topLeft._y, rect._bottomRight._y);
+		maxX = std::max(rect._topLeft._x, rect._bottomRight._x);
+		maxY = std::max(rect._topLeft._y, rect._bottomRight._y);
+	}
+
+	template<typename T>
+	template<typename Visitor>
+	inline int32 SpatialSnapshot<T>::query(const Rect2D& queryAABB, Visitor& visitor) const
+	{
+		float minX, minY, maxX, maxY;
+		getBounds(queryAABB, minX, minY, maxX, maxY);
+
+		int32 numVisited = 0;
+		int32 numNodes = (int32)m_nodes.size();
+		int32 index = 0;
+		while(index < numNodes)
+		{
+			const Node& node = m_nodes[index];
+			numVisited++;
+
+			if(isOutside(node, minX, minY, maxX, maxY))
+			{
+				index = node._next;
+				continue;
+			}
+
+			if(node._minX >= minX && node._maxX <= maxX && node._minY >= minY && node._maxY <= maxY)
+			{
+				//     
+				for(int32 i = node._firstItem; i < node._endItem; i++)
+				{
+					visitor(m_items[i]._object);
+				}
+
+				index = node._next;
+				continue;
+			}
+
+			for(int32 i = node._firstItem; i < node._firstItem + node._numItems; i++)
+			{
+				const Item& item = m_items[i];
+				const Rect2D& rect = item._objectAABB;
+				if(queryAABB.contains(rect) || rect.contains(queryAABB) || queryAABB.intersectsWith(rect))
+				{
+					visitor(item._object);
+				}
+			}
+
+			index++;
+		}
+
+		return numVisited;
+	}
+
+	template<typename T>
+	template<typename Visitor>
+	inline int32 SpatialSnapshot<T>::query(const Point2D& queryPoint, Visitor& visitor) const
+	{
+		int32 numVisited = 0;
+		int32 numNodes = (int32)m_nodes.size();
+		int32 index = 0;
+		while(index < numNodes)
+		{
+			const Node& node = m_nodes[index];
+			numVisited++;
+
+			if(isOutside(node, queryPoint._x, queryPoint._y, queryPoint._x, queryPoint._y))
+			{
+				index = node._next;
+				continue;
+			}
+
+			for(int32 i = node._firstItem; i < node._firstItem + node._numItems; i++)
+			{
+				const Item& item = m_items[i];
+				if(item._objectAABB.contains(queryPoint))
+				{
+					visitor(item._object);
+				}
+			}
+
+			index++;
+		}
+
+		return numVisited;
+	}
+
+	template<typename T>
+	template<typename Visitor>
+	inline int32 SpatialSnapshot<T>::castRay(const Point2D& origin, const Point2D& direction, float radius,
+			float maxDistance, Visitor& visitor) const
+	{
+		int32 numVisited = 0;
+		int32 numNodes = (int32)m_nodes.size();
+		int32 index = 0;
+		float distance;
+		while(index < numNodes)
+		{
+			const Node& node = m_nodes[index];
+			numVisited++;
+
+			Rect2D bounds(Point2D(node._minX, node._minY), Point2D(node._maxX, node._maxY));
+			if(!intersectRayRect(origin, direction, bounds, radius, maxDistance, distance))
+			{
+				index = node._next;
+				continue;
+			}
+
+			for(int32 i = node._firstItem; i < node._firstItem + node._numItems; i++)
+			{
+				const Item& item = m_items[i];
+				if(intersectRayRect(origin, direction, item._objectAABB, radius, maxDistance, distance))
+				{
+					visitor(item._object, maxDistance);
+				}
+			}
+
+			index++;
+		}
+
+		return numVisited;
+	}
+
+	template<typename T>
+	inline int32 SpatialSnapshot<T>::query(const Rect2D& objectAABB, std::vector<T>& result) const
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		return query(objectAABB, collector);
+	}
+
+	template<typename T>
+	inline int32 SpatialSnapshot<T>::query(const Point2D& queryPoint, std::vector<T>& result) const
+	{
+		SpatialCollector<T, std::vector<T> > collector(result);
+		return query(queryPoint, collector);
+	}
+}
+
+#endif /* CORE_SPATIAL_SNAPSHOT_H_ */
@@ -2,7 +2,7 @@
 #define PEGAS_TYPES_H
 #pragma once
 
-#ifdef ANDROID
+#if defined(ANDROID) || defined(PEGAS_HOST)
 #include <stdint.h>
 #endif
 
@@ -37,7 +37,7 @@ namespace pegas
 	typedef unsigned __int64	uint64;
 #endif
 
-#ifdef ANDROID
+#if defined(ANDROID) || defined(PEGAS_HOST)
 	typedef int32_t  	int32;
 	typedef int16_t    	int16;
 	typedef int8_t     	int8;
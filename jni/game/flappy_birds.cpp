@@ -32,6 +32,12 @@ namespace pegas
 	float GameWorld::s_bornLine = 0.0f;
 	float GameWorld::s_deadLine = 0.0f;
 	float GameWorld::s_columnWindowHeight = 0.0f;
+	int32 GameWorld::s_scrollLayer = 0;
+	float GameWorld::s_scrollOffset = 0.0f;
+
+	//the scroll offset is folded back by this distance, a float of this size
+	//still keeps the layer coordinates of the columns within k_layerTransformEpsilon
+	static const float k_scrollFoldDistance = 4096.0f;
 
 	float GameWorld::getSpriteScale()
 	{
@@ -58,9 +64,19 @@ namespace pegas
 		return s_columnWindowHeight;
 	}
 
+	int32 GameWorld::getScrollLayer()
+	{
+		return s_scrollLayer;
+	}
+
+	float GameWorld::getScrollOffset()
+	{
+		return s_scrollOffset;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////
 	GameWorld::GameWorld()
-		:m_gameStarted(false), m_columnsSpawned(0)
+		:m_gameStarted(false), m_columnsSpawned(0), m_physicsManager(0)
 	{
 	}
 
@@ -120,6 +136,12 @@ namespace pegas
 		physicsManager->setCollisionPairGroupFlag(Bird::k_collisionGroup, Obstacle::k_collisionGroup, true);
 		physicsManager->setCollisionPairGroupFlag(Bird::k_collisionGroup, Trigger::k_collisionGroup, true);
 		physicsManager->setCollisionPairGroupFlag(Trigger::k_collisionGroup, Obstacle::k_collisionGroup, false);
+
+		//columns scroll together: one offset of their layer per frame
+		//instead of moving every obstacle and trigger
+		m_physicsManager = physicsManager;
+		s_scrollLayer = physicsManager->createScrollLayer();
+		s_scrollOffset = 0.0f;
 	}
 
 	void GameWorld::handleEvent(EventPtr evt)
@@ -169,6 +191,20 @@ namespace pegas
 		float dt = deltaTime / 1000.0f;
 		float offset = getColumnVelocity() * dt;
 		m_spawnPosition._x += offset;
+
+		//the offset of the layer is kept bounded: after a fold the columns
+		//move their hulls by the folded distance inside the layer, every
+		//column scene node moves in this frame and resends its hull
+		s_scrollOffset += offset;
+		if(s_scrollOffset < -k_scrollFoldDistance)
+		{
+			s_scrollOffset += k_scrollFoldDistance;
+		}
+
+		if(m_physicsManager)
+		{
+			m_physicsManager->setScrollLayerOffset(s_scrollLayer, Vector3(s_scrollOffset, 0.0f, 0.0f));
+		}
 	}
 
 	void GameWorld::spawnNewColumn()
@@ -229,7 +265,8 @@ namespace pegas
 		SpriteSceneNode* backgroundSceneNode = new SpriteSceneNode(background);
 		backgroundSceneNode->setTransfrom(scale);
 		backgroundSceneNode->setZIndex(-10.0f);
-		SceneNode* rootNode = sceneManager->getRootNode();
+		//  
+		SceneNode* rootNode = sceneManager->getStaticRootNode();
 
 		LOGI("put background node to scene...");
 		rootNode->attachChild(backgroundSceneNode);
@@ -364,7 +401,7 @@ namespace pegas
 
 	void Column::onCreateSceneNode(Atlas* atlas, SceneManager* sceneManager, const Vector3& spawnPoint)
 	{
-		LOGI("Column::onCreateSceneNode this = %x", this);
+		LOGI("Column::onCreateSceneNode this = %p", this);
 
 		m_currentPosition = spawnPoint;
 
@@ -479,7 +516,7 @@ namespace pegas
 
 	void Column::onCreate(IPlatformContext* context, void* pData)
 	{
-		LOGI("Column::onCreate this = %x", this);
+		LOGI("Column::onCreate this = %p", this);
 
 		GameObject::onCreate(context, pData);
 
@@ -493,7 +530,7 @@ namespace pegas
 
 	void Column::onDestroy(IPlatformContext* context)
 	{
-		LOGI("Column::onDestroy this = %x", this);
+		LOGI("Column::onDestroy this = %p", this);
 
 		LOGI("remove event listener");
 		EventManager* eventManager = context->getEventManager();
@@ -555,7 +592,7 @@ namespace pegas
 								 SceneManager* sceneManager,
 								 const Vector3& spawnPoint)
 	{
-		LOGI("Bird::onCreateSceneNode this = %x", this);
+		LOGI("Bird::onCreateSceneNode this = %p", this);
 
 		m_gravity = Ground::getGroundLevel();
 		m_impulsVelocity = -(Ground::getGroundLevel() / 2.0f);
@@ -609,11 +646,11 @@ namespace pegas
 
 	void Bird::onCreateCollisionHull(IPhysics* physicsManager)
 	{
-		LOGI("Bird::onCreateCollisionHull this = %x", this);
+		LOGI("Bird::onCreateCollisionHull this = %p", this);
 
 		LOGI("register collidable circle");
 		m_physicsManager = physicsManager;
-		m_physicsManager->registerCircle((int32)this, k_collisionGroup, Vector3(), m_radius);
+		m_physicsManager->registerCircle(m_handle, k_collisionGroup, Vector3(), m_radius);
 	}
 
 	void Bird::onCollission(GameObject* other)
@@ -773,7 +810,7 @@ namespace pegas
 			matTransform = matTransform * matPosition;
 		}
 		m_birdNode->setTransfrom(matTransform);
-		m_physicsManager->transformObject((int32)this, matTransform);
+		m_physicsManager->transformObject(m_handle, matTransform);
 	}
 
 	void Bird::setAngle(float angle)
@@ -821,7 +858,7 @@ namespace pegas
 
 	void Bird::onCreate(IPlatformContext* context, void* pData)
 	{
-		LOGI("Bird::onCreate this = %x", (int)this);
+		LOGI("Bird::onCreate this = %p", this);
 
 		GameObject::onCreate(context, pData);
 
@@ -837,7 +874,7 @@ namespace pegas
 
 	void Bird::onDestroy(IPlatformContext* context)
 	{
-		LOGI("Bird::onDestroy this = %x", (int)this);
+		LOGI("Bird::onDestroy this = %p", this);
 
 		LOGI("removing animation...");
 		m_animation->terminate();
@@ -847,7 +884,7 @@ namespace pegas
 		root->removeChild(m_birdNode, true);
 
 		LOGI("unregister collision hull...");
-		m_physicsManager->unregisterCollisionHull((int32)this);
+		m_physicsManager->unregisterCollisionHull(m_handle);
 
 		LOGI("remove event listener...");
 		EventManager* eventManager = context->getEventManager();
@@ -874,8 +911,30 @@ namespace pegas
 	const std::string Obstacle::k_name = "Obstacle";
 	const std::string Trigger::k_name = "Trigger";
 
+	//a column node and the scroll offset are moved by the same velocity,
+	//their float sums may differ a little. The offset is folded back before
+	//its float step grows past the epsilon (see GameWorld::update)
+	static const float k_layerTransformEpsilon = 0.01f;
+
+	static bool isSameLayerTransform(const Matrix4x4& a, const Matrix4x4& b)
+	{
+		//everything but the translation along x must match exactly
+		for(int32 row = 0; row < 4; row++)
+		{
+			for(int32 column = 0; column < 4; column++)
+			{
+				if((row != 3 || column != 0) && a._m[row][column] != b._m[row][column])
+				{
+					return false;
+				}
+			}
+		}
+
+		return fabs(a._41 - b._41) <= k_layerTransformEpsilon;
+	}
+
 	CollidableObject::CollidableObject()
-		:m_physicsManager(0)
+		:m_physicsManager(0), m_sceneNode(0)
 	{
 
 	}
@@ -884,8 +943,8 @@ namespace pegas
 	{
 		GameObject::onCreate(context, pData);
 
-		SceneNode* sceneNode = reinterpret_cast<SceneNode*>(pData);
-		sceneNode->addListener(this);
+		m_sceneNode = reinterpret_cast<SceneNode*>(pData);
+		m_sceneNode->addListener(this);
 	}
 
 	void CollidableObject::onCreateCollisionHull(IPhysics* physicsManager)
@@ -894,29 +953,44 @@ namespace pegas
 
 		m_physicsManager = physicsManager;
 
-		IPhysics::PointList points;
-		points.push_back(Vector3(-0.5f, -0.5f, 0.0f));
-		points.push_back(Vector3(0.5f, -0.5f, 0.0f));
-		points.push_back(Vector3(0.5f, 0.5f, 0.0f));
-		points.push_back(Vector3(-0.5f, 0.5f, 0.0f));
+		Rect2D box(Point2D(-0.5f, -0.5f), Point2D(0.5f, 0.5f));
 
 		int32 group = (getName() == Obstacle::k_name) ? Obstacle::k_collisionGroup : Trigger::k_collisionGroup;
-		m_physicsManager->registerPoligon((int32)this, group, points);
+		m_physicsManager->registerBox(m_handle, group, box);
+
+		//obstacles and triggers are parts of columns and scroll with them
+		m_physicsManager->attachToScrollLayer(m_handle, GameWorld::getScrollLayer());
+		updateCollisionHull(true);
 	}
 
 	void CollidableObject::onDestroy(IPlatformContext* context)
 	{
 		GameObject::onDestroy(context);
 
-		m_physicsManager->unregisterCollisionHull((int32)this);
+		m_physicsManager->unregisterCollisionHull(m_handle);
 	}
 
 	void CollidableObject::onTransfromChanged(SceneNode* sender)
 	{
 		//LOGW_TAG("Pegas_debug", "CollidableObject::onTransfromChanged");
 
-		Matrix4x4 m = sender->getWorldTransfrom();
-		m_physicsManager->transformObject((int32)this, m);
+		updateCollisionHull(false);
+	}
+
+	void CollidableObject::updateCollisionHull(bool force)
+	{
+		//a node moving with the scroll keeps its place in the layer,
+		//the hull is left alone
+		Matrix4x4 m = m_sceneNode->getWorldTransfrom();
+		m._41 -= GameWorld::getScrollOffset();
+
+		if(!force && isSameLayerTransform(m, m_layerTransform))
+		{
+			return;
+		}
+
+		m_layerTransform = m;
+		m_physicsManager->transformObject(m_handle, m);
 	}
 
 	void CollidableObject::onNodeRemoved(SceneNode* sender)
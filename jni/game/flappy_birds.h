@@ -23,6 +23,10 @@ namespace pegas
 		static float getBornLine();
 		static float getDeadLine();
 		static float getColumnWindowHeight();
+		//physics scroll layer of the columns and its offset along x,
+		//grows by getColumnVelocity() every frame of the game
+		static int32 getScrollLayer();
+		static float getScrollOffset();
 	public:
 		GameWorld();
 
@@ -42,6 +46,7 @@ namespace pegas
 		int     m_columnsSpawned;
 		float 	m_offset;
 		bool	m_gameStarted;
+		IPhysics* m_physicsManager;
 
 	private:
 		static float s_columnVelocity;
@@ -49,6 +54,8 @@ namespace pegas
 		static float s_bornLine;
 		static float s_deadLine;
 		static float s_columnWindowHeight;
+		static int32 s_scrollLayer;
+		static float s_scrollOffset;
 	};
 
 	class Background: public GameObject
@@ -199,7 +206,12 @@ namespace pegas
 		virtual void onNodeRemoved(SceneNode* sender);
 
 	private:
+		void updateCollisionHull(bool force);
+
 		IPhysics* m_physicsManager;
+		SceneNode* m_sceneNode;
+		//transform of the hull in the scroll layer, last sent to the physics
+		Matrix4x4 m_layerTransform;
 	};
 
 	class Trigger: public CollidableObject
@@ -57,6 +57,7 @@ namespace pegas
 
 		LOGI("setup physics manager...");
 		m_physicsManager.create(worldArea);
+		PhysicsStats::reset(m_physicsStats);
 
 		LOGI("setup process manager...");
 		m_processManager.init(context->getTimer());
@@ -82,6 +83,11 @@ namespace pegas
 		LOGI("deleting scene manager");
 		m_sceneManager.destroy();
 
+		LOGI("physics: %d updates, %.3f ms per update, %d candidate pairs, %d tests, %d hits, %d nodes visited, %d reinsertions",
+				m_physicsStats._numUpdates, m_physicsStats._updateTime * 1.0e3 / std::max(m_physicsStats._numUpdates, 1),
+				m_physicsStats._numCandidatePairs, PhysicsStats::getNumTests(m_physicsStats), m_physicsStats._numHits,
+				m_physicsStats._numNodesVisited, m_physicsStats._numReinsertions);
+
 		LOGI("deleting physics manager...");
 		m_physicsManager.destroy();
 
@@ -114,11 +120,20 @@ namespace pegas
 			m_processManager.updateProcesses(deltaTime);
 
 			m_physicsManager.update();
+			PhysicsStats::accumulate(m_physicsStats, m_physicsManager.getStats());
+
 			IPhysics::CollisionPairList& pairs = m_physicsManager.getCollidedPairs();
 			for(IPhysics::CollisionPairListIt it = pairs.begin(); it != pairs.end(); ++it)
 			{
-				GameObject* a = (GameObject*)it->first;
-				GameObject* b = (GameObject*)it->second;
+				//pairs which came into contact in this update, each contact is reported
+				//once; collision hull ids are process handles of the game objects
+				GameObject* a = static_cast<GameObject*>(m_processManager.getProcess(it->first).get());
+				GameObject* b = static_cast<GameObject*>(m_processManager.getProcess(it->second).get());
+				if(a == NULL || b == NULL)
+				{
+					continue;
+				}
+
 				a->onCollission(b);
 				b->onCollission(a);
 			}
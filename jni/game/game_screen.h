@@ -74,6 +74,7 @@ namespace pegas
 	private:
 		IPlatformContext*	m_context;
 		BasePhysics2   		m_physicsManager;
+		IPhysics::Stats		m_physicsStats;
 		ProcessManager		m_processManager;
 		SceneManager 		m_sceneManager;
 		SmartPointer<Atlas> m_atlas;
@@ -11,11 +11,8 @@ enum
 	k_gameStateGame
 };
 
-void android_main(android_app* application)
+static void setupGameStates(pegas::BaseGameApplication& gameApplication)
 {
-	pegas::EventLoop eventLoop(application);
-	pegas::AndroidGameApplication gameApplication(application);
-
 	pegas::GameStatePtr mainMenu(new pegas::DefaultGameState(k_gameStateMainMenu));
 	pegas::GameStatePtr gameScreen(new pegas::DefaultGameState(k_gameStateGame));
 
@@ -27,6 +24,73 @@ void android_main(android_app* application)
 	gameStateManager->addGameState(mainMenu);
 	gameStateManager->addGameState(gameScreen);
 	gameStateManager->changeState(k_gameStateMainMenu);
+}
+
+#ifdef ANDROID
+void android_main(android_app* application)
+{
+	pegas::EventLoop eventLoop(application);
+	pegas::AndroidGameApplication gameApplication(application);
+
+	setupGameStates(gameApplication);
 
 	eventLoop.run(&gameApplication, &gameApplication);
 }
+#endif
+
+#ifdef PEGAS_HOST
+
+#ifndef PEGAS_HOST_ASSETS_DIR
+#define PEGAS_HOST_ASSETS_DIR "assets"
+#endif
+
+//usage: flappybird_host [--frames N] [--tap N] [--assets DIR] [--log FILE]
+//	--frames N	number of steps to run (0 - until the game quits), default 600
+//	--tap N		tap the screen every N steps (0 - never), default 20
+//	--assets DIR	assets directory
+//	--log FILE	write the log to FILE instead of stdout
+int main(int argc, char* argv[])
+{
+	pegas::int32 frames = 600;
+	pegas::int32 tapInterval = 20;
+	std::string assetsPath = PEGAS_HOST_ASSETS_DIR;
+
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = (i + 1) < argc;
+
+		if(arg == "--frames" && hasValue)
+		{
+			frames = atoi(argv[++i]);
+		}else if(arg == "--tap" && hasValue)
+		{
+			tapInterval = atoi(argv[++i]);
+		}else if(arg == "--assets" && hasValue)
+		{
+			assetsPath = argv[++i];
+		}else if(arg == "--log" && hasValue)
+		{
+			pegas::Log::setOutputFile(argv[++i]);
+		}else
+		{
+			fprintf(stderr, "usage: %s [--frames N] [--tap N] [--assets DIR] [--log FILE]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	pegas::EventLoop eventLoop(frames);
+	pegas::HostGameApplication gameApplication(assetsPath);
+	gameApplication.setTapInterval(tapInterval);
+
+	setupGameStates(gameApplication);
+
+	eventLoop.run(&gameApplication);
+
+	printf("steps done: %d\n", eventLoop.getStepsDone());
+
+	pegas::Log::setOutputFile(NULL);
+
+	return 0;
+}
+#endif
@@ -17,11 +17,19 @@ namespace rapidxml
 
 namespace pegas
 {
+#ifdef ANDROID
 		Atlas::Atlas(android_app* context, const std::string& path)
 			:m_context(context), m_path(path)
 		{
 			LOGI("Atlas constructor");
 		}
+#else
+		Atlas::Atlas(const std::string& path)
+			:m_path(path)
+		{
+			LOGI("Atlas constructor");
+		}
+#endif
 
 		status Atlas::load()
 		{
@@ -38,7 +46,11 @@ namespace pegas
 			std::string texturePath;
 
 			LOGI("loading resource %s", m_path.c_str());
+#ifdef ANDROID
 			AssetResource resource(m_context, m_path);
+#else
+			FileResource resource(m_path);
+#endif
 			if(resource.load() != STATUS_OK)
 			{
 				LOGE("resource.load() != STATUS_OK");
@@ -96,7 +108,16 @@ namespace pegas
 
 			LOGI("loading atlas texture..");
 			texturePath = xmlAttrTexture->value();
+#ifdef ANDROID
 			m_texture = TexturePtr(new Texture(m_context, texturePath));
+#else
+			//texture path is relative to the atlas file
+			if(m_path.find_last_of('/') != std::string::npos)
+			{
+				texturePath = m_path.substr(0, m_path.find_last_of('/') + 1) + texturePath;
+			}
+			m_texture = TexturePtr(new Texture(texturePath));
+#endif
 			if(m_texture->load() != STATUS_OK)
 			{
 				LOGE("m_texture->load() != STATUS_OK");
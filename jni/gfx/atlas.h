@@ -10,7 +10,11 @@ namespace pegas
 	class Atlas
 	{
 	public:
+#ifdef ANDROID
 		Atlas(android_app* context, const std::string& path);
+#else
+		Atlas(const std::string& path);
+#endif
 
 		status load();
 		void unload();
@@ -23,7 +27,9 @@ namespace pegas
 		typedef std::map<std::string, ProcessPtr> AnimationMap;
 		typedef AnimationMap::iterator AnimationMapIt;
 
+#ifdef ANDROID
 		android_app* m_context;
+#endif
 		std::string  m_path;
 		TexturePtr 	 m_texture;
 		SpriteMap	 m_sprites;
@@ -54,6 +54,9 @@ namespace pegas
 #endif
 #ifdef ANDROID
     	static Gfx* createInstance(android_app* context);
+#endif
+#ifdef PEGAS_HOST
+    	static Gfx* createInstance(const std::string& assetsPath, int32 canvasWidth, int32 canvasHeight);
 #endif
 	};
 }
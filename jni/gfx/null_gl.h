@@ -0,0 +1,21 @@
+#ifndef PEGAS_GFX_NULL_GL_H_
+#define PEGAS_GFX_NULL_GL_H_
+
+//-----------------------------------------------------------------------------
+//	GL scalar types and pixel formats for builds without an OpenGL ES context
+//	(host build, null renderer). Only what the render queue and texture loader
+//	need; no GL entry points are declared here.
+//-----------------------------------------------------------------------------
+
+typedef float			GLfloat;
+typedef int				GLint;
+typedef unsigned int	GLuint;
+typedef unsigned int	GLenum;
+typedef unsigned short	GLushort;
+
+#define GL_RGB				0x1907
+#define GL_RGBA				0x1908
+#define GL_LUMINANCE		0x1909
+#define GL_LUMINANCE_ALPHA	0x190A
+
+#endif /* PEGAS_GFX_NULL_GL_H_ */
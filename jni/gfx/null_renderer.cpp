@@ -0,0 +1,169 @@
+#include "../common.h"
+#include "gfx.h"
+
+#include "../system/log.h"
+#include "texture.h"
+#include "atlas.h"
+
+#ifdef PEGAS_USE_NULL_GFX
+
+namespace pegas
+{
+	//renderer without a GL context: keeps the canvas size and the render queue
+	//statistics, loads textures and atlases from the file system (only image
+	//size and sprite layout are kept) and draws nothing
+	class NullRenderer: public Gfx
+	{
+	public:
+		NullRenderer(const std::string& assetsPath, int32 canvasWidth, int32 canvasHeight);
+
+		virtual status create();
+		virtual void   destroy();
+
+		virtual int32_t getCanvasWidth() const;
+		virtual int32_t getCanvasHeight() const;
+		virtual void clearCanvas(float r = 0.0f, float g = 0.0f, float b = 0.0f);
+		virtual void beginDraw();
+    	virtual status endDraw();
+    	virtual void render(const RenderQueueItem& item);
+    	virtual Texture* createTexture(const std::string& path);
+    	virtual Atlas* createAtlas(const std::string& path);
+
+    	virtual void setWorldMatrix(const Matrix4x4& mat);
+    	virtual void setViewMatrix(const Matrix4x4& mat);
+    	virtual void setProjectionMatrix(const Matrix4x4& mat);
+
+	private:
+    	std::string makePath(const std::string& path) const;
+
+    	std::string m_assetsPath;
+
+		int32_t m_canvasWidth;
+		int32_t m_canvasHeight;
+
+		int32 m_itemsQueued;
+		int32 m_framesDone;
+
+	private:
+		NullRenderer(const NullRenderer& other);
+		NullRenderer& operator=(const NullRenderer& other);
+	};
+
+	//-----------------------------------------------------------------------------------
+	//	instantiation
+	//-----------------------------------------------------------------------------------
+	Gfx* Gfx::createInstance(const std::string& assetsPath, int32 canvasWidth, int32 canvasHeight)
+	{
+		Gfx* gfx = new NullRenderer(assetsPath, canvasWidth, canvasHeight);
+		if(gfx->create() != STATUS_OK)
+		{
+			delete gfx;
+			return NULL;
+		}
+
+		return gfx;
+	}
+
+	//===================================================================================
+	//	NullRenderer implementation
+	//===================================================================================
+	NullRenderer::NullRenderer(const std::string& assetsPath, int32 canvasWidth, int32 canvasHeight)
+		:m_assetsPath(assetsPath),
+		 m_canvasWidth(canvasWidth),
+		 m_canvasHeight(canvasHeight),
+		 m_itemsQueued(0),
+		 m_framesDone(0)
+	{
+		LOGI("NullRenderer constructor");
+	}
+
+	status NullRenderer::create()
+	{
+		LOGI("NullRenderer::create [canvas: %d x %d, assets: %s]",
+				m_canvasWidth, m_canvasHeight, m_assetsPath.c_str());
+
+		if(m_canvasWidth <= 0 || m_canvasHeight <= 0)
+		{
+			LOGE("invalid canvas size");
+			return STATUS_KO;
+		}
+
+		return STATUS_OK;
+	}
+
+	void NullRenderer::destroy()
+	{
+		LOGI("NullRenderer::destroy [frames: %d]", m_framesDone);
+	}
+
+	void NullRenderer::clearCanvas(float r, float g, float b)
+	{
+
+	}
+
+	void NullRenderer::beginDraw()
+	{
+		m_itemsQueued = 0;
+	}
+
+	status NullRenderer::endDraw()
+	{
+		LOGD_LOOP("NullRenderer::endDraw [items: %d]", m_itemsQueued);
+
+		m_framesDone++;
+
+		return STATUS_OK;
+	}
+
+	void NullRenderer::render(const RenderQueueItem& item)
+	{
+		m_itemsQueued++;
+	}
+
+	int32_t NullRenderer::getCanvasWidth() const
+	{
+		return m_canvasWidth;
+	}
+
+	int32_t NullRenderer::getCanvasHeight() const
+	{
+		return m_canvasHeight;
+	}
+
+	Texture* NullRenderer::createTexture(const std::string& path)
+	{
+		return new Texture(makePath(path));
+	}
+
+	Atlas* NullRenderer::createAtlas(const std::string& path)
+	{
+		return new Atlas(makePath(path));
+	}
+
+	void NullRenderer::setWorldMatrix(const Matrix4x4& mat)
+	{
+
+	}
+
+	void NullRenderer::setViewMatrix(const Matrix4x4& mat)
+	{
+
+	}
+
+	void NullRenderer::setProjectionMatrix(const Matrix4x4& mat)
+	{
+
+	}
+
+	std::string NullRenderer::makePath(const std::string& path) const
+	{
+		if(m_assetsPath.empty())
+		{
+			return path;
+		}
+
+		return m_assetsPath + "/" + path;
+	}
+}
+
+#endif //PEGAS_USE_NULL_GFX
@@ -7,22 +7,25 @@
 namespace pegas
 {
 	//-----------------------------------------------------------------------------
-	//	SceneManager class implementation
+	//	SpatialSceneManager class implementation
 	//-----------------------------------------------------------------------------
-	SceneManager::SceneManager()
-		:m_quadTree()
+	template<typename SpatialIndex>
+	SpatialSceneManager<SpatialIndex>::SpatialSceneManager()
+		:m_spatialIndex(), m_staticTreeDirty(false)
 	{
 		LOGD_LOOP("SceneManager constructor");
 	}
 
-	SceneManager::~SceneManager()
+	template<typename SpatialIndex>
+	SpatialSceneManager<SpatialIndex>::~SpatialSceneManager()
 	{
 		LOGD_LOOP("SceneManager destructor");
 
 		destroy();
 	}
 
-	void SceneManager::create(const Rect2D& worldArea)
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::create(const Rect2D& worldArea)
 	{
 		LOGD_LOOP("SceneManager::create [worldArea: x1 = %0.2f, y1 = %0.2f, x2 = %0.2f, y2 = %0.2f]",
 				worldArea._topLeft._x, worldArea._topLeft._y,
@@ -31,100 +34,245 @@ namespace pegas
 		LOGD_LOOP("setup listener");
 		m_rootNode.addListener(this);
 
-		LOGD_LOOP("setup quad tree");
-		m_quadTree.create(worldArea);
+		LOGD_LOOP("setup spatial index");
+		m_spatialIndex.create(worldArea);
+
+		m_staticRootNode.addListener(this);
+		m_staticTree.create(worldArea);
 	}
 
-	void SceneManager::destroy()
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::destroy()
 	{
 		LOGD_LOOP("SceneManager::destroy");
 
-		m_quadTree.destroy();
+		m_spatialIndex.destroy();
 		m_rootNode.removeAllChilds(true);
+
+		m_staticTree.destroy();
+		m_staticRootNode.removeAllChilds(true);
+		m_staticTreeDirty = false;
+
+		//     
+		publishSnapshot();
 	}
 
-	SceneNode* SceneManager::getRootNode()
+	template<typename SpatialIndex>
+	SceneNode* SpatialSceneManager<SpatialIndex>::getRootNode()
 	{
 		return &m_rootNode;
 	}
 
-	void SceneManager::render(Gfx* gfx, const Rect2D& rect)
+	template<typename SpatialIndex>
+	SceneNode* SpatialSceneManager<SpatialIndex>::getStaticRootNode()
+	{
+		return &m_staticRootNode;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::render(Gfx* gfx, const Rect2D& rect)
 	{
-		std::list<SceneNode*> nodesToRender;
-		m_quadTree.query(rect, nodesToRender);
+		m_nodesToRender.clear();
+		query(rect, m_nodesToRender);
 
-		LOGD_LOOP("nodes to render = %d", nodesToRender.size());
+		LOGD_LOOP("nodes to render = %d", m_nodesToRender.size());
 
-		for(std::list<SceneNode*>::iterator it = nodesToRender.begin();
-				it != nodesToRender.end(); ++it)
+		for(std::vector<SceneNode*>::iterator it = m_nodesToRender.begin();
+				it != m_nodesToRender.end(); ++it)
 		{
 			(*it)->render(gfx);
 		}
 	}
 
-	void SceneManager::query(const Rect2D& rect, std::list<SceneNode*>& result)
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::query(const Rect2D& rect, std::list<SceneNode*>& result)
+	{
+		buildStaticTree();
+		m_staticTree.query(rect, result);
+		m_spatialIndex.query(rect, result);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::query(const Point2D& point, std::list<SceneNode*>& result)
+	{
+		buildStaticTree();
+		m_staticTree.query(point, result);
+		m_spatialIndex.query(point, result);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::query(const Rect2D& rect, std::vector<SceneNode*>& result)
+	{
+		buildStaticTree();
+		m_staticTree.query(rect, result);
+		m_spatialIndex.query(rect, result);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::query(const Point2D& point, std::vector<SceneNode*>& result)
 	{
-		m_quadTree.query(rect, result);
+		buildStaticTree();
+		m_staticTree.query(point, result);
+		m_spatialIndex.query(point, result);
 	}
 
-	void SceneManager::query(const Point2D& point, std::list<SceneNode*>& result)
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::publishSnapshot()
 	{
-		m_quadTree.query(point, result);
+		buildStaticTree();
+
+		//   ,       
+		uint32 version = m_spatialIndex.getVersion() + m_staticTree.getVersion();
+		if(m_snapshots.getPublished().getVersion() == version)
+		{
+			return;
+		}
+
+		LOGD_LOOP("publishing scene snapshot [version: %d]", version);
+
+		Snapshot& snapshot = m_snapshots.beginPublish();
+		snapshot.clear(version);
+		m_staticTree.appendToSnapshot(snapshot);
+		m_spatialIndex.appendToSnapshot(snapshot);
+		m_snapshots.endPublish();
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::buildStaticTree()
+	{
+		if(!m_staticTreeDirty)
+		{
+			return;
+		}
+
+		LOGD_LOOP("building static tree [nodes: %d]", m_staticNodes.size());
+
+		m_staticTree.removeAllObjects();
+		for(std::vector<SceneNode*>::iterator it = m_staticNodes.begin();
+				it != m_staticNodes.end(); ++it)
+		{
+			m_staticTree.insertObject(*it, (*it)->getBoundBox());
+		}
+		m_staticTree.build();
+
+		m_staticTreeDirty = false;
 	}
 
-	void SceneManager::onTransfromChanged(SceneNode* sender)
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::removeStaticNode(SceneNode* node)
+	{
+		std::vector<SceneNode*>::iterator it = std::find(m_staticNodes.begin(), m_staticNodes.end(), node);
+		if(it != m_staticNodes.end())
+		{
+			m_staticNodes.erase(it);
+			m_staticTreeDirty = true;
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::onTransfromChanged(SceneNode* sender)
 	{
 		LOGD_LOOP("SceneManager::onTransfromChanged [sender = 0x%X]");
 
+		if(sender->getParentNode() == &m_staticRootNode)
+		{
+			m_staticTreeDirty = true;
+			return;
+		}
+
 		Rect2D newAABB = sender->getBoundBox();
 		LOGD_LOOP("AABB: x1: %.2f, y1: %.2f, x2: %.2f, y2: %.2f", newAABB._topLeft._x,
 				newAABB._topLeft._y, newAABB._bottomRight._x, newAABB._bottomRight._y);
 
-		bool r1 = m_quadTree.removeObject(sender);
-		if(r1)
+		SpatialHandle handle = sender->getSpatialHandle();
+		bool r;
+		if(m_spatialIndex.isValidHandle(handle))
 		{
-			LOGD_LOOP("previous QuadTreeNode removed");
+			r = m_spatialIndex.updateObject(handle, newAABB);
 		}else
 		{
-			LOGD_LOOP("previous QuadTreeNode not removed");
+			handle = m_spatialIndex.insertObject(sender, newAABB);
+			r = (handle != k_invalidSpatialHandle);
 		}
+		sender->setSpatialHandle(handle);
 
-		bool r2 = m_quadTree.insertObject(sender, newAABB);
-		if(r2)
+		if(r)
 		{
-			LOGD_LOOP("new QuadTreeNode inserted");
+			LOGD_LOOP("spatial index updated");
 		}else
 		{
-			LOGD_LOOP("new QuadTreeNode not inserted");
+			LOGD_LOOP("spatial index not updated");
 		}
 	}
 
-	void SceneManager::onNodeRemoved(SceneNode* sender)
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::onNodeRemoved(SceneNode* sender)
 	{
 		LOGD_LOOP("SceneManager::onNodeRemoved [sender = 0x%X]", sender);
 
-		bool r = m_quadTree.removeObject(sender);
+		if(sender->getParentNode() == &m_staticRootNode)
+		{
+			removeStaticNode(sender);
+			return;
+		}
+
+		SpatialHandle handle = sender->getSpatialHandle();
+		bool r = m_spatialIndex.removeObject(handle);
+		sender->setSpatialHandle(handle);
+
 		if(r)
 		{
-			LOGD_LOOP("previous QuadTreeNode removed");
+			LOGD_LOOP("removed from spatial index");
 		}else
 		{
-			LOGD_LOOP("previous QuadTreeNode not removed");
+			LOGD_LOOP("not removed from spatial index");
 		}
 	}
 
-	void SceneManager::onChildAttach(SceneNode* sender, SceneNode* child)
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::onChildAttach(SceneNode* sender, SceneNode* child)
 	{
 		LOGD_LOOP("SceneManager::onChildAttach [sender = 0x%X, child = 0x%X]", sender, child);
+
 		child->addListener(this);
+
+		if(sender == &m_staticRootNode)
+		{
+			m_staticNodes.push_back(child);
+			m_staticTreeDirty = true;
+			return;
+		}
+
 		onTransfromChanged(child);
 	}
 
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::onChildDettach(SceneNode* sender, SceneNode* child)
+	{
+		if(sender == &m_staticRootNode)
+		{
+			removeStaticNode(child);
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialSceneManager<SpatialIndex>::onChildRemove(SceneNode* sender, SceneNode* child)
+	{
+		if(sender == &m_staticRootNode)
+		{
+			removeStaticNode(child);
+		}
+	}
+
+	//   ,    
+	template class SpatialSceneManager<SMQuadTree>;
+	template class SpatialSceneManager<SMAABBTree>;
+
 	//-----------------------------------------------------------------------------
 	//	SceneNode class implementation
 	//-----------------------------------------------------------------------------
 	SceneNode::SceneNode(SceneNode* parentNode)
-		:m_parentNode(parentNode), m_zIndex(1.0f)
+		:m_parentNode(parentNode), m_zIndex(1.0f), m_spatialHandle(k_invalidSpatialHandle)
 	{
 		LOGD_LOOP("SceneNode constructor [this: 0x%X]", this);
 
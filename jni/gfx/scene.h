@@ -9,6 +9,7 @@
 #define PEGAS_SCENE_2D_H_
 
 #include "../core/includes.h"
+#include "../system/snapshot_buffer.h"
 
 namespace pegas
 {
@@ -47,6 +48,10 @@ namespace pegas
 		void setZIndex(float zIndex) { m_zIndex = zIndex; }
 		float getZIndex() const { return m_zIndex; }
 
+		//     SceneManager
+		void setSpatialHandle(SpatialHandle handle) { m_spatialHandle = handle; }
+		SpatialHandle getSpatialHandle() const { return m_spatialHandle; }
+
 		virtual void render(Gfx* gfx);
 		virtual Rect2D getBoundBox();
 
@@ -71,39 +76,75 @@ namespace pegas
 		ChildNodeList m_childsNodes;
 		Matrix4x4 m_transform;
 		float	  m_zIndex;
+		SpatialHandle m_spatialHandle;
 
 	private:
 		SceneNode(const SceneNode& other);
 		SceneNode& operator=(const SceneNode& other);
 	};
 
-	class SceneManager: public SceneNodeEventListener
+	//	     SpatialIndex (QuadTree, AABBTree - .
+	//	spatial_index.h),   -  LinearQuadTree
+	template<typename SpatialIndex>
+	class SpatialSceneManager: public SceneNodeEventListener
 	{
 	public:
-		SceneManager();
-		virtual ~SceneManager();
+		typedef SpatialSnapshot<SceneNode*> Snapshot;
+
+		SpatialSceneManager();
+		virtual ~SpatialSceneManager();
 
 		void create(const Rect2D& worldArea);
 		void destroy();
 
 		SceneNode* getRootNode();
+		// :       LinearQuadTree, 
+		//      , 
+		//    
+		SceneNode* getStaticRootNode();
 		void render(Gfx* gfx, const Rect2D& rect);
 		void query(const Rect2D& rect, std::list<SceneNode*>& result);
 		void query(const Point2D& point, std::list<SceneNode*>& result);
+		void query(const Rect2D& rect, std::vector<SceneNode*>& result);
+		void query(const Point2D& point, std::vector<SceneNode*>& result);
+
+		//      :     
+		//,     acquireSnapshot  
+		//releaseSnapshot.     : ,    
+		//,  ,      
+		void publishSnapshot();
+		const Snapshot* acquireSnapshot() { return m_snapshots.acquire(); }
+		void releaseSnapshot(const Snapshot* snapshot) { m_snapshots.release(snapshot); }
 
 		virtual void onTransfromChanged(SceneNode* sender);
 		virtual void onNodeRemoved(SceneNode* sender);
 		virtual void onChildAttach(SceneNode* sender, SceneNode* child);
+		virtual void onChildDettach(SceneNode* sender, SceneNode* child);
+		virtual void onChildRemove(SceneNode* sender, SceneNode* child);
 	private:
-		typedef QuadTree<SceneNode*, SceneNode*> SMQuadTree;
+		typedef LinearQuadTree<SceneNode*> SMStaticTree;
 
-		SMQuadTree m_quadTree;
+		void removeStaticNode(SceneNode* node);
+		void buildStaticTree();
+
+		SpatialIndex m_spatialIndex;
 		SceneNode  m_rootNode;
+		SMStaticTree m_staticTree;
+		SceneNode  m_staticRootNode;
+		std::vector<SceneNode*> m_staticNodes;
+		bool	   m_staticTreeDirty;
+		// ,      
+		std::vector<SceneNode*> m_nodesToRender;
+		SnapshotBuffer<Snapshot> m_snapshots;
 
 	private:
-		SceneManager(const SceneManager& other);
-		SceneManager& operator=(const SceneManager& other);
+		SpatialSceneManager(const SpatialSceneManager& other);
+		SpatialSceneManager& operator=(const SpatialSceneManager& other);
 	};
+
+	typedef QuadTree<SceneNode*, QTLooseBoundsPolicy<125> > SMQuadTree;
+	typedef AABBTree<SceneNode*> SMAABBTree;
+	typedef SpatialSceneManager<SMQuadTree> SceneManager;
 }
 
 #endif /* SCENE_2D_H_ */
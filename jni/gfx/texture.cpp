@@ -5,11 +5,19 @@
 
 namespace pegas
 {
+#ifdef ANDROID
 	Texture::Texture(android_app* application, const std::string& path)
 		:m_resource(application, path), m_textureId(0)
 	{
 		LOGI("Texture constructor");
 	}
+#else
+	Texture::Texture(const std::string& path)
+		:m_resource(path), m_textureId(0)
+	{
+		LOGI("Texture constructor");
+	}
+#endif
 
 	Texture::~Texture()
 	{
@@ -29,8 +37,7 @@ namespace pegas
 			return STATUS_KO;
 		}
 
-		GLenum errorResult;
-
+#ifdef PEGAS_USE_GLES_1x
 		glGenTextures(1, &m_textureId);
 		glBindTexture(GL_TEXTURE_2D, m_textureId);
 
@@ -50,6 +57,10 @@ namespace pegas
 
 			return STATUS_KO;
 		}
+#else
+		//null renderer: only image size and format are kept
+		delete[] imageBuffer;
+#endif
 
 		LOGI("texture succefully created, texture ID: %d", m_textureId);
 
@@ -62,7 +73,9 @@ namespace pegas
 
 		if(m_textureId != 0)
 		{
+#ifdef PEGAS_USE_GLES_1x
 			glDeleteTextures(1, &m_textureId);
+#endif
 			m_textureId = 0;
 		}
 
@@ -73,8 +86,10 @@ namespace pegas
 
 	void Texture::apply()
 	{
+#ifdef PEGAS_USE_GLES_1x
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, m_textureId);
+#endif
 	}
 
 	uint8_t* Texture::loadImage()
@@ -9,7 +9,11 @@ namespace pegas
 	class Texture
 	{
 	public:
+#ifdef ANDROID
 		Texture(android_app* application, const std::string& path);
+#else
+		Texture(const std::string& path);
+#endif
 		virtual ~Texture();
 
 		int32_t getHeight() const { return m_width; }
@@ -25,7 +29,11 @@ namespace pegas
 	private:
 		static void callback_read(png_structp pngStruct, png_bytep data, png_size_t size);
 
+#ifdef ANDROID
 		AssetResource m_resource;
+#else
+		FileResource m_resource;
+#endif
 		GLuint m_textureId;
 		GLint m_format;
 		int32_t m_width;
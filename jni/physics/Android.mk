@@ -12,6 +12,8 @@ LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
 LOCAL_EXPORT_LDLIBS    := -llog -landroid -lEGL -lGLESv1_CM
 LOCAL_STATIC_LIBRARIES := android_native_app_glue png
 #LOCAL_CFLAGS := -g -ggdb -O0
+#vector and scalar collision kernels must round the same way
+LOCAL_CFLAGS += -ffp-contract=off
 
 include $(BUILD_STATIC_LIBRARY)
 $(call import-module, android/native_app_glue)
@@ -4,22 +4,420 @@
 
 namespace pegas
 {
+	namespace
+	{
+		//visitor for the grid and quadtree casts: keeps the nearest hit
+		//and shrinks the cast distance, so farther cells and nodes are skipped
+		class HullCaster
+		{
+		public:
+			HullCaster(const CollisionCasts::Ray& ray, uint32 groupMask)
+				:m_ray(ray), m_layerRay(ray), m_groupMask(groupMask), m_id(-1) {}
+
+			//hulls of the next tree are stored shifted by shift from the world,
+			//a translation changes neither the distance nor the normal of a hit
+			void setLayerShift(const Vector3& shift)
+			{
+				m_layerRay._originX = m_ray._originX - shift._x;
+				m_layerRay._originY = m_ray._originY - shift._y;
+			}
+
+			const CollisionCasts::Ray& getLayerRay() const { return m_layerRay; }
+			float getMaxDistance(float maxDistance) const { return (m_id < 0) ? maxDistance : m_hit._distance; }
+
+			void operator()(ICollisionHull* hull, float& maxDistance)
+			{
+				if(!matchesGroup(m_groupMask, hull->getCollisionGroup()))
+				{
+					return;
+				}
+
+				CollisionCasts::Hit hit;
+				if(!CollisionCasts::castHull(hull, m_layerRay, maxDistance, hit))
+				{
+					return;
+				}
+
+				if(isCloser(hit._distance, hull->getId(), m_hit._distance, m_id))
+				{
+					m_id = hull->getId();
+					m_hit = hit;
+					maxDistance = hit._distance;
+				}
+			}
+
+			void operator()(const IPhysics::CollisionHullPtr& hull, float& maxDistance)
+			{
+				(*this)(hull.get(), maxDistance);
+			}
+
+			bool getResult(IPhysics::CastHit& result) const
+			{
+				if(m_id < 0)
+				{
+					return false;
+				}
+
+				CollisionCasts::makeCastHit(m_id, m_ray, m_hit, result);
+
+				return true;
+			}
+
+			//groups outside of the mask range are matched by k_allGroups only
+			static bool matchesGroup(uint32 groupMask, int32 group)
+			{
+				if(!CollisionFilter::isValidGroup(group))
+				{
+					return groupMask == (uint32)IPhysics::k_allGroups;
+				}
+
+				return (groupMask & CollisionFilter::getBit(group)) != 0;
+			}
+
+			//hits at the same distance are resolved by id, so every implementation
+			//reports the same hull whatever order it visits them in
+			static bool isCloser(float distance, int32 id, float bestDistance, int32 bestId)
+			{
+				return bestId < 0 || distance < bestDistance || (distance == bestDistance && id < bestId);
+			}
+
+		private:
+			CollisionCasts::Ray m_ray;
+			CollisionCasts::Ray m_layerRay;
+			uint32 m_groupMask;
+			int32 m_id;
+			CollisionCasts::Hit m_hit;
+		};
+
+		//the same for hulls of CollisionWorld by their dense indices
+		class WorldCaster
+		{
+		public:
+			WorldCaster(const CollisionWorld& world, const CollisionCasts::Ray& ray, uint32 groupMask)
+				:m_world(world), m_ray(ray), m_groupMask(groupMask), m_index(-1) {}
+
+			void operator()(int32 index, float& maxDistance)
+			{
+				if(!HullCaster::matchesGroup(m_groupMask, m_world.getGroup(index)))
+				{
+					return;
+				}
+
+				CollisionCasts::Hit hit;
+				if(!m_world.castHull(index, m_ray, maxDistance, hit))
+				{
+					return;
+				}
+
+				if(HullCaster::isCloser(hit._distance, m_world.getId(index), m_hit._distance,
+						(m_index < 0) ? -1 : m_world.getId(m_index)))
+				{
+					m_index = index;
+					m_hit = hit;
+					maxDistance = hit._distance;
+				}
+			}
+
+			bool getResult(IPhysics::CastHit& result) const
+			{
+				if(m_index < 0)
+				{
+					return false;
+				}
+
+				CollisionCasts::makeCastHit(m_world.getId(m_index), m_ray, m_hit, result);
+
+				return true;
+			}
+
+		private:
+			const CollisionWorld& m_world;
+			CollisionCasts::Ray m_ray;
+			uint32 m_groupMask;
+			int32 m_index;
+			CollisionCasts::Hit m_hit;
+		};
+
+		//a point or circle moving farther than this part of its radius during
+		//one update is swept from its previous position to the current one,
+		//so a long frame does not let it pass through a thin hull
+		const float k_sweepFraction = 0.5f;
+
+		//sweep of a circle from (fromX, fromY) to (toX, toY) as a circle cast,
+		//false if the circle moved too little to need one
+		bool makeSweepRay(float fromX, float fromY, float toX, float toY, float radius,
+				CollisionCasts::Ray& ray, float& length)
+		{
+			float offsetX = toX - fromX;
+			float offsetY = toY - fromY;
+
+			length = sqrt((offsetX * offsetX) + (offsetY * offsetY));
+			if(length == 0.0f || length <= (k_sweepFraction * radius))
+			{
+				return false;
+			}
+
+			ray._originX = fromX;
+			ray._originY = fromY;
+			ray._directionX = offsetX / length;
+			ray._directionY = offsetY / length;
+			ray._radius = radius;
+
+			return true;
+		}
+
+		bool makeSweepRay(PointCollisionHull* hull, CollisionCasts::Ray& ray, float& length)
+		{
+			if(!hull->hasPreviousPosition())
+			{
+				return false;
+			}
+
+			float radius = (hull->getType() == ICollisionHull::k_typeCircle)
+					? static_cast<CircleCollisionHull*>(hull)->getRadius() : 0.0f;
+			const Vector3& from = hull->getPreviousPosition();
+			const Vector3& to = hull->getCurrentPosition();
+
+			return makeSweepRay(from._x, from._y, to._x, to._y, radius, ray, length);
+		}
+
+		//visitor for the grid and quadtree sweeps: collects every hull the swept
+		//circle touches on its way, the sweep length is never shortened
+		class HullSweeper
+		{
+		public:
+			HullSweeper(ICollisionHull* hull, const CollisionCasts::Ray& ray, float length,
+					std::vector<ICollisionHull*>& hits)
+				:m_hull(hull), m_ray(ray), m_layerRay(ray), m_length(length), m_hits(hits) {}
+
+			//the sweep ray is given in the layer of the swept hull,
+			//hulls of the next tree are stored shifted by shift from it
+			void setLayerShift(const Vector3& shift)
+			{
+				m_layerRay._originX = m_ray._originX - shift._x;
+				m_layerRay._originY = m_ray._originY - shift._y;
+			}
+
+			const CollisionCasts::Ray& getLayerRay() const { return m_layerRay; }
+			float getMaxDistance(float maxDistance) const { return maxDistance; }
+
+			void operator()(ICollisionHull* other, float& maxDistance)
+			{
+				CollisionCasts::Hit hit;
+				if(other != m_hull && CollisionCasts::castHull(other, m_layerRay, m_length, hit))
+				{
+					m_hits.push_back(other);
+				}
+			}
+
+			void operator()(const IPhysics::CollisionHullPtr& other, float& maxDistance)
+			{
+				(*this)(other.get(), maxDistance);
+			}
+
+		private:
+			ICollisionHull* m_hull;
+			CollisionCasts::Ray m_ray;
+			CollisionCasts::Ray m_layerRay;
+			float m_length;
+			std::vector<ICollisionHull*>& m_hits;
+		};
+
+		//visitor for the quadtree queries of the broadphase: collects the hulls
+		//the querying hull may collide with (by collision group), except itself
+		class HullCollector
+		{
+		public:
+			HullCollector(ICollisionHull* hull, uint32 collisionMask, std::vector<ICollisionHull*>& result)
+				:m_hull(hull), m_collisionMask(collisionMask), m_result(result) {}
+
+			void operator()(const IPhysics::CollisionHullPtr& other)
+			{
+				ICollisionHull* hull = other.get();
+
+				//,     
+				// hullA  hullB (   )
+				if(hull != m_hull && (m_collisionMask & CollisionFilter::getBit(hull->getCollisionGroup())) != 0)
+				{
+					m_result.push_back(hull);
+				}
+			}
+
+		private:
+			ICollisionHull* m_hull;
+			uint32 m_collisionMask;
+			std::vector<ICollisionHull*>& m_result;
+		};
+
+		//the same for hulls of CollisionWorld by their dense indices
+		class WorldSweeper
+		{
+		public:
+			WorldSweeper(const CollisionWorld& world, int32 index, const CollisionCasts::Ray& ray, float length,
+					std::vector<int32>& hits)
+				:m_world(world), m_index(index), m_ray(ray), m_length(length), m_hits(hits) {}
+
+			void operator()(int32 other, float& maxDistance)
+			{
+				CollisionCasts::Hit hit;
+				if(other != m_index && m_world.castHull(other, m_ray, m_length, hit))
+				{
+					m_hits.push_back(other);
+				}
+			}
+
+		private:
+			const CollisionWorld& m_world;
+			int32 m_index;
+			CollisionCasts::Ray m_ray;
+			float m_length;
+			std::vector<int32>& m_hits;
+		};
+
+		bool isZero(const Vector3& offset)
+		{
+			return offset._x == 0.0f && offset._y == 0.0f;
+		}
+
+		bool isPointHull(ICollisionHull* hull)
+		{
+			int32 type = hull->getType();
+
+			return type == ICollisionHull::k_typePoint || type == ICollisionHull::k_typeCircle;
+		}
+
+		//circle/circle pairs gathered for CollisionKernels::circleCircle, circle b
+		//is moved by shift; every pair carries a tag given back for its hit
+		class CirclePairBatch
+		{
+		public:
+			CirclePairBatch(): m_count(0) {}
+
+			bool isEmpty() const { return m_count == 0; }
+			bool isFull() const { return m_count == CollisionKernels::k_batchSize; }
+
+			void add(ICollisionHull* a, ICollisionHull* b, const Vector3& shift, int32 tag)
+			{
+				assert(!isFull() && "circle batch is full");
+
+				const CircleCollisionHull* circleA = static_cast<const CircleCollisionHull*>(a);
+				const CircleCollisionHull* circleB = static_cast<const CircleCollisionHull*>(b);
+				const Vector3& positionA = circleA->getCurrentPosition();
+				const Vector3& positionB = circleB->getCurrentPosition();
+
+				m_ax[m_count] = positionA._x;
+				m_ay[m_count] = positionA._y;
+				m_ar[m_count] = circleA->getRadius();
+				m_bx[m_count] = positionB._x + shift._x;
+				m_by[m_count] = positionB._y + shift._y;
+				m_br[m_count] = circleB->getRadius();
+				m_tags[m_count] = tag;
+				m_count++;
+			}
+
+			//tests the gathered pairs and empties the batch,
+			//hitTags gets the tags of the intersecting ones
+			int32 flush(int32* hitTags)
+			{
+				CollisionKernels::circleCircle(m_ax, m_ay, m_ar, m_bx, m_by, m_br, m_count, m_results);
+
+				int32 numHits = 0;
+				for(int32 i = 0; i < m_count; i++)
+				{
+					if(m_results[i] != 0)
+					{
+						hitTags[numHits++] = m_tags[i];
+					}
+				}
+				m_count = 0;
+
+				return numHits;
+			}
+
+		private:
+			float m_ax[CollisionKernels::k_batchSize];
+			float m_ay[CollisionKernels::k_batchSize];
+			float m_ar[CollisionKernels::k_batchSize];
+			float m_bx[CollisionKernels::k_batchSize];
+			float m_by[CollisionKernels::k_batchSize];
+			float m_br[CollisionKernels::k_batchSize];
+			int32 m_tags[CollisionKernels::k_batchSize];
+			uint8 m_results[CollisionKernels::k_batchSize];
+			int32 m_count;
+		};
+
+		//hits of the batch go to the keys list by the candidates the tags index
+		template<typename CandidateList, typename KeyList>
+		void flushCirclePairs(CirclePairBatch& batch, const CandidateList& candidates, KeyList& hits)
+		{
+			int32 hitTags[CollisionKernels::k_batchSize];
+			int32 numHits = batch.flush(hitTags);
+			for(int32 i = 0; i < numHits; i++)
+			{
+				hits.push_back(candidates[hitTags[i]]._key);
+			}
+		}
+
+		bool isCirclePair(ICollisionHull* a, ICollisionHull* b)
+		{
+			return a->getType() == ICollisionHull::k_typeCircle && b->getType() == ICollisionHull::k_typeCircle;
+		}
+
+		//a hull of a scroll layer is stored at its layer position plus the layer
+		//base (see ScrollLayers): absolute positions are given in the layer
+		void moveHull(ICollisionHull* hull, const Vector3& offset, bool absolute, const Vector3& base)
+		{
+			hull->moveObject(offset, absolute);
+			if(absolute && !isZero(base))
+			{
+				hull->moveObject(base, false);
+			}
+		}
+
+		void rotateHull(ICollisionHull* hull, float degreesOffset, bool absolute, const Vector3& base)
+		{
+			if(isZero(base))
+			{
+				hull->rotateObject(degreesOffset, absolute);
+				return;
+			}
+
+			//rotation about the layer origin
+			if(!absolute)
+			{
+				hull->moveObject(Vector3(-base._x, -base._y, -base._z), false);
+			}
+			hull->rotateObject(degreesOffset, absolute);
+			hull->moveObject(base, false);
+		}
+
+		void transformHull(ICollisionHull* hull, const Matrix4x4& m, const Vector3& base)
+		{
+			hull->transformObject(m);
+			if(!isZero(base))
+			{
+				hull->moveObject(base, false);
+			}
+		}
+
+		//moves the hull with its coordinate frame: the previous position
+		//goes along, so the move is not swept
+		void offsetHull(ICollisionHull* hull, const Vector3& offset)
+		{
+			hull->moveObject(offset, false);
+			if(isPointHull(hull))
+			{
+				static_cast<PointCollisionHull*>(hull)->offsetPreviousPosition(offset);
+			}
+		}
+	}
+
 	//--------------------------------------------------------------------------------------------------------
 	//	BasePhysics implementation
 	//--------------------------------------------------------------------------------------------------------
 	BasePhysics::BasePhysics()
 	{
-		m_checkers[ICollisionHull::k_typePoint][ICollisionHull::k_typePoint] = &Intersections::isIntersectsPointPoint;
-		m_checkers[ICollisionHull::k_typePoint][ICollisionHull::k_typeCircle] = &Intersections::isIntersectsPointCircle;
-		m_checkers[ICollisionHull::k_typePoint][ICollisionHull::k_typePolygon] = &Intersections::isIntersectsPointPolygon;
-
-		m_checkers[ICollisionHull::k_typeCircle][ICollisionHull::k_typePoint] = &Intersections::isIntersectsCirclePoint;
-		m_checkers[ICollisionHull::k_typeCircle][ICollisionHull::k_typeCircle] = &Intersections::isIntersectsCircleCircle;
-		m_checkers[ICollisionHull::k_typeCircle][ICollisionHull::k_typePolygon] = &Intersections::isIntersectsCirclePolygon;
 
-		m_checkers[ICollisionHull::k_typePolygon][ICollisionHull::k_typePoint] = &Intersections::isIntersectsPolygonPoint;
-		m_checkers[ICollisionHull::k_typePolygon][ICollisionHull::k_typeCircle] = &Intersections::isIntersectsPolygonCircle;
-		m_checkers[ICollisionHull::k_typePolygon][ICollisionHull::k_typePolygon] = &Intersections::isIntersectsPolygonPolygon;
 	}
 
 	BasePhysics::~BasePhysics()
@@ -29,20 +427,66 @@ namespace pegas
 
 	void BasePhysics::create(const Rect2D& worldSize)
 	{
-		m_cellGrid.create(worldSize.width(), worldSize.height(), 250);
+		//the grid is not bounded by the world, its size only picks the number of buckets
+		int32 numCells = (int32)(ceil(worldSize.width() / k_cellLength) * ceil(worldSize.height() / k_cellLength));
+		int32 numBuckets = std::max((int32)k_minBuckets, std::min(numCells, (int32)k_maxBuckets));
+
+		m_cellGrid.create(k_cellLength, numBuckets);
+		m_filter.reset();
 	}
 
 	void BasePhysics::destroy()
 	{
 		m_cellGrid.destroy();
+		m_collisionHulls.clear();
+		m_pointHulls.clear();
+		m_contacts.clear();
+		m_layers.clear();
+		m_stats.clear();
+	}
+
+	void BasePhysics::setCollisionGroupFlag(int32 group, bool checkCollisions)
+	{
+		m_filter.setGroupActive(group, checkCollisions);
+	}
+
+	void BasePhysics::setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions)
+	{
+		m_filter.setPairEnabled(groupA, groupB, checkCollisions);
 	}
 
 	bool BasePhysics::isIntersects(ICollisionHull* a, ICollisionHull* b)
 	{
-		int32 aIndex = a->getType();
-		int32 bIndex = b->getType();
+		return Intersections::isIntersects(a, b);
+	}
+
+	bool BasePhysics::castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+			CastHit& hit, uint32 groupMask)
+	{
+		return castCircle(origin, 0.0f, direction, maxDistance, hit, groupMask);
+	}
+
+	bool BasePhysics::castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+			CastHit& hit, uint32 groupMask)
+	{
+		CollisionCasts::Ray ray;
+		if(!CollisionCasts::makeRay(origin, direction, radius, ray))
+		{
+			return false;
+		}
+
+		return cast(ray, maxDistance, hit, groupMask);
+	}
+
+	bool BasePhysics::cast(const CollisionCasts::Ray& ray, float maxDistance, CastHit& hit, uint32 groupMask)
+	{
+		m_stats.getCurrent()._numCasts++;
 
-		return (m_checkers[aIndex][bIndex])(a, b);
+		HullCaster caster(ray, groupMask);
+		m_cellGrid.castRay(Point2D(ray._originX, ray._originY), Point2D(ray._directionX, ray._directionY),
+				ray._radius, maxDistance, caster);
+
+		return caster.getResult(hit);
 	}
 
 	bool BasePhysics::registerPoint(int32 id, int32 group, const Vector3& position)
@@ -56,11 +500,7 @@ namespace pegas
 			return false;
 		}
 
-		CollisionHullPtr hull = new PointCollisionHull(id, group, position);
-		m_collisionHulls[id] = hull;
-		m_cellGrid.placeToGrid(hull->getPosition(), hull.get());
-
-		return true;
+		return addHull(new PointCollisionHull(id, group, position));
 	}
 	
 	bool BasePhysics::registerCircle(int32 id, int32 group, const Vector3& position, float radius)
@@ -74,408 +514,1698 @@ namespace pegas
 			return false;
 		}
 		
+		return addHull(new CircleCollisionHull(id, group, position, radius));
+	}
+	
+	bool BasePhysics::registerPoligon(int32 id, int32 group, const PointList& points)
+	{
+		assert(id > 0);
+		assert(group > 0);
+		assert(m_collisionHulls.count(id) == 0);
+
+		if(m_collisionHulls.count(id) > 0)
+		{
+			return false;
+		}
+
+		return addHull(BoxCollisionHull::isAxisAligned(points)
+				? new BoxCollisionHull(id, group, points) : new PoligonCollisionHull(id, group, points));
+	}
+	
+	bool BasePhysics::registerBox(int32 id, int32 group, const Rect2D& box)
+	{
+		PointList points;
+		BoxCollisionHull::makePoints(box, points);
+
+		return registerPoligon(id, group, points);
+	}
+
+	void BasePhysics::unregisterCollisionHull(int32 id)
+	{
+		//assert(m_collisionHulls.count(id) > 0);
+		
+		HullEntryMap::iterator it = m_collisionHulls.find(id);
+		if(it != m_collisionHulls.end())
+		{
+			m_cellGrid.removeObject(it->second._gridHandle);
+
+			PointHullList::iterator point_it = std::find(m_pointHulls.begin(), m_pointHulls.end(),
+					it->second._hull.get());
+			if(point_it != m_pointHulls.end())
+			{
+				m_pointHulls.erase(point_it);
+			}
+
+			m_collisionHulls.erase(it);
+			m_layers.removeHull(id);
+		}
+	}
 		
-		CollisionHullPtr hull = new CircleCollisionHull(id, group, position, radius);
-		m_collisionHulls[id] = hull;
-		m_cellGrid.placeToGrid(hull->getPosition(), hull.get());
+	void BasePhysics::moveObject(int32 id, const Vector3& offset, bool absolute)
+	{
+		assert(m_collisionHulls.count(id) > 0);
 
-		return true;
+		const HullEntry& entry = m_collisionHulls[id];
+		moveHull(entry._hull.get(), offset, absolute, m_layers.getBase(entry._hull->getScrollLayer()));
+		updateHull(entry);
 	}
 	
-	bool BasePhysics::registerPoligon(int32 id, int32 group, const PointList& points)
+	void BasePhysics::rotateObject(int32 id, float degreesOffset, bool absolute)
+	{
+		assert(m_collisionHulls.count(id) > 0);
+
+		const HullEntry& entry = m_collisionHulls[id];
+		rotateHull(entry._hull.get(), degreesOffset, absolute, m_layers.getBase(entry._hull->getScrollLayer()));
+		updateHull(entry);
+	}
+
+	void BasePhysics::transformObject(int32 id, const Matrix4x4& m)
+	{
+		assert(m_collisionHulls.count(id) > 0);
+
+		const HullEntry& entry = m_collisionHulls[id];
+		transformHull(entry._hull.get(), m, m_layers.getBase(entry._hull->getScrollLayer()));
+		updateHull(entry);
+	}
+
+	int32 BasePhysics::createScrollLayer()
+	{
+		return m_layers.createLayer();
+	}
+
+	void BasePhysics::setScrollLayerOffset(int32 layer, const Vector3& offset)
+	{
+		assert(m_layers.isValidLayer(layer) && layer != ScrollLayers::k_worldLayer);
+
+		if(!m_layers.isValidLayer(layer) || layer == ScrollLayers::k_worldLayer)
+		{
+			return;
+		}
+
+		m_layers.setOffset(layer, offset);
+		if(!m_layers.isShifted(layer))
+		{
+			return;
+		}
+
+		//the grid holds world coordinates, every hull of the layer moves
+		Vector3 shift = m_layers.getShift(layer);
+
+		m_layers.getLayerHulls(layer, m_layerHulls);
+		for(std::vector<int32>::iterator it = m_layerHulls.begin(); it != m_layerHulls.end(); ++it)
+		{
+			const HullEntry& entry = m_collisionHulls[*it];
+			offsetHull(entry._hull.get(), shift);
+			updateHull(entry);
+		}
+
+		m_layers.rebase(layer);
+	}
+
+	Vector3 BasePhysics::getScrollLayerOffset(int32 layer)
+	{
+		return m_layers.isValidLayer(layer) ? m_layers.getOffset(layer) : Vector3();
+	}
+
+	bool BasePhysics::attachToScrollLayer(int32 id, int32 layer)
 	{
+		HullEntryMap::iterator it = m_collisionHulls.find(id);
+		if(it == m_collisionHulls.end() || !m_layers.isValidLayer(layer))
+		{
+			return false;
+		}
+
+		Vector3 offset = m_layers.getBase(layer) - m_layers.getBase(it->second._hull->getScrollLayer());
+		if(!isZero(offset))
+		{
+			offsetHull(it->second._hull.get(), offset);
+			updateHull(it->second);
+		}
+
+		m_layers.setHullLayer(id, layer);
+		it->second._hull->setScrollLayer(layer);
+
+		return true;
+	}
+		
+	void BasePhysics::update()
+	{
+		IPhysics::Stats& stats = m_stats.getCurrent();
+		m_stats.beginUpdate();
+
+		m_contacts.beginUpdate();
+
+		//every pair with overlapping AABBs comes from the grid exactly once
+		m_cellGrid.findPairs(m_gridPairs);
+		m_stats.endPhase(Stats::k_phaseBroadphase);
+
+		//circle/circle pairs go to the batched kernel,
+		//the contacts are added in the order of the pairs after it
+		int32 numPairs = m_gridPairs.size();
+		m_gridHits.assign(numPairs, 0);
+
+		CirclePairBatch circlePairs;
+		int32 hitTags[CollisionKernels::k_batchSize];
+		for(int32 i = 0; i < numPairs; i++)
+		{
+			ICollisionHull* a = m_gridPairs[i].first;
+			ICollisionHull* b = m_gridPairs[i].second;
+
+			if(!m_filter.shouldCollide(a->getCollisionGroup(), b->getCollisionGroup()))
+			{
+				continue;
+			}
+
+			stats._numCandidatePairs++;
+			m_stats.addTest(a->getType(), b->getType());
+
+			if(isCirclePair(a, b))
+			{
+				circlePairs.add(a, b, Vector3(), i);
+				if(circlePairs.isFull())
+				{
+					int32 numHits = circlePairs.flush(hitTags);
+					for(int32 j = 0; j < numHits; j++)
+					{
+						m_gridHits[hitTags[j]] = 1;
+					}
+				}
+			}else
+			{
+				m_gridHits[i] = Intersections::isIntersects(a, b) ? 1 : 0;
+			}
+		}
+
+		int32 numHits = circlePairs.flush(hitTags);
+		for(int32 j = 0; j < numHits; j++)
+		{
+			m_gridHits[hitTags[j]] = 1;
+		}
+
+		for(int32 i = 0; i < numPairs; i++)
+		{
+			if(m_gridHits[i] != 0)
+			{
+				stats._numHits++;
+				m_contacts.addContact(m_gridPairs[i].first->getId(), m_gridPairs[i].second->getId());
+			}
+		}
+		m_stats.endPhase(Stats::k_phaseNarrowphase);
+
+		sweepPointHulls();
+		m_stats.endPhase(Stats::k_phaseSweep);
+
+		m_contacts.endUpdate();
+		m_stats.endPhase(Stats::k_phaseContacts);
+
+		m_stats.endUpdate(m_collisionHulls.size());
+	}
+
+	void BasePhysics::sweepPointHulls()
+	{
+		for(PointHullList::iterator it = m_pointHulls.begin(); it != m_pointHulls.end(); ++it)
+		{
+			PointCollisionHull* hull = *it;
+
+			CollisionCasts::Ray ray;
+			float length;
+			if(makeSweepRay(hull, ray, length))
+			{
+				m_sweepHits.clear();
+				m_stats.getCurrent()._numSweeps++;
+
+				HullSweeper sweeper(hull, ray, length, m_sweepHits);
+				m_cellGrid.castRay(Point2D(ray._originX, ray._originY), Point2D(ray._directionX, ray._directionY),
+						ray._radius, length, sweeper);
+
+				for(HullList::iterator hit_it = m_sweepHits.begin(); hit_it != m_sweepHits.end(); ++hit_it)
+				{
+					if(m_filter.shouldCollide(hull->getCollisionGroup(), (*hit_it)->getCollisionGroup()))
+					{
+						m_contacts.addContact(hull->getId(), (*hit_it)->getId());
+					}
+				}
+			}
+
+			hull->updatePreviousPosition();
+		}
+	}
+
+	bool BasePhysics::addHull(CollisionHullPtr hull)
+	{
+		HullEntry& entry = m_collisionHulls[hull->getId()];
+		entry._hull = hull;
+		entry._gridHandle = m_cellGrid.insertObject(hull.get(), hull->getAABB());
+
+		int32 type = hull->getType();
+		if(type == ICollisionHull::k_typePoint || type == ICollisionHull::k_typeCircle)
+		{
+			m_pointHulls.push_back(static_cast<PointCollisionHull*>(hull.get()));
+		}
+
+		return true;
+	}
+
+	void BasePhysics::updateHull(const HullEntry& entry)
+	{
+		if(m_cellGrid.moveObject(entry._gridHandle, entry._hull->getAABB()))
+		{
+			m_stats.getCurrent()._numReinsertions++;
+		}
+	}
+
+	const IPhysics::Stats& BasePhysics::getStats()
+	{
+		return m_stats.getLast();
+	}
+	
+	BasePhysics::CollisionPairList& BasePhysics::getCollidedPairs()
+	{
+		return m_contacts.getBeginPairs();
+	}
+
+	BasePhysics::CollisionPairList& BasePhysics::getContactStayPairs()
+	{
+		return m_contacts.getStayPairs();
+	}
+
+	BasePhysics::CollisionPairList& BasePhysics::getContactEndPairs()
+	{
+		return m_contacts.getEndPairs();
+	}
+
+	void BasePhysics::debugDraw(Gfx* gfx)
+	{
+		for(HullEntryMap::iterator it = m_collisionHulls.begin(); it != m_collisionHulls.end(); ++it)
+		{
+			it->second._hull->draw(gfx);
+		}
+	}
+
+	//===========================================================================================================
+	//	SpatialPhysics implementation
+	//===========================================================================================================
+	template<typename SpatialIndex>
+	SpatialPhysics<SpatialIndex>::SpatialPhysics()
+		:m_rebaseDistance(0.0f), m_numWorkerThreads(-1), m_workersStarted(false), m_initialized(false)
+	{
+
+	}
+
+	template<typename SpatialIndex>
+	SpatialPhysics<SpatialIndex>::~SpatialPhysics()
+	{
+
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::create(const Rect2D& worldSize)
+	{
+		m_worldArea = worldSize;
+		m_rebaseDistance = 0.25f * std::min(fabs(worldSize.width()), fabs(worldSize.height()));
+
+		m_layers.clear();
+		m_trees.clear();
+		m_trees.push_back(new SpatialIndex());
+		m_trees.back()->create(worldSize);
+		m_layerGroupCounts.assign(k_numCollisionGroups, 0);
+
+		m_filter.reset();
+
+		m_initialized = true;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::destroy()
+	{
+		for(typename TreeList::iterator it = m_trees.begin(); it != m_trees.end(); ++it)
+		{
+			(*it)->destroy();
+		}
+		m_trees.clear();
+		m_layers.clear();
+		m_layerGroupCounts.clear();
+		m_queryHulls.clear();
+		m_workers.destroy();
+		m_workersStarted = false;
+		m_collisionHulls.clear();
+		for(int32 i = 0; i < k_numCollisionGroups; i++)
+		{
+			m_groupHulls[i].clear();
+		}
+		m_pointHulls.clear();
+		m_contacts.clear();
+		m_candidates.clear();
+		m_candidateKeys.clear();
+		m_stats.clear();
+		m_initialized = false;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::setCollisionGroupFlag(int32 group, bool checkCollisions)
+	{
+		m_filter.setGroupActive(group, checkCollisions);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions)
+	{
+		m_filter.setPairEnabled(groupA, groupB, checkCollisions);
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::registerPoint(int32 id, int32 group, const Vector3& position)
+	{
+		return false;
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::registerCircle(int32 id, int32 group, const Vector3& position, float radius)
+	{
+		if(!m_initialized) return false;
+
+		assert(id > 0);
+		assert(group > 0);
+		assert(group < k_numCollisionGroups);
+		assert(m_collisionHulls.count(id) == 0);
+
+		if(m_collisionHulls.count(id) > 0 || !CollisionFilter::isValidGroup(group))
+		{
+			return false;
+		}
+
+
+		CircleCollisionHull* circle = new CircleCollisionHull(id, group, position, radius);
+		CollisionHullPtr hull = circle;
+		m_collisionHulls[id] = hull;
+		m_groupHulls[group][id] = hull;
+		m_pointHulls.push_back(circle);
+		countLayerHull(circle, 1);
+
+		Rect2D aabb = hull->getAABB();
+		hull->setTreeHandle(m_trees[ScrollLayers::k_worldLayer]->insertObject(hull, aabb));
+
+		return true;
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::registerPoligon(int32 id, int32 group, const PointList& points)
+	{
+		if(!m_initialized) return false;
+
+		assert(id > 0);
+		assert(group > 0);
+		assert(group < k_numCollisionGroups);
+		assert(m_collisionHulls.count(id) == 0);
+
+		if(m_collisionHulls.count(id) > 0 || !CollisionFilter::isValidGroup(group))
+		{
+			return false;
+		}
+
+
+		CollisionHullPtr hull = BoxCollisionHull::isAxisAligned(points)
+				? new BoxCollisionHull(id, group, points) : new PoligonCollisionHull(id, group, points);
+		m_collisionHulls[id] = hull;
+		m_groupHulls[group][id] = hull;
+		countLayerHull(hull.get(), 1);
+
+		Rect2D aabb = hull->getAABB();
+		hull->setTreeHandle(m_trees[ScrollLayers::k_worldLayer]->insertObject(hull, aabb));
+
+		return true;
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::registerBox(int32 id, int32 group, const Rect2D& box)
+	{
+		PointList points;
+		BoxCollisionHull::makePoints(box, points);
+
+		return registerPoligon(id, group, points);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::unregisterCollisionHull(int32 id)
+	{
+		if(!m_initialized) return;
+
+		if(m_collisionHulls.count(id) > 0)
+		{
+			CollisionHullPtr hull = m_collisionHulls[id];
+			m_collisionHulls.erase(id);
+			m_groupHulls[hull->getCollisionGroup()].erase(id);
+			SpatialHandle handle = hull->getTreeHandle();
+			m_trees[hull->getScrollLayer()]->removeObject(handle);
+			hull->setTreeHandle(handle);
+			m_layers.removeHull(id);
+			countLayerHull(hull.get(), -1);
+
+			PointHullList::iterator point_it = std::find(m_pointHulls.begin(), m_pointHulls.end(), hull.get());
+			if(point_it != m_pointHulls.end())
+			{
+				m_pointHulls.erase(point_it);
+			}
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::moveObject(int32 id, const Vector3& offset, bool absolute)
+	{
+		if(!m_initialized) return;
+
+		assert(m_collisionHulls.count(id) > 0);
+
+		CollisionHullPtr hull = m_collisionHulls[id];
+		int32 layer = hull->getScrollLayer();
+		moveHull(hull.get(), offset, absolute, m_layers.getBase(layer));
+
+		updateHull(hull, layer);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::rotateObject(int32 id, float degreesOffset, bool absolute)
+	{
+		if(!m_initialized) return;
+
+		assert(m_collisionHulls.count(id) > 0);
+
+		CollisionHullPtr hull = m_collisionHulls[id];
+		int32 layer = hull->getScrollLayer();
+		rotateHull(hull.get(), degreesOffset, absolute, m_layers.getBase(layer));
+
+		updateHull(hull, layer);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::transformObject(int32 id, const Matrix4x4& m)
+	{
+		if(!m_initialized) return;
+
+		assert(m_collisionHulls.count(id) > 0);
+
+		CollisionHullPtr hull = m_collisionHulls[id];
+		int32 layer = hull->getScrollLayer();
+		transformHull(hull.get(), m, m_layers.getBase(layer));
+
+		updateHull(hull, layer);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::updateHull(const CollisionHullPtr& hull, int32 layer)
+	{
+		Rect2D newAabb = hull->getAABB();
+		SpatialHandle handle = hull->getTreeHandle();
+		if(m_trees[layer]->isValidHandle(handle))
+		{
+			m_trees[layer]->updateObject(handle, newAabb);
+		}else
+		{
+			//the hull is back inside the tree area
+			handle = m_trees[layer]->insertObject(hull, newAabb);
+		}
+		hull->setTreeHandle(handle);
+	}
+
+	template<typename SpatialIndex>
+	int32 SpatialPhysics<SpatialIndex>::createScrollLayer()
+	{
+		if(!m_initialized) return -1;
+
+		m_trees.push_back(new SpatialIndex());
+		m_trees.back()->create(m_worldArea);
+		m_layerGroupCounts.resize(m_layerGroupCounts.size() + k_numCollisionGroups, 0);
+
+		return m_layers.createLayer();
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::setScrollLayerOffset(int32 layer, const Vector3& offset)
+	{
+		if(!m_initialized) return;
+
+		assert(m_layers.isValidLayer(layer) && layer != ScrollLayers::k_worldLayer);
+
+		if(!m_layers.isValidLayer(layer) || layer == ScrollLayers::k_worldLayer)
+		{
+			return;
+		}
+
+		//nothing moves until the hulls of the layer may leave the tree area
+		m_layers.setOffset(layer, offset);
+
+		Vector3 shift = m_layers.getShift(layer);
+		if(fabs(shift._x) > m_rebaseDistance || fabs(shift._y) > m_rebaseDistance)
+		{
+			rebaseLayer(layer);
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::rebaseLayer(int32 layer)
+	{
+		Vector3 shift = m_layers.getShift(layer);
+
+		m_layers.getLayerHulls(layer, m_layerHulls);
+		for(std::vector<int32>::iterator it = m_layerHulls.begin(); it != m_layerHulls.end(); ++it)
+		{
+			const CollisionHullPtr& hull = m_collisionHulls[*it];
+			offsetHull(hull.get(), shift);
+			updateHull(hull, layer);
+		}
+
+		m_layers.rebase(layer);
+	}
+
+	template<typename SpatialIndex>
+	Vector3 SpatialPhysics<SpatialIndex>::getScrollLayerOffset(int32 layer)
+	{
+		return m_layers.isValidLayer(layer) ? m_layers.getOffset(layer) : Vector3();
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::attachToScrollLayer(int32 id, int32 layer)
+	{
+		if(!m_initialized) return false;
+
+		CollisionHullMap::iterator it = m_collisionHulls.find(id);
+		if(it == m_collisionHulls.end() || !m_layers.isValidLayer(layer))
+		{
+			return false;
+		}
+
+		CollisionHullPtr hull = it->second;
+		int32 oldLayer = hull->getScrollLayer();
+		if(oldLayer == layer)
+		{
+			return true;
+		}
+
+		SpatialHandle handle = hull->getTreeHandle();
+		m_trees[oldLayer]->removeObject(handle);
+
+		Vector3 offset = m_layers.getBase(layer) - m_layers.getBase(oldLayer);
+		if(!isZero(offset))
+		{
+			offsetHull(hull.get(), offset);
+		}
+
+		countLayerHull(hull.get(), -1);
+		m_layers.setHullLayer(id, layer);
+		hull->setScrollLayer(layer);
+		countLayerHull(hull.get(), 1);
+
+		Rect2D aabb = hull->getAABB();
+		hull->setTreeHandle(m_trees[layer]->insertObject(hull, aabb));
+
+		return true;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::update()
+	{
+		if(!m_initialized) return;
+
+		IPhysics::Stats& stats = m_stats.getCurrent();
+		m_stats.beginUpdate();
+
+		m_contacts.beginUpdate();
+
+		gatherCandidates();
+		stats._numCandidatePairs = m_candidates.size();
+		m_stats.endPhase(Stats::k_phaseBroadphase);
+
+		testCandidates();
+		stats._numHits = m_hits.size();
+		m_stats.endPhase(Stats::k_phaseNarrowphase);
+
+		sweepPointHulls();
+		m_stats.endPhase(Stats::k_phaseSweep);
+
+		m_contacts.endUpdate();
+		m_stats.endPhase(Stats::k_phaseContacts);
+
+		stats._numNodesVisited += takeNodesVisited();
+		stats._numReinsertions += takeReinsertions();
+		m_stats.endUpdate(m_collisionHulls.size());
+	}
+
+	template<typename SpatialIndex>
+	int32 SpatialPhysics<SpatialIndex>::takeNodesVisited()
+	{
+		int32 numNodesVisited = 0;
+		for(typename TreeList::iterator it = m_trees.begin(); it != m_trees.end(); ++it)
+		{
+			numNodesVisited += (*it)->getNumNodesVisited();
+			(*it)->resetNumNodesVisited();
+		}
+
+		return numNodesVisited;
+	}
+
+	template<typename SpatialIndex>
+	int32 SpatialPhysics<SpatialIndex>::takeReinsertions()
+	{
+		int32 numReinsertions = 0;
+		for(typename TreeList::iterator it = m_trees.begin(); it != m_trees.end(); ++it)
+		{
+			numReinsertions += (*it)->getNumReinsertions();
+			(*it)->resetNumReinsertions();
+		}
+
+		return numReinsertions;
+	}
+
+	template<typename SpatialIndex>
+	const IPhysics::Stats& SpatialPhysics<SpatialIndex>::getStats()
+	{
+		return m_stats.getLast();
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::setNumWorkerThreads(int32 numThreads)
+	{
+		m_numWorkerThreads = numThreads;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::countLayerHull(ICollisionHull* hull, int32 delta)
+	{
+		m_layerGroupCounts[hull->getScrollLayer() * k_numCollisionGroups + hull->getCollisionGroup()] += delta;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::gatherCandidates()
+	{
+		m_candidates.clear();
+		m_candidateKeys.clear();
+
+		//groups present in every layer and the shifts of the layers, a layer
+		//holding no group of the collision mask is not queried
+		int32 numLayers = m_layers.getNumLayers();
+		m_layerGroups.assign(numLayers, 0);
+		m_layerShifts.resize(numLayers);
+		for(int32 layer = 0; layer < numLayers; layer++)
+		{
+			for(int32 group = 0; group < k_numCollisionGroups; group++)
+			{
+				if(m_layerGroupCounts[layer * k_numCollisionGroups + group] > 0)
+				{
+					m_layerGroups[layer] |= CollisionFilter::getBit(group);
+				}
+			}
+			m_layerShifts[layer] = m_layers.getShift(layer);
+		}
+
+		//
+		//      ( ),
+		//     
+		uint32 activeGroups = m_filter.getActiveGroups();
+		for(int32 groupA = 0; activeGroups != 0; groupA++, activeGroups >>= 1)
+		{
+			if((activeGroups & 1) == 0)
+			{
+				continue;
+			}
+
+			uint32 collisionMask = m_filter.getCollisionMask(groupA);
+			CollisionHullMap& hulls = m_groupHulls[groupA];
+
+			for(CollisionHullMap::iterator it = hulls.begin(); it != hulls.end(); ++it)
+			{
+				ICollisionHull* hullA = it->second.get();
+				const Vector3& shiftA = m_layerShifts[hullA->getScrollLayer()];
+				Rect2D aabbA = hullA->getAABB();
+
+				//bounds of the nodes of a loose tree overlap, the hulls touching hullA
+				//are not all on the way from its node to the root: every tree, its
+				//own too, is asked for the AABB of hullA moved into its coordinates
+				for(int32 layerB = 0; layerB < numLayers; layerB++)
+				{
+					if((m_layerGroups[layerB] & collisionMask) == 0)
+					{
+						continue;
+					}
+
+					Vector3 shift = m_layerShifts[layerB] - shiftA;
+					Point2D queryShift(shift._x, shift._y);
+					Rect2D aabb(aabbA._topLeft - queryShift, aabbA._bottomRight - queryShift);
+
+					m_queryHulls.clear();
+					HullCollector collector(hullA, collisionMask, m_queryHulls);
+					m_trees[layerB]->query(aabb, collector);
+
+					for(HullList::iterator query_it = m_queryHulls.begin(); query_it != m_queryHulls.end(); ++query_it)
+					{
+						addCandidate(hullA, *query_it, shift);
+					}
+				}
+			}
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::addCandidate(ICollisionHull* a, ICollisionHull* b, const Vector3& shift)
+	{
+		//both hulls of a pair may walk to each other, the pair is tested once
+		CollisionPairKey key = CollisionPairSet::makeKey(a->getId(), b->getId());
+		if(m_candidateKeys.insert(key))
+		{
+			CandidatePair pair;
+			pair._a = a;
+			pair._b = b;
+			pair._key = key;
+			pair._shift = shift;
+
+			m_candidates.push_back(pair);
+			//every candidate is tested once, the test is counted here and
+			//not by the narrowphase workers
+			m_stats.addTest(a->getType(), b->getType());
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::testCandidates()
+	{
+		int32 numCandidates = m_candidates.size();
+		int32 numShards = numCandidates / k_minPairsPerWorker;
+		if(numShards > 1 && !m_workersStarted)
+		{
+			startWorkers();
+		}
+		numShards = std::min(m_workers.getNumWorkers(), numShards);
+
+		m_narrowphaseTask.setup(&m_candidates, std::max(numShards, 1));
+		if(numShards > 1)
+		{
+			m_workers.execute(&m_narrowphaseTask);
+		}else
+		{
+			m_narrowphaseTask.run(0, 1);
+		}
+
+		m_narrowphaseTask.mergeHits(m_hits);
+
+		for(PairKeyList::iterator it = m_hits.begin(); it != m_hits.end(); ++it)
+		{
+			m_contacts.addContact(CollisionPairSet::getFirstId(*it), CollisionPairSet::getSecondId(*it));
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::startWorkers()
+	{
+		int32 numThreads = m_numWorkerThreads;
+		if(numThreads < 0)
+		{
+			numThreads = std::min(WorkerPool::getNumProcessors() - 1, (int32)k_maxWorkerThreads);
+		}
+
+		if(numThreads > 0)
+		{
+			m_workers.create(numThreads);
+		}
+		m_workersStarted = true;
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::sweepPointHulls()
+	{
+		for(PointHullList::iterator it = m_pointHulls.begin(); it != m_pointHulls.end(); ++it)
+		{
+			PointCollisionHull* hull = *it;
+
+			CollisionCasts::Ray ray;
+			float length;
+			if(makeSweepRay(hull, ray, length))
+			{
+				m_sweepHits.clear();
+				m_stats.getCurrent()._numSweeps++;
+
+				//the sweep is measured in the layer of the hull
+				HullSweeper sweeper(hull, ray, length, m_sweepHits);
+				castLayers(m_layers.getShift(hull->getScrollLayer()), length, sweeper);
+
+				for(HullList::iterator hit_it = m_sweepHits.begin(); hit_it != m_sweepHits.end(); ++hit_it)
+				{
+					if(m_filter.shouldCollide(hull->getCollisionGroup(), (*hit_it)->getCollisionGroup()))
+					{
+						m_contacts.addContact(hull->getId(), (*hit_it)->getId());
+					}
+				}
+			}
+
+			hull->updatePreviousPosition();
+		}
+	}
+
+	template<typename SpatialIndex>
+	IPhysics::CollisionPairList& SpatialPhysics<SpatialIndex>::getCollidedPairs()
+	{
+		return m_contacts.getBeginPairs();
+	}
+
+	template<typename SpatialIndex>
+	IPhysics::CollisionPairList& SpatialPhysics<SpatialIndex>::getContactStayPairs()
+	{
+		return m_contacts.getStayPairs();
+	}
+
+	template<typename SpatialIndex>
+	IPhysics::CollisionPairList& SpatialPhysics<SpatialIndex>::getContactEndPairs()
+	{
+		return m_contacts.getEndPairs();
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::isIntersects(ICollisionHull* a, ICollisionHull* b)
+	{
+		Vector3 shift = m_layers.getShift(b->getScrollLayer()) - m_layers.getShift(a->getScrollLayer());
+
+		return Intersections::isIntersects(a, b, shift);
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+			CastHit& hit, uint32 groupMask)
+	{
+		return castCircle(origin, 0.0f, direction, maxDistance, hit, groupMask);
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+			CastHit& hit, uint32 groupMask)
+	{
+		CollisionCasts::Ray ray;
+		if(!CollisionCasts::makeRay(origin, direction, radius, ray))
+		{
+			return false;
+		}
+
+		return cast(ray, maxDistance, hit, groupMask);
+	}
+
+	template<typename SpatialIndex>
+	bool SpatialPhysics<SpatialIndex>::cast(const CollisionCasts::Ray& ray, float maxDistance, CastHit& hit, uint32 groupMask)
+	{
+		if(!m_initialized) return false;
+
+		m_stats.getCurrent()._numCasts++;
+
+		HullCaster caster(ray, groupMask);
+		castLayers(Vector3(), maxDistance, caster);
+
+		return caster.getResult(hit);
+	}
+
+	template<typename SpatialIndex>
+	template<class Visitor>
+	void SpatialPhysics<SpatialIndex>::castLayers(const Vector3& rayShift, float maxDistance, Visitor& visitor)
+	{
+		int32 numLayers = m_layers.getNumLayers();
+		for(int32 layer = 0; layer < numLayers; layer++)
+		{
+			visitor.setLayerShift(m_layers.getShift(layer) - rayShift);
+
+			const CollisionCasts::Ray& ray = visitor.getLayerRay();
+			m_trees[layer]->castRay(Point2D(ray._originX, ray._originY),
+					Point2D(ray._directionX, ray._directionY), ray._radius,
+					visitor.getMaxDistance(maxDistance), visitor);
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::debugDraw(Gfx* gfx)
+	{
+		for(CollisionHullMap::iterator it = m_collisionHulls.begin(); it != m_collisionHulls.end(); ++it)
+		{
+			it->second->draw(gfx);
+		}
+	}
+
+	//-----------------------------------------------------------------------------------------------------------
+	//	SpatialPhysics::NarrowphaseTask class implementation
+	//-----------------------------------------------------------------------------------------------------------
+	template<typename SpatialIndex>
+	SpatialPhysics<SpatialIndex>::NarrowphaseTask::NarrowphaseTask()
+		:m_candidates(0), m_numShards(1)
+	{
+
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::NarrowphaseTask::setup(const CandidatePairList* candidates, int32 numShards)
+	{
+		m_candidates = candidates;
+		m_numShards = numShards;
+
+		if((int32)m_hits.size() < numShards)
+		{
+			m_hits.resize(numShards);
+		}
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::NarrowphaseTask::run(int32 workerIndex, int32 numWorkers)
+	{
+		//one shard per worker, the workers beyond the number of shards idle
+		if(workerIndex >= m_numShards)
+		{
+			return;
+		}
+
+		PairKeyList& hits = m_hits[workerIndex];
+		hits.clear();
+
+		int32 numCandidates = m_candidates->size();
+		int32 first = (int32)(((int64)numCandidates * workerIndex) / m_numShards);
+		int32 last = (int32)(((int64)numCandidates * (workerIndex + 1)) / m_numShards);
+
+		//circle/circle pairs go to the batched kernel, mergeHits sorts the hits anyway
+		CirclePairBatch circlePairs;
+		for(int32 i = first; i < last; i++)
+		{
+			const CandidatePair& pair = (*m_candidates)[i];
+			if(isCirclePair(pair._a, pair._b))
+			{
+				circlePairs.add(pair._a, pair._b, pair._shift, i);
+				if(circlePairs.isFull())
+				{
+					flushCirclePairs(circlePairs, *m_candidates, hits);
+				}
+			}else if(Intersections::isIntersects(pair._a, pair._b, pair._shift))
+			{
+				hits.push_back(pair._key);
+			}
+		}
+
+		flushCirclePairs(circlePairs, *m_candidates, hits);
+	}
+
+	template<typename SpatialIndex>
+	void SpatialPhysics<SpatialIndex>::NarrowphaseTask::mergeHits(PairKeyList& hits)
+	{
+		hits.clear();
+		for(int32 i = 0; i < m_numShards; i++)
+		{
+			hits.insert(hits.end(), m_hits[i].begin(), m_hits[i].end());
+		}
+
+		std::sort(hits.begin(), hits.end());
+	}
+
+	//explicit instantiations for the indices the game may choose
+	template class SpatialPhysics<BP2QuadTree>;
+	template class SpatialPhysics<BP2AABBTree>;
+
+	//===========================================================================================================
+	//	BasePhysics3 implementation
+	//===========================================================================================================
+	BasePhysics3::BasePhysics3()
+		:m_numSortedEndpoints(0), m_endpointsDirty(false), m_maxHullWidth(0.0f), m_initialized(false)
+	{
+
+	}
+
+	BasePhysics3::~BasePhysics3()
+	{
+
+	}
+
+	void BasePhysics3::create(const Rect2D& worldSize)
+	{
+		//sweep and prune does not depend on the world size
+
+		destroy();
+
+		m_filter.reset();
+
+		m_initialized = true;
+	}
+
+	void BasePhysics3::destroy()
+	{
+		m_world.clear();
+		m_hullLookup.clear();
+		m_endpoints.clear();
+		m_numSortedEndpoints = 0;
+		m_endpointPositions.clear();
+		m_endpointsDirty = false;
+		m_activeHulls.clear();
+		m_sweepHits.clear();
+		m_activeIndices.clear();
+		m_hits.clear();
+		m_contacts.clear();
+		m_layers.clear();
+		m_stats.clear();
+
+		m_initialized = false;
+	}
+
+	void BasePhysics3::setCollisionGroupFlag(int32 group, bool checkCollisions)
+	{
+		m_filter.setGroupActive(group, checkCollisions);
+	}
+
+	void BasePhysics3::setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions)
+	{
+		m_filter.setPairEnabled(groupA, groupB, checkCollisions);
+	}
+
+	bool BasePhysics3::registerPoint(int32 id, int32 group, const Vector3& position)
+	{
+		if(!m_initialized) return false;
+
+		assert(id > 0);
+		assert(group > 0);
+		assert(group < k_numCollisionGroups);
+		assert(m_hullLookup.count(id) == 0);
+
+		if(m_hullLookup.count(id) > 0 || !CollisionFilter::isValidGroup(group))
+		{
+			return false;
+		}
+
+		addHull(m_world.createPoint(id, group, position));
+
+		return true;
+	}
+
+	bool BasePhysics3::registerCircle(int32 id, int32 group, const Vector3& position, float radius)
+	{
+		if(!m_initialized) return false;
+
+		assert(id > 0);
+		assert(group > 0);
+		assert(group < k_numCollisionGroups);
+		assert(m_hullLookup.count(id) == 0);
+
+		if(m_hullLookup.count(id) > 0 || !CollisionFilter::isValidGroup(group))
+		{
+			return false;
+		}
+
+		addHull(m_world.createCircle(id, group, position, radius));
+
+		return true;
+	}
+
+	bool BasePhysics3::registerPoligon(int32 id, int32 group, const PointList& points)
+	{
+		if(!m_initialized) return false;
+
 		assert(id > 0);
 		assert(group > 0);
-		assert(m_collisionHulls.count(id) == 0);
+		assert(group < k_numCollisionGroups);
+		assert(m_hullLookup.count(id) == 0);
 
-		if(m_collisionHulls.count(id) > 0)
+		if(m_hullLookup.count(id) > 0 || !CollisionFilter::isValidGroup(group))
 		{
 			return false;
 		}
 
-		
-		CollisionHullPtr hull = new PoligonCollisionHull(id, group, points);
-		m_collisionHulls[id] = hull;
-		m_cellGrid.placeToGrid(hull->getPosition(), hull.get());
+		addHull(m_world.createPolygon(id, group, points));
 
 		return true;
 	}
-	
-	void BasePhysics::unregisterCollisionHull(int32 id)
-	{
-		//assert(m_collisionHulls.count(id) > 0);
-		
-		if(m_collisionHulls.count(id) > 0)
-		{
-			CollisionHullPtr hull = m_collisionHulls[id];
-			m_collisionHulls.erase(id);
-			m_cellGrid.removeObject(hull.get());
-		}
-	}
-		
-	void BasePhysics::moveObject(int32 id, const Vector3& offset, bool absolute)
-	{
-		assert(m_collisionHulls.count(id) > 0);
 
-		CollisionHullPtr hull = m_collisionHulls[id];
-		hull->moveObject(offset, absolute);
-		m_cellGrid.placeToGrid(hull->getPosition(), hull.get());
-	}
-	
-	void BasePhysics::rotateObject(int32 id, float degreesOffset, bool absolute)
+	void BasePhysics3::addHull(HullHandle handle)
 	{
-		assert(m_collisionHulls.count(id) > 0);
+		int32 index = m_world.getIndex(handle);
+		m_hullLookup[m_world.getId(index)] = handle;
 
-		CollisionHullPtr hull = m_collisionHulls[id];
-		hull->rotateObject(degreesOffset, absolute);
-		m_cellGrid.placeToGrid(hull->getPosition(), hull.get());
+		//new endpoints go to the end of the array,
+		//the next update sorts them apart and merges them in
+		m_endpointPositions.resize(2 * (index + 1));
+		m_endpointPositions[2 * index] = m_endpoints.size();
+		m_endpointPositions[2 * index + 1] = m_endpoints.size() + 1;
+
+		Endpoint endpoint;
+		endpoint._index = index;
+
+		endpoint._value = m_world.getMinX(index);
+		endpoint._isMin = true;
+		m_endpoints.push_back(endpoint);
+
+		endpoint._value = m_world.getMaxX(index);
+		endpoint._isMin = false;
+		m_endpoints.push_back(endpoint);
+
+		m_endpointsDirty = true;
 	}
 
-	void BasePhysics::transformObject(int32 id, const Matrix4x4& m)
+	bool BasePhysics3::registerBox(int32 id, int32 group, const Rect2D& box)
 	{
-		assert(m_collisionHulls.count(id) > 0);
+		PointList points;
+		BoxCollisionHull::makePoints(box, points);
 
-		CollisionHullPtr hull = m_collisionHulls[id];
-		hull->transformObject(m);
-		m_cellGrid.placeToGrid(hull->getPosition(), hull.get());
+		return registerPoligon(id, group, points);
 	}
-		
-	void BasePhysics::update()
-	{
-		std::set<int32> closedNodes;
 
-		m_pairs.clear();
+	void BasePhysics3::unregisterCollisionHull(int32 id)
+	{
+		if(!m_initialized) return;
 
-		for(CollisionHullMap::iterator it = m_collisionHulls.begin(); it != m_collisionHulls.end(); ++it)
+		HullLookupTable::iterator found_it = m_hullLookup.find(id);
+		if(found_it == m_hullLookup.end())
 		{
-			Vector3 position = it->second->getPosition();
-			Cell<ICollisionHull*>* myCell =	m_cellGrid.getCell(position); 
-
-			ICollisionHull* a = it->second.get();
-			ICollisionHull* b = 0;
+			return;
+		}
 
-			for(int32 i = 0; i < 9; i++)
-			{
-				Cell<ICollisionHull*>* currentCell = myCell->getSibling(i);
-				if(currentCell == 0) continue;
-				
-				for(Cell<ICollisionHull*>::ObjectListIt iit = currentCell->begin(); iit != currentCell->end(); ++iit)
-				{
-					b = *iit;
+		HullHandle handle = found_it->second;
+		m_hullLookup.erase(found_it);
+		m_layers.removeHull(id);
 
-					if(a == b) continue;
-					if(closedNodes.count(b->getId()) > 0) continue;
+		//endpoints of the hull are dropped by the next sort; the world moves
+		//its last hull into the freed slot, endpoints of that hull are renamed
+		int32 index = m_world.getIndex(handle);
+		int32 last = m_world.getNumHulls() - 1;
 
-					//TODO: collision groups filter
-					if(a->getCollisionGroup() == b->getCollisionGroup()) continue;
+		m_endpoints[m_endpointPositions[2 * index]]._index = k_removedEndpoint;
+		m_endpoints[m_endpointPositions[2 * index + 1]]._index = k_removedEndpoint;
+		if(last != index)
+		{
+			m_endpoints[m_endpointPositions[2 * last]]._index = index;
+			m_endpoints[m_endpointPositions[2 * last + 1]]._index = index;
+			m_endpointPositions[2 * index] = m_endpointPositions[2 * last];
+			m_endpointPositions[2 * index + 1] = m_endpointPositions[2 * last + 1];
+		}
+		m_endpointPositions.resize(2 * last);
+		m_endpointsDirty = true;
 
-					int32 id_a = a->getId();
-					int32 id_b = b->getId();
-					int32 hash = std::max(id_a, id_b) << 16 | std::min(id_a, id_b);
+		m_world.destroyHull(handle);
+	}
 
-					if(isIntersects(a, b))
-					{
-						if(m_previousCollisionPairs.count(hash) > 0)
-						{
-							continue;
-						}
-						
-						CollisionPair pair(std::max(id_a, id_b), std::min(id_a, id_b));
-						m_pairs.push_back(pair);
-						m_previousCollisionPairs.insert(hash);
-					}else
-					{
-						m_previousCollisionPairs.erase(hash);
-					}
-					
-				}//for(Cell<ICollisionHull*>::ObjectListIt iit = currentCell->begin(); iit != currentCell->end(); ++iit)
-			}//for(int32 i = 0; i < 9; i++)
+	void BasePhysics3::moveObject(int32 id, const Vector3& offset, bool absolute)
+	{
+		if(!m_initialized) return;
 
-			closedNodes.insert(a->getId());
+		assert(m_hullLookup.count(id) > 0);
 
-		}//for(CollisionHullMap::iterator it = m_collisionHulls.begin(); it != m_collisionHulls.end(); ++it)
-	}
-	
-	BasePhysics::CollisionPairList& BasePhysics::getCollidedPairs()
-	{
-		return m_pairs;
-	}
+		HullHandle handle = m_hullLookup[id];
+		const Vector3& base = m_layers.getBase(m_layers.getHullLayer(id));
 
-	void BasePhysics::debugDraw(Gfx* gfx)
-	{
-		for(CollisionHullMap::iterator it = m_collisionHulls.begin(); it != m_collisionHulls.end(); ++it)
+		m_world.moveHull(handle, offset, absolute);
+		if(absolute && !isZero(base))
 		{
-			it->second->draw(gfx);
+			m_world.moveHull(handle, base, false);
 		}
+		m_endpointsDirty = true;
 	}
 
-	//===========================================================================================================
-	//	BasePhysics2 implementation
-	//===========================================================================================================
-	BasePhysics2::BasePhysics2()
-		:m_initialized(false)
+	void BasePhysics3::rotateObject(int32 id, float degreesOffset, bool absolute)
 	{
-		m_checkers[ICollisionHull::k_typePoint][ICollisionHull::k_typePoint] = &Intersections::isIntersectsPointPoint;
-		m_checkers[ICollisionHull::k_typePoint][ICollisionHull::k_typeCircle] = &Intersections::isIntersectsPointCircle;
-		m_checkers[ICollisionHull::k_typePoint][ICollisionHull::k_typePolygon] = &Intersections::isIntersectsPointPolygon;
+		if(!m_initialized) return;
+
+		assert(m_hullLookup.count(id) > 0);
 
-		m_checkers[ICollisionHull::k_typeCircle][ICollisionHull::k_typePoint] = &Intersections::isIntersectsCirclePoint;
-		m_checkers[ICollisionHull::k_typeCircle][ICollisionHull::k_typeCircle] = &Intersections::isIntersectsCircleCircle;
-		m_checkers[ICollisionHull::k_typeCircle][ICollisionHull::k_typePolygon] = &Intersections::isIntersectsCirclePolygon;
+		HullHandle handle = m_hullLookup[id];
+		const Vector3& base = m_layers.getBase(m_layers.getHullLayer(id));
 
-		m_checkers[ICollisionHull::k_typePolygon][ICollisionHull::k_typePoint] = &Intersections::isIntersectsPolygonPoint;
-		m_checkers[ICollisionHull::k_typePolygon][ICollisionHull::k_typeCircle] = &Intersections::isIntersectsPolygonCircle;
-		m_checkers[ICollisionHull::k_typePolygon][ICollisionHull::k_typePolygon] = &Intersections::isIntersectsPolygonPolygon;
+		if(isZero(base))
+		{
+			m_world.rotateHull(handle, degreesOffset, absolute);
+		}else
+		{
+			//rotation about the layer origin
+			if(!absolute)
+			{
+				m_world.moveHull(handle, Vector3(-base._x, -base._y, -base._z), false);
+			}
+			m_world.rotateHull(handle, degreesOffset, absolute);
+			m_world.moveHull(handle, base, false);
+		}
+		m_endpointsDirty = true;
 	}
 
-	BasePhysics2::~BasePhysics2()
+	void BasePhysics3::transformObject(int32 id, const Matrix4x4& m)
 	{
+		if(!m_initialized) return;
 
-	}
+		assert(m_hullLookup.count(id) > 0);
 
-	void BasePhysics2::create(const Rect2D& worldSize)
-	{
-		m_quadTree.create(worldSize);
+		HullHandle handle = m_hullLookup[id];
+		const Vector3& base = m_layers.getBase(m_layers.getHullLayer(id));
 
-		for(int i = 0; i < k_numCollisionGroups; i++)
+		m_world.transformHull(handle, m);
+		if(!isZero(base))
 		{
-			m_collisionGroupFlags[i] = false;
-
-			for(int j = 0; j < k_numCollisionGroups; j++)
-			{
-				m_collisionGroupMatrix[i][j] = false;
-			}
+			m_world.moveHull(handle, base, false);
 		}
-
-		m_initialized = true;
+		m_endpointsDirty = true;
 	}
 
-	void BasePhysics2::destroy()
+	int32 BasePhysics3::createScrollLayer()
 	{
-		m_quadTree.destroy();
-		m_initialized = false;
+		return m_layers.createLayer();
 	}
 
-	void BasePhysics2::setCollisionGroupFlag(int32 group, bool checkCollisions)
+	void BasePhysics3::setScrollLayerOffset(int32 layer, const Vector3& offset)
 	{
-		assert(group < k_numCollisionGroups);
+		assert(m_layers.isValidLayer(layer) && layer != ScrollLayers::k_worldLayer);
 
-		if(group < k_numCollisionGroups)
+		if(!m_layers.isValidLayer(layer) || layer == ScrollLayers::k_worldLayer)
 		{
-			m_collisionGroupFlags[group] = checkCollisions;
+			return;
 		}
-	}
 
-	void BasePhysics2::setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions)
-	{
-		assert(groupA < k_numCollisionGroups);
-		assert(groupB < k_numCollisionGroups);
+		m_layers.setOffset(layer, offset);
+		if(!m_layers.isShifted(layer))
+		{
+			return;
+		}
+
+		//the endpoints hold world coordinates, every hull of the layer moves
+		Vector3 shift = m_layers.getShift(layer);
 
-		if(groupA < k_numCollisionGroups && groupB < k_numCollisionGroups)
+		m_layers.getLayerHulls(layer, m_layerHulls);
+		for(std::vector<int32>::iterator it = m_layerHulls.begin(); it != m_layerHulls.end(); ++it)
 		{
-			m_collisionGroupMatrix[groupA][groupB] = checkCollisions;
-			m_collisionGroupMatrix[groupB][groupA] = checkCollisions;
+			HullHandle handle = m_hullLookup[*it];
+			m_world.moveHull(handle, shift, false);
+			m_world.offsetPreviousPosition(m_world.getIndex(handle), shift);
 		}
+		m_endpointsDirty = true;
+
+		m_layers.rebase(layer);
 	}
 
-	bool BasePhysics2::registerPoint(int32 id, int32 group, const Vector3& position)
+	Vector3 BasePhysics3::getScrollLayerOffset(int32 layer)
 	{
-		return false;
+		return m_layers.isValidLayer(layer) ? m_layers.getOffset(layer) : Vector3();
 	}
 
-	bool BasePhysics2::registerCircle(int32 id, int32 group, const Vector3& position, float radius)
+	bool BasePhysics3::attachToScrollLayer(int32 id, int32 layer)
 	{
-		if(!m_initialized) return false;
-
-		assert(id > 0);
-		assert(group > 0);
-		assert(m_collisionHulls.count(id) == 0);
-
-		if(m_collisionHulls.count(id) > 0)
+		HullLookupTable::iterator it = m_hullLookup.find(id);
+		if(it == m_hullLookup.end() || !m_layers.isValidLayer(layer))
 		{
 			return false;
 		}
 
+		Vector3 offset = m_layers.getBase(layer) - m_layers.getBase(m_layers.getHullLayer(id));
+		if(!isZero(offset))
+		{
+			m_world.moveHull(it->second, offset, false);
+			m_world.offsetPreviousPosition(m_world.getIndex(it->second), offset);
+			m_endpointsDirty = true;
+		}
 
-		CollisionHullPtr hull = new CircleCollisionHull(id, group, position, radius);
-		m_collisionHulls[id] = hull;
-
-		Rect2D aabb = hull->getAABB();
-		m_quadTree.insertObject(hull, aabb);
+		m_layers.setHullLayer(id, layer);
 
 		return true;
 	}
 
-	bool BasePhysics2::registerPoligon(int32 id, int32 group, const PointList& points)
+	void BasePhysics3::sortEndpoints()
 	{
-		if(!m_initialized) return false;
+		//refresh endpoint values from the hulls bounds and drop the endpoints
+		//of unregistered hulls; an endpoint of the sorted part that is less than
+		//one before it has to move, that is what a reinsertion is for the trees
+		EndpointLess less;
+		m_maxHullWidth = 0.0f;
+
+		int32 numReinsertions = 0;
+		int32 numSorted = 0;
+		int32 numEndpoints = 0;
+		Endpoint greatest;
+		for(int32 i = 0; i < (int32)m_endpoints.size(); i++)
+		{
+			Endpoint endpoint = m_endpoints[i];
+			if(endpoint._index == k_removedEndpoint)
+			{
+				continue;
+			}
 
-		assert(id > 0);
-		assert(group > 0);
-		assert(m_collisionHulls.count(id) == 0);
+			endpoint._value = endpoint._isMin ? m_world.getMinX(endpoint._index) : m_world.getMaxX(endpoint._index);
+			m_maxHullWidth = std::max(m_maxHullWidth, m_world.getMaxX(endpoint._index) - m_world.getMinX(endpoint._index));
 
-		if(m_collisionHulls.count(id) > 0)
+			if(i < m_numSortedEndpoints)
+			{
+				if(numSorted > 0 && less(endpoint, greatest))
+				{
+					numReinsertions++;
+				}else
+				{
+					greatest = endpoint;
+				}
+				numSorted++;
+			}
+
+			m_endpoints[numEndpoints++] = endpoint;
+		}
+		m_endpoints.resize(numEndpoints);
+
+		//hulls usually move a little between updates and insertion sort is
+		//close to linear; when most endpoints are out of place or it has to
+		//shift too far, everything is sorted again
+		if(numReinsertions * 2 > numSorted || !insertionSortEndpoints(numSorted))
 		{
-			return false;
+			std::stable_sort(m_endpoints.begin(), m_endpoints.end(), less);
+		}else if(numSorted < numEndpoints)
+		{
+			//endpoints of new hulls are sorted apart and merged in
+			std::stable_sort(m_endpoints.begin() + numSorted, m_endpoints.end(), less);
+			std::inplace_merge(m_endpoints.begin(), m_endpoints.begin() + numSorted, m_endpoints.end(), less);
 		}
 
+		m_numSortedEndpoints = numEndpoints;
+		updateEndpointPositions();
 
-		CollisionHullPtr hull = new PoligonCollisionHull(id, group, points);
-		m_collisionHulls[id] = hull;
+		m_stats.getCurrent()._numReinsertions += numReinsertions;
+		m_endpointsDirty = false;
+	}
 
-		Rect2D aabb = hull->getAABB();
-		m_quadTree.insertObject(hull, aabb);
+	bool BasePhysics3::insertionSortEndpoints(int32 numEndpoints)
+	{
+		EndpointLess less;
+		int32 maxShifts = numEndpoints * k_maxShiftsPerEndpoint;
+		int32 numShifts = 0;
+
+		for(int32 i = 1; i < numEndpoints; i++)
+		{
+			if(!less(m_endpoints[i], m_endpoints[i - 1]))
+			{
+				continue;
+			}
+
+			Endpoint key = m_endpoints[i];
+			int32 j = i - 1;
+			while(j >= 0 && less(key, m_endpoints[j]))
+			{
+				m_endpoints[j + 1] = m_endpoints[j];
+				j--;
+			}
+			m_endpoints[j + 1] = key;
+
+			numShifts += i - 1 - j;
+			if(numShifts > maxShifts)
+			{
+				return false;
+			}
+		}
 
 		return true;
 	}
 
-	void BasePhysics2::unregisterCollisionHull(int32 id)
+	void BasePhysics3::updateEndpointPositions()
 	{
-		if(!m_initialized) return;
+		m_endpointPositions.resize(2 * m_world.getNumHulls());
 
-		if(m_collisionHulls.count(id) > 0)
+		int32 numEndpoints = m_endpoints.size();
+		for(int32 i = 0; i < numEndpoints; i++)
 		{
-			CollisionHullPtr hull = m_collisionHulls[id];
-			m_collisionHulls.erase(id);
-			m_quadTree.removeObject(hull);
+			const Endpoint& endpoint = m_endpoints[i];
+			m_endpointPositions[2 * endpoint._index + (endpoint._isMin ? 0 : 1)] = i;
 		}
 	}
 
-	void BasePhysics2::moveObject(int32 id, const Vector3& offset, bool absolute)
+	void BasePhysics3::update()
 	{
 		if(!m_initialized) return;
 
-		assert(m_collisionHulls.count(id) > 0);
+		IPhysics::Stats& stats = m_stats.getCurrent();
+		m_stats.beginUpdate();
 
-		CollisionHullPtr hull = m_collisionHulls[id];
-		hull->moveObject(offset, absolute);
+		m_contacts.beginUpdate();
 
-		m_quadTree.removeObject(hull);
+		sortEndpoints();
 
-		Rect2D newAabb = hull->getAABB();
-		m_quadTree.insertObject(hull, newAabb);
-	}
+		m_activeHulls.clear();
+		m_activeIndices.resize(m_world.getNumHulls());
 
-	void BasePhysics2::rotateObject(int32 id, float degreesOffset, bool absolute)
-	{
-		if(!m_initialized) return;
+		for(int32 i = 0; i < CollisionWorld::k_numPairTypes; i++)
+		{
+			m_candidates[i].clear();
+		}
 
-		assert(m_collisionHulls.count(id) > 0);
+		for(EndpointList::iterator it = m_endpoints.begin(); it != m_endpoints.end(); ++it)
+		{
+			int32 index = it->_index;
 
-		CollisionHullPtr hull = m_collisionHulls[id];
-		hull->rotateObject(degreesOffset, absolute);
+			if(!it->_isMin)
+			{
+				//hull leaves the sweep line, swap-remove it from the active list
+				int32 position = m_activeIndices[index];
+				int32 last = m_activeHulls.back();
 
-		m_quadTree.removeObject(hull);
+				m_activeHulls[position] = last;
+				m_activeIndices[last] = position;
+				m_activeHulls.pop_back();
 
-		Rect2D newAabb = hull->getAABB();
-		m_quadTree.insertObject(hull, newAabb);
-	}
+				continue;
+			}
 
-	void BasePhysics2::transformObject(int32 id, const Matrix4x4& m)
-	{
-		if(!m_initialized) return;
+			//hull overlaps on x with every active one
+			float minY = m_world.getMinY(index);
+			float maxY = m_world.getMaxY(index);
 
-		assert(m_collisionHulls.count(id) > 0);
+			for(std::vector<int32>::iterator activeIt = m_activeHulls.begin();
+					activeIt != m_activeHulls.end(); ++activeIt)
+			{
+				int32 other = *activeIt;
 
-		CollisionHullPtr hull = m_collisionHulls[id];
-		hull->transformObject(m);
+				if(minY > m_world.getMaxY(other) || maxY < m_world.getMinY(other))
+				{
+					continue;
+				}
 
-		m_quadTree.removeObject(hull);
+				addCandidate(index, other);
+			}
 
-		Rect2D newAabb = hull->getAABB();
-		m_quadTree.insertObject(hull, newAabb);
+			m_activeIndices[index] = m_activeHulls.size();
+			m_activeHulls.push_back(index);
+		}
+		m_stats.endPhase(Stats::k_phaseBroadphase);
+
+		//narrowphase, batch by batch
+		for(int32 i = 0; i < CollisionWorld::k_numPairTypes; i++)
+		{
+			if(m_candidates[i].empty())
+			{
+				continue;
+			}
+
+			m_hits.clear();
+			m_world.testPairs(i, m_candidates[i], m_hits);
+			stats._numCandidatePairs += m_candidates[i].size();
+			stats._numHits += m_hits.size();
+
+			for(CollisionWorld::HullPairList::iterator it = m_hits.begin(); it != m_hits.end(); ++it)
+			{
+				m_contacts.addContact(m_world.getId(it->_indexA), m_world.getId(it->_indexB));
+			}
+		}
+		m_stats.endPhase(Stats::k_phaseNarrowphase);
+
+		sweepPointHulls();
+		m_stats.endPhase(Stats::k_phaseSweep);
+
+		m_contacts.endUpdate();
+		m_stats.endPhase(Stats::k_phaseContacts);
+
+		m_stats.endUpdate(m_world.getNumHulls());
 	}
 
-	void BasePhysics2::update()
+	const IPhysics::Stats& BasePhysics3::getStats()
 	{
-		if(!m_initialized) return;
-
-		m_pairs.clear();
+		return m_stats.getLast();
+	}
 
-		for(CollisionHullMap::iterator it = m_collisionHulls.begin();
-				it != m_collisionHulls.end(); ++it)
+	void BasePhysics3::sweepPointHulls()
+	{
+		int32 numHulls = m_world.getNumHulls();
+		for(int32 index = 0; index < numHulls; index++)
 		{
-			CollisionHullPtr hullA = it->second;
-			int32 groupA = hullA->getCollisionGroup();
+			int32 type = m_world.getType(index);
+			if((type != ICollisionHull::k_typePoint && type != ICollisionHull::k_typeCircle)
+				|| !m_world.hasPreviousPosition(index))
+			{
+				continue;
+			}
 
-			//
-			//       
-			//(   )
-			if(!m_collisionGroupFlags[groupA])
+			CollisionCasts::Ray ray;
+			float length;
+			if(!makeSweepRay(m_world.getPreviousX(index), m_world.getPreviousY(index),
+					m_world.getPositionX(index), m_world.getPositionY(index), m_world.getRadius(index), ray, length))
 			{
 				continue;
 			}
 
-			QuadTreeNode<CollisionHullPtr>* node = m_quadTree.getNodeByObject(hullA);
-			while(node != NULL)
+			m_sweepHits.clear();
+			m_stats.getCurrent()._numSweeps++;
+
+			WorldSweeper sweeper(m_world, index, ray, length, m_sweepHits);
+			castEndpoints(ray, length, sweeper);
+
+			for(std::vector<int32>::iterator it = m_sweepHits.begin(); it != m_sweepHits.end(); ++it)
 			{
-				QuadTreeNode<CollisionHullPtr>::IIterator* objectIt = node->getIterator();
-				while(!objectIt->end())
+				if(m_filter.shouldCollide(m_world.getGroup(index), m_world.getGroup(*it)))
 				{
-					CollisionHullPtr hullB = objectIt->current();
+					m_contacts.addContact(m_world.getId(index), m_world.getId(*it));
+				}
+			}
+		}
 
-					if(hullA == hullB)
-					{
-						objectIt->next();
-						continue;
-					}
+		m_world.updatePreviousPositions();
+	}
 
-					int32 groupB = hullB->getCollisionGroup();
+	void BasePhysics3::addCandidate(int32 indexA, int32 indexB)
+	{
+		int32 groupA = m_world.getGroup(indexA);
+		int32 groupB = m_world.getGroup(indexB);
 
-					//,     
-					// hullA  hullB (   )
-					if(!m_collisionGroupMatrix[groupA][groupB])
-					{
-						objectIt->next();
-						continue;
-					}
+		//same filtering as BasePhysics2: at least one of the hulls
+		//belongs to an active group and the pair of groups is enabled
+		if(!m_filter.shouldCollide(groupA, groupB))
+		{
+			return;
+		}
 
-					int32 id_a = hullA->getId();
-					int32 id_b = hullB->getId();
-					int32 hash = std::max(id_a, id_b) << 16 | std::min(id_a, id_b);
+		int32 typeA = m_world.getType(indexA);
+		int32 typeB = m_world.getType(indexB);
+		if(typeA > typeB)
+		{
+			std::swap(indexA, indexB);
+			std::swap(typeA, typeB);
+		}
 
-					if(isIntersects(hullA.get(), hullB.get()))
-					{
-						if(m_previousCollisionPairs.count(hash) > 0)
-						{
-							objectIt->next();
-							continue;
-						}
-
-						CollisionPair pair(std::max(id_a, id_b), std::min(id_a, id_b));
-						m_pairs.push_back(pair);
-						m_previousCollisionPairs.insert(hash);
-					}else
-					{
-						m_previousCollisionPairs.erase(hash);
-					}
+		CollisionWorld::HullPair pair;
+		pair._indexA = indexA;
+		pair._indexB = indexB;
 
-					objectIt->next();
-				}
+		m_candidates[CollisionWorld::getPairType(typeA, typeB)].push_back(pair);
+		m_stats.addTest(typeA, typeB);
+	}
 
-				node = node->getParentNode();
-			}
+	IPhysics::CollisionPairList& BasePhysics3::getCollidedPairs()
+	{
+		return m_contacts.getBeginPairs();
+	}
+
+	IPhysics::CollisionPairList& BasePhysics3::getContactStayPairs()
+	{
+		return m_contacts.getStayPairs();
+	}
+
+	IPhysics::CollisionPairList& BasePhysics3::getContactEndPairs()
+	{
+		return m_contacts.getEndPairs();
+	}
+
+	bool BasePhysics3::isIntersects(ICollisionHull* a, ICollisionHull* b)
+	{
+		HullLookupTable::iterator found_a = m_hullLookup.find(a->getId());
+		HullLookupTable::iterator found_b = m_hullLookup.find(b->getId());
+
+		if(found_a == m_hullLookup.end() || found_b == m_hullLookup.end())
+		{
+			return false;
 		}
+
+		return m_world.isIntersects(m_world.getIndex(found_a->second),
+				m_world.getIndex(found_b->second));
 	}
 
-	IPhysics::CollisionPairList& BasePhysics2::getCollidedPairs()
+	bool BasePhysics3::castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+			CastHit& hit, uint32 groupMask)
 	{
-		return m_pairs;
+		return castCircle(origin, 0.0f, direction, maxDistance, hit, groupMask);
 	}
 
-	bool BasePhysics2::isIntersects(ICollisionHull* a, ICollisionHull* b)
+	bool BasePhysics3::castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+			CastHit& hit, uint32 groupMask)
 	{
-		int32 aIndex = a->getType();
-		int32 bIndex = b->getType();
+		CollisionCasts::Ray ray;
+		if(!CollisionCasts::makeRay(origin, direction, radius, ray))
+		{
+			return false;
+		}
 
-		return (m_checkers[aIndex][bIndex])(a, b);
+		return cast(ray, maxDistance, hit, groupMask);
 	}
 
-	void BasePhysics2::debugDraw(Gfx* gfx)
+	template<class Visitor>
+	void BasePhysics3::castEndpoints(const CollisionCasts::Ray& ray, float maxDistance, Visitor& visitor)
 	{
-		for(CollisionHullMap::iterator it = m_collisionHulls.begin(); it != m_collisionHulls.end(); ++it)
+		//no tree to descend: hulls are visited in x order along the ray
+		//(min endpoints for rays going right, max endpoints backwards for rays
+		//going left) until the next hull starts beyond maxDistance, which
+		//the visitor shortens when it finds a hit.
+		//Hulls ending behind the origin are skipped by a binary search:
+		//no hull is wider than m_maxHullWidth
+		Point2D origin(ray._originX, ray._originY);
+		Point2D direction(ray._directionX, ray._directionY);
+		bool forward = ray._directionX >= 0.0f;
+		int32 numEndpoints = m_endpoints.size();
+
+		float startX = forward ? (ray._originX - ray._radius - m_maxHullWidth)
+				: (ray._originX + ray._radius + m_maxHullWidth);
+		int32 low = 0;
+		int32 high = numEndpoints;
+		while(low < high)
 		{
-			it->second->draw(gfx);
+			int32 middle = (low + high) / 2;
+			bool before = forward ? (m_endpoints[middle]._value < startX) : (m_endpoints[middle]._value <= startX);
+			if(before)
+			{
+				low = middle + 1;
+			}else
+			{
+				high = middle;
+			}
+		}
+
+		//forward: from the first endpoint at startX up, backward: from the last one at startX down
+		int32 numSteps = forward ? (numEndpoints - low) : low;
+		for(int32 i = 0; i < numSteps; i++)
+		{
+			const Endpoint& endpoint = m_endpoints[forward ? (low + i) : (low - 1 - i)];
+			if(endpoint._isMin != forward)
+			{
+				continue;
+			}
+
+			float reachX = ray._originX + (maxDistance * ray._directionX);
+			if(forward ? (endpoint._value - ray._radius > reachX) : (endpoint._value + ray._radius < reachX))
+			{
+				break;
+			}
+
+			int32 index = endpoint._index;
+
+			float distance;
+			Rect2D aabb(Point2D(m_world.getMinX(index), m_world.getMinY(index)),
+					Point2D(m_world.getMaxX(index), m_world.getMaxY(index)));
+			if(intersectRayRect(origin, direction, aabb, ray._radius, maxDistance, distance))
+			{
+				visitor(index, maxDistance);
+			}
+		}
+	}
+
+	bool BasePhysics3::cast(const CollisionCasts::Ray& ray, float maxDistance, CastHit& hit, uint32 groupMask)
+	{
+		if(!m_initialized) return false;
+
+		if(m_endpointsDirty)
+		{
+			sortEndpoints();
+		}
+
+		m_stats.getCurrent()._numCasts++;
+
+		WorldCaster caster(m_world, ray, groupMask);
+		castEndpoints(ray, maxDistance, caster);
+
+		return caster.getResult(hit);
+	}
+
+	void BasePhysics3::debugDraw(Gfx* gfx)
+	{
+		for(int32 i = 0; i < m_world.getNumHulls(); i++)
+		{
+			CollisionHullView hull(&m_world, m_world.getHandle(i));
+			hull.draw(gfx);
 		}
 	}
 }
@@ -4,14 +4,35 @@
 
 #include "../core/includes.h"
 #include "../gfx/gfx.h"
+#include "../system/worker_pool.h"
 
 #include "physics.h"
 #include "cell_grid.h"
+#include "collision_world.h"
+#include "collision_pairs.h"
+#include "collision_filter.h"
+#include "collision_casts.h"
+#include "scroll_layers.h"
+#include "physics_stats.h"
 
 namespace pegas
 {
+	class PointCollisionHull;
+
+	//hashed grid broadphase: hulls occupy every cell their AABB touches,
+	//the grid reports every pair with overlapping AABBs once.
+	//Hulls of scroll layers are kept in world coordinates:
+	//a new layer offset moves every hull of the layer
 	class BasePhysics: public IPhysics
 	{
+	public:
+		enum
+		{
+			k_cellLength = 250,
+			k_minBuckets = 256,
+			k_maxBuckets = 65536
+		};
+
 	public:
 		BasePhysics();
 		virtual ~BasePhysics();
@@ -19,12 +40,13 @@ namespace pegas
 		virtual void create(const Rect2D& worldSize);
 		virtual void destroy();
 
-		virtual void setCollisionGroupFlag(int32 group, bool checkCollisions) {}
-		virtual void setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions) {}
+		virtual void setCollisionGroupFlag(int32 group, bool checkCollisions);
+		virtual void setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions);
 
 		virtual bool registerPoint(int32 id, int32 group, const Vector3& position);
 		virtual bool registerCircle(int32 id, int32 group, const Vector3& position, float radius);
 		virtual bool registerPoligon(int32 id, int32 group, const PointList& points);
+		virtual bool registerBox(int32 id, int32 group, const Rect2D& box);
 		virtual void unregisterCollisionHull(int32 id);
 		
 		virtual void moveObject(int32 id, const Vector3& offset, bool absolute = true);
@@ -33,32 +55,95 @@ namespace pegas
 		
 		virtual void update();
 		virtual CollisionPairList& getCollidedPairs();
+		virtual CollisionPairList& getContactStayPairs();
+		virtual CollisionPairList& getContactEndPairs();
 
 		virtual bool isIntersects(ICollisionHull* a, ICollisionHull* b);
+		virtual bool castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups);
+		virtual bool castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups);
+
+		virtual int32 createScrollLayer();
+		virtual void setScrollLayerOffset(int32 layer, const Vector3& offset);
+		virtual Vector3 getScrollLayerOffset(int32 layer);
+		virtual bool attachToScrollLayer(int32 id, int32 layer);
+
+		virtual const Stats& getStats();
 
 		virtual void debugDraw(Gfx* gfx);
 
 	private:
-		CellGrid<ICollisionHull*> m_cellGrid;
-		CollisionHullMap m_collisionHulls;
-		CollisionPairsHashes m_previousCollisionPairs;
-		CollisionPairList m_pairs;
+		typedef CellGrid<ICollisionHull*> HullGrid;
 
-		typedef bool (*IntersectsChecker)(ICollisionHull* a, ICollisionHull* b);
-		IntersectsChecker m_checkers[ICollisionHull::k_typeTotal][ICollisionHull::k_typeTotal];
+		struct HullEntry
+		{
+			CollisionHullPtr _hull;
+			HullGrid::ObjectHandle _gridHandle;
+		};
+		typedef std::map<int32, HullEntry> HullEntryMap;
+
+		typedef std::vector<PointCollisionHull*> PointHullList;
+		typedef std::vector<ICollisionHull*> HullList;
+
+		bool addHull(CollisionHullPtr hull);
+		void updateHull(const HullEntry& entry);
+		void sweepPointHulls();
+		bool cast(const CollisionCasts::Ray& ray, float maxDistance, CastHit& hit, uint32 groupMask);
+
+		HullGrid m_cellGrid;
+		HullGrid::ObjectPairList m_gridPairs;
+		//narrowphase result of every grid pair, contacts are added in the pairs order
+		std::vector<uint8> m_gridHits;
+		HullEntryMap m_collisionHulls;
+		//points and circles, swept when they move fast
+		PointHullList m_pointHulls;
+		HullList m_sweepHits;
+		ContactTracker m_contacts;
+		CollisionFilter m_filter;
+
+		ScrollLayers m_layers;
+		std::vector<int32> m_layerHulls;
+
+		PhysicsStats m_stats;
 	};
 
-	class BasePhysics2: public IPhysics
+	//tree broadphase over SpatialIndex (QuadTree or AABBTree, see spatial_index.h).
+	//Hulls are also kept in buckets by collision group and update visits only
+	//the buckets of active groups, so static geometry costs nothing until
+	//an active hull reaches it in the tree.
+	//Both indices let a hull move a little without touching the tree: the
+	//quad trees are loose (node bounds grown by a quarter), so a hull moving
+	//inside its node's bounds is not reinserted and no hull is stuck near
+	//the root because it lies on a split line; the leaves of the AABB tree
+	//are fattened, a hull is reinserted only when it leaves its fat AABB.
+	//The fat AABB is tighter than a loose node, so moving hulls are reinserted
+	//several times more often in the AABB tree; its queries visit fewer nodes.
+	//Update gathers candidate pairs querying the trees for active hulls,
+	//then tests them in parallel: pairs are split into contiguous shards
+	//between the workers of a thread pool, every worker collects hits in
+	//its own buffer, buffers are merged and sorted by pair key, so the
+	//reported pairs and their order do not depend on the number of threads.
+	//Every scroll layer has its own tree in layer coordinates, a new layer
+	//offset moves nothing: pairs and casts across layers shift the query
+	//into the other layer. Hulls are moved only when the layer drifts
+	//too far from the tree area (rebase).
+	template<typename SpatialIndex>
+	class SpatialPhysics: public IPhysics
 	{
 	public:
 		enum
 		{
-			k_numCollisionGroups = 10
+			k_numCollisionGroups = CollisionFilter::k_maxGroups,
+			//default number of worker threads is capped by this
+			k_maxWorkerThreads = 7,
+			//fewer pairs per worker are not worth waking the threads
+			k_minPairsPerWorker = 64
 		};
 
 	public:
-		BasePhysics2();
-		virtual ~BasePhysics2();
+		SpatialPhysics();
+		virtual ~SpatialPhysics();
 
 		virtual void create(const Rect2D& worldSize);
 		virtual void destroy();
@@ -69,6 +154,7 @@ namespace pegas
 		virtual bool registerPoint(int32 id, int32 group, const Vector3& position);
 		virtual bool registerCircle(int32 id, int32 group, const Vector3& position, float radius);
 		virtual bool registerPoligon(int32 id, int32 group, const PointList& points);
+		virtual bool registerBox(int32 id, int32 group, const Rect2D& box);
 		virtual void unregisterCollisionHull(int32 id);
 
 		virtual void moveObject(int32 id, const Vector3& offset, bool absolute = true);
@@ -77,35 +163,256 @@ namespace pegas
 
 		virtual void update();
 		virtual CollisionPairList& getCollidedPairs();
+		virtual CollisionPairList& getContactStayPairs();
+		virtual CollisionPairList& getContactEndPairs();
 
 		virtual bool isIntersects(ICollisionHull* a, ICollisionHull* b);
+		virtual bool castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups);
+		virtual bool castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups);
+
+		virtual int32 createScrollLayer();
+		virtual void setScrollLayerOffset(int32 layer, const Vector3& offset);
+		virtual Vector3 getScrollLayerOffset(int32 layer);
+		virtual bool attachToScrollLayer(int32 id, int32 layer);
+
+		virtual const Stats& getStats();
+
 		virtual void debugDraw(Gfx* gfx);
 
+		//worker threads besides the updating thread, -1 (default) - one less
+		//than the number of processors. The threads are started by the first
+		//update with enough candidate pairs for two workers, a world that never
+		//has that many runs without them; takes effect on the next create()
+		void setNumWorkerThreads(int32 numThreads);
+
 	private:
-		class KeyGenPolicy
+		//raw pointers, the workers must not touch reference counters;
+		//hulls of different layers are tested with _b moved by _shift
+		struct CandidatePair
+		{
+			ICollisionHull* _a;
+			ICollisionHull* _b;
+			CollisionPairKey _key;
+			Vector3 _shift;
+		};
+		typedef std::vector<CandidatePair> CandidatePairList;
+		typedef std::vector<CollisionPairKey> PairKeyList;
+
+		class NarrowphaseTask: public IWorkerTask
 		{
 		public:
-			int32 getKeyFromObject(const IPhysics::CollisionHullPtr& object)
-			{
-				return object->getId();
-			}
+			NarrowphaseTask();
+
+			void setup(const CandidatePairList* candidates, int32 numShards);
+			virtual void run(int32 workerIndex, int32 numWorkers);
+			void mergeHits(PairKeyList& hits);
+
+		private:
+			const CandidatePairList* m_candidates;
+			int32 m_numShards;
+			std::vector<PairKeyList> m_hits;
 		};
-		typedef QuadTree<IPhysics::CollisionHullPtr, int32, KeyGenPolicy> CHQuadTree;
-		typedef bool (*IntersectsChecker)(ICollisionHull* a, ICollisionHull* b);
 
-		CHQuadTree m_quadTree;
-		IntersectsChecker m_checkers[ICollisionHull::k_typeTotal][ICollisionHull::k_typeTotal];
+		typedef std::vector<PointCollisionHull*> PointHullList;
+		typedef std::vector<ICollisionHull*> HullList;
+
+		typedef ptr<SpatialIndex> TreePtr;
+		typedef std::vector<TreePtr> TreeList;
+
+		void updateHull(const CollisionHullPtr& hull, int32 layer);
+		//hulls of the group of the hull in its layer change by delta
+		void countLayerHull(ICollisionHull* hull, int32 delta);
+		void rebaseLayer(int32 layer);
+		void addCandidate(ICollisionHull* a, ICollisionHull* b, const Vector3& shift);
+		void gatherCandidates();
+		//nodes visited by the queries and casts of all trees since the last call
+		int32 takeNodesVisited();
+		//hulls moved to another node of their tree since the last call
+		int32 takeReinsertions();
+		void testCandidates();
+		void startWorkers();
+		void sweepPointHulls();
+		bool cast(const CollisionCasts::Ray& ray, float maxDistance, CastHit& hit, uint32 groupMask);
+
+		//casts the ray of the visitor through the trees of all layers,
+		//rayShift - shift of the layer the ray is given in
+		template<class Visitor>
+		void castLayers(const Vector3& rayShift, float maxDistance, Visitor& visitor);
+
+		//one tree per scroll layer, the world layer first
+		TreeList m_trees;
+		Rect2D m_worldArea;
+		//a layer is rebased when its shift grows over this distance on any axis
+		float m_rebaseDistance;
+		ScrollLayers m_layers;
+		std::vector<int32> m_layerHulls;
+		//hulls of every group in every layer, k_numCollisionGroups counters per layer;
+		//the queries skip layers without hulls the collision mask accepts
+		std::vector<int32> m_layerGroupCounts;
+		std::vector<uint32> m_layerGroups;
+		std::vector<Vector3> m_layerShifts;
+		HullList m_queryHulls;
 		CollisionHullMap m_collisionHulls;
-		CollisionPairsHashes m_previousCollisionPairs;
-		CollisionPairList m_pairs;
+		CollisionHullMap m_groupHulls[k_numCollisionGroups];
+		//points and circles, swept when they move fast
+		PointHullList m_pointHulls;
+		HullList m_sweepHits;
+		ContactTracker m_contacts;
+
+		CandidatePairList m_candidates;
+		CollisionPairSet m_candidateKeys;
+		PairKeyList m_hits;
+		NarrowphaseTask m_narrowphaseTask;
+		WorkerPool m_workers;
+		int32 m_numWorkerThreads;
+		bool m_workersStarted;
+
+		CollisionFilter m_filter;
 
-		bool m_collisionGroupFlags[k_numCollisionGroups];
-		bool m_collisionGroupMatrix[k_numCollisionGroups][k_numCollisionGroups];
+		PhysicsStats m_stats;
 
 		bool m_initialized;
 	};
 
+	typedef QuadTree<IPhysics::CollisionHullPtr, QTLooseBoundsPolicy<125> > BP2QuadTree;
+	typedef AABBTree<IPhysics::CollisionHullPtr> BP2AABBTree;
+	typedef SpatialPhysics<BP2QuadTree> BasePhysics2;
+	typedef SpatialPhysics<BP2AABBTree> BasePhysics2BVH;
+
+	//sweep and prune broadphase: hull AABBs are projected on the x axis,
+	//endpoint array is kept sorted by insertion sort (objects move a little
+	//between frames, so the array is almost sorted and the sort is nearly linear)
+	//and overlapping pairs are collected by a single sweep over the array.
+	//Hulls are stored in CollisionWorld, the update loop reads its packed
+	//arrays directly and makes no virtual calls. Candidate pairs are grouped
+	//by the combination of hull types and every group is tested in one batch.
+	//isIntersects accepts only hulls registered in this instance.
+	//Hulls of scroll layers are kept in world coordinates, as in BasePhysics.
+	class BasePhysics3: public IPhysics
+	{
+	public:
+		enum
+		{
+			k_numCollisionGroups = CollisionFilter::k_maxGroups
+		};
+
+	public:
+		BasePhysics3();
+		virtual ~BasePhysics3();
+
+		virtual void create(const Rect2D& worldSize);
+		virtual void destroy();
 
+		virtual void setCollisionGroupFlag(int32 group, bool checkCollisions);
+		virtual void setCollisionPairGroupFlag(int32 groupA, int32 groupB, bool checkCollisions);
+
+		virtual bool registerPoint(int32 id, int32 group, const Vector3& position);
+		virtual bool registerCircle(int32 id, int32 group, const Vector3& position, float radius);
+		virtual bool registerPoligon(int32 id, int32 group, const PointList& points);
+		virtual bool registerBox(int32 id, int32 group, const Rect2D& box);
+		virtual void unregisterCollisionHull(int32 id);
+
+		virtual void moveObject(int32 id, const Vector3& offset, bool absolute = true);
+		virtual void rotateObject(int32 id, float degreesOffset, bool absolute = true);
+		virtual void transformObject(int32 id, const Matrix4x4& m);
+
+		virtual void update();
+		virtual CollisionPairList& getCollidedPairs();
+		virtual CollisionPairList& getContactStayPairs();
+		virtual CollisionPairList& getContactEndPairs();
+
+		virtual bool isIntersects(ICollisionHull* a, ICollisionHull* b);
+		virtual bool castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups);
+		virtual bool castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups);
+
+		virtual int32 createScrollLayer();
+		virtual void setScrollLayerOffset(int32 layer, const Vector3& offset);
+		virtual Vector3 getScrollLayerOffset(int32 layer);
+		virtual bool attachToScrollLayer(int32 id, int32 layer);
+
+		virtual const Stats& getStats();
+
+		virtual void debugDraw(Gfx* gfx);
+
+	private:
+		struct Endpoint
+		{
+			float _value;
+			int32 _index;
+			bool  _isMin;
+		};
+
+		//order of the endpoints on x, on equal values min endpoints go first,
+		//so touching bounds are reported as overlapping (as Rect2D::intersectsWith does)
+		struct EndpointLess
+		{
+			bool operator()(const Endpoint& a, const Endpoint& b) const
+			{
+				return a._value < b._value || (a._value == b._value && a._isMin && !b._isMin);
+			}
+		};
+
+		enum
+		{
+			//endpoint of an unregistered hull, dropped by the next sort
+			k_removedEndpoint = -1,
+			//insertion sort gives up after this many shifts per endpoint
+			k_maxShiftsPerEndpoint = 8
+		};
+
+		typedef std::vector<Endpoint> EndpointList;
+		typedef std::map<int32, HullHandle> HullLookupTable;
+
+		void addHull(HullHandle handle);
+		void sortEndpoints();
+		bool insertionSortEndpoints(int32 numEndpoints);
+		void updateEndpointPositions();
+		void addCandidate(int32 indexA, int32 indexB);
+		void sweepPointHulls();
+		bool cast(const CollisionCasts::Ray& ray, float maxDistance, CastHit& hit, uint32 groupMask);
+
+		//walks the hulls whose AABB the ray (inflated by its radius) touches
+		//not farther than maxDistance, visitor(index, maxDistance) may shorten it
+		template<class Visitor>
+		void castEndpoints(const CollisionCasts::Ray& ray, float maxDistance, Visitor& visitor);
+
+		//hulls in packed arrays, endpoints and the active list
+		//refer to them by dense index
+		CollisionWorld m_world;
+		HullLookupTable m_hullLookup;
+		EndpointList m_endpoints;
+		//endpoints before this one were sorted by the last sort,
+		//the ones after it are of hulls registered since then
+		int32 m_numSortedEndpoints;
+		//positions of the min and max endpoints of every hull, 2 * index and 2 * index + 1
+		std::vector<int32> m_endpointPositions;
+		//hulls moved since the endpoints were sorted, casts sort them first
+		bool m_endpointsDirty;
+		//widest hull on x, casts skip the endpoints that cannot reach the ray
+		float m_maxHullWidth;
+		std::vector<int32> m_activeHulls;
+		std::vector<int32> m_activeIndices;
+		std::vector<int32> m_sweepHits;
+
+		//candidate pairs of the frame, one batch per pair type
+		CollisionWorld::HullPairList m_candidates[CollisionWorld::k_numPairTypes];
+		CollisionWorld::HullPairList m_hits;
+
+		ContactTracker m_contacts;
+
+		CollisionFilter m_filter;
+
+		ScrollLayers m_layers;
+		std::vector<int32> m_layerHulls;
+
+		PhysicsStats m_stats;
+
+		bool m_initialized;
+	};
 }
 
 #endif
@@ -11,251 +11,449 @@
 
 namespace pegas
 {
-
-	template<class T>
-	class CellGrid;
-
-
-	//	.    ,   ,
-	//	    .
-	template<class T>
-	class Cell
-	{
-	public:
-		typedef typename std::set<T> ObjectList;
-		typedef typename ObjectList::iterator ObjectListIt;
-
-		//    ,    
-		//  0  7 -  .       ,
-		// ,            
-		//    (     ) -  0,
-		//    . 
-		Cell<T>* getSibling(int32 index);
-
-		//       
-		ObjectListIt begin();
-		ObjectListIt end();
-		
-	private:
-		friend class CellGrid<T>; 
-		//    CellGrid
-
-		//      
-		void init(CellGrid<T>* owner, int32 row, int32 column);
-		//   
-		void addObject(const T& object);
-		//   
-		void removeObject(const T& object);	
-
-	private:
-		CellGrid<T>*	m_owner;
-		ObjectList		m_objects;
-		int32			m_row;
-		int32			m_column;
-	};
-
-
-	//, 
+	//	 .     :  (, )
+	//	      .    ,
+	//	   AABB,       .
+	//	 -    ,    ,
+	//	        ( ).
+	//	     -      
+	//	(    ),     .
 	template<class T>
 	class CellGrid
 	{
 	public:
-		CellGrid(): m_cells(0) {}
+		typedef int32 ObjectHandle;
+		typedef std::pair<T, T> ObjectPair;
+		typedef std::vector<ObjectPair> ObjectPairList;
 
+		enum
+		{
+			k_invalidHandle = -1
+		};
 
-		//	 .       
-		//	(   )    (    
-		//	 )
+		CellGrid(): m_cellLength(0.0f), m_bucketMask(0), m_hasBounds(false), m_queryStamp(0) {}
 
-		void create(float gridWidth, float gridHeight, float cellLength);
+		//	 .       ( 
+		//	    )    (    )
+		void create(float cellLength, int32 numBuckets);
 		void destroy();
 
+		//	    ,     .
+		//	       AABB  moveObject,
+		//	  -    . moveObject  true,
+		//	     
+		ObjectHandle insertObject(const T& obj, const Rect2D& aabb);
+		bool moveObject(ObjectHandle handle, const Rect2D& aabb);
+		void removeObject(ObjectHandle handle);
 
-		//	    .      ,  
-		//	  .       ,    
-		void placeToGrid(const Vector3& position, const T& obj);
+		//	     AABB,   
+		void findPairs(ObjectPairList& pairs) const;
 
-		//     .          
-		void removeObject(const T& obj);
+		//	    origin + direction * t (direction  )  
+		//	  . visitor(object, maxDistance)      ,
+		//	 AABB,   radius,     maxDistance. visitor 
+		//	 maxDistance ( ) -  ,   
+		//	  
+		template<class Visitor>
+		void castRay(const Point2D& origin, const Point2D& direction, float radius,
+				float maxDistance, Visitor& visitor) const;
 
-		//      
-		Cell<T>* getCell(const Vector3& position);
-		Cell<T>* getCell(int32 row, int32 column);
+		int32 getNumObjects() const { return (int32)(m_entries.size() - m_freeHandles.size()); }
 
 	private:
-		Cell<T>** m_cells;
-		int32    m_numRows;
-		int32    m_numColumns;
-		float     m_width;
-		float     m_height;
-		float	  m_halfWidth;
-		float     m_halfHeight;
-		float     m_cellLength;
-
-		typedef typename std::map<T, Cell<T>*>  CellsLookupMap;
-		CellsLookupMap m_lookupMap;
+		struct CellRange
+		{
+			int32 _minColumn;
+			int32 _minRow;
+			int32 _maxColumn;
+			int32 _maxRow;
+
+			bool operator==(const CellRange& other) const
+			{
+				return _minColumn == other._minColumn && _minRow == other._minRow
+						&& _maxColumn == other._maxColumn && _maxRow == other._maxRow;
+			}
+		};
+
+		struct Entry
+		{
+			T _object;
+			Rect2D _aabb;
+			CellRange _cells;
+			bool _used;
+			//   castRay,  
+			mutable int32 _queryStamp;
+		};
+
+		typedef std::vector<ObjectHandle> Bucket;
+
+		CellRange getCellRange(const Rect2D& aabb) const;
+		int32 getBucketIndex(int32 column, int32 row) const;
+		void addToBuckets(ObjectHandle handle);
+		void removeFromBuckets(ObjectHandle handle);
+		void expandBounds(const CellRange& cells);
+
+		float m_cellLength;
+		int32 m_bucketMask;
+		std::vector<Bucket> m_buckets;
+		std::vector<Entry> m_entries;
+		std::vector<ObjectHandle> m_freeHandles;
+
+		//,   -   ( ),
+		//   castRay   
+		CellRange m_bounds;
+		bool m_hasBounds;
+		mutable int32 m_queryStamp;
 
 	private:
 		CellGrid(const CellGrid& src);
 		CellGrid& operator=(const CellGrid& src);
 	};
 
-	/*******************************************************************************************
-		Cell class functions
-	*******************************************************************************************/
+	//-----------------------------------------------------------------------------------
+	//	CellGrid class implementation
+	//------------------------------------------------------------------------------------
 	template<class T>
-	inline Cell<T>* Cell<T>::getSibling(int32 index)
+	inline void CellGrid<T>::create(float cellLength, int32 numBuckets)
 	{
-		switch(index)
+		assert(cellLength > 0 && "invalid argument");
+		assert(numBuckets > 0 && "invalid argument");
+
+		destroy();
+
+		int32 size = 1;
+		while(size < numBuckets)
 		{
-		case 0:
-			return m_owner->getCell(m_row + 1, m_column);
-		case 1:
-			return m_owner->getCell(m_row + 1, m_column + 1);
-		case 2:
-			return m_owner->getCell(m_row, m_column + 1);
-		case 3:
-			return m_owner->getCell(m_row - 1, m_column + 1);
-		case 4:
-			return m_owner->getCell(m_row - 1, m_column);
-		case 5:
-			return m_owner->getCell(m_row - 1, m_column - 1);
-		case 6:
-			return m_owner->getCell(m_row, m_column - 1);
-		case 7:
-			return m_owner->getCell(m_row + 1, m_column - 1);
-		case 8:
-			return this;
-		default:
-			break;
+			size <<= 1;
 		}
 
-		return 0;
+		m_cellLength = cellLength;
+		m_bucketMask = size - 1;
+		m_buckets.resize(size);
 	};
 
 	template<class T>
-	inline typename Cell<T>::ObjectListIt Cell<T>::begin()
+	inline void CellGrid<T>::destroy()
 	{
-		return m_objects.begin(); 
+		m_buckets.clear();
+		m_entries.clear();
+		m_freeHandles.clear();
+		m_bucketMask = 0;
+		m_hasBounds = false;
 	};
 
 	template<class T>
-	inline typename Cell<T>::ObjectListIt Cell<T>::end()
+	inline typename CellGrid<T>::ObjectHandle CellGrid<T>::insertObject(const T& obj, const Rect2D& aabb)
 	{
-		return m_objects.end();
-	};
+		assert(!m_buckets.empty() && "grid is not created");
 
-	template<class T>
-	inline void Cell<T>::init(CellGrid<T>* owner, int32 row, int32 column)
-	{
-		m_owner = owner;
-		m_row = row;
-		m_column = column;
+		ObjectHandle handle;
+		if(!m_freeHandles.empty())
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}else
+		{
+			handle = m_entries.size();
+			m_entries.push_back(Entry());
+		}
+
+		Entry& entry = m_entries[handle];
+		entry._object = obj;
+		entry._aabb = aabb;
+		entry._cells = getCellRange(aabb);
+		entry._used = true;
+		entry._queryStamp = m_queryStamp;
+
+		addToBuckets(handle);
+		expandBounds(entry._cells);
+
+		return handle;
 	};
 
 	template<class T>
-	inline void Cell<T>::addObject(const T& object)
+	inline bool CellGrid<T>::moveObject(ObjectHandle handle, const Rect2D& aabb)
 	{
-		if(m_objects.count(object) == 0)
-			m_objects.insert(object);
+		assert(handle >= 0 && handle < (ObjectHandle)m_entries.size() && m_entries[handle]._used);
+
+		Entry& entry = m_entries[handle];
+		entry._aabb = aabb;
+
+		//    -    
+		CellRange cells = getCellRange(aabb);
+		if(cells == entry._cells)
+		{
+			return false;
+		}
+
+		removeFromBuckets(handle);
+		entry._cells = cells;
+		addToBuckets(handle);
+		expandBounds(cells);
+
+		return true;
 	};
 
 	template<class T>
-	inline void Cell<T>::removeObject(const T& object)
+	inline void CellGrid<T>::removeObject(ObjectHandle handle)
 	{
-		if(m_objects.count(object) > 0)
-			m_objects.erase(object);
+		if(handle < 0 || handle >= (ObjectHandle)m_entries.size() || !m_entries[handle]._used)
+		{
+			return;
+		}
+
+		removeFromBuckets(handle);
+
+		m_entries[handle]._used = false;
+		m_entries[handle]._object = T();
+		m_freeHandles.push_back(handle);
 	};
 
-	//-----------------------------------------------------------------------------------
-	//	CellGrid class implementation
-	//------------------------------------------------------------------------------------
 	template<class T>
-	inline void CellGrid<T>::create(float gridWidth, float gridHeight, float cellLength)
+	inline void CellGrid<T>::findPairs(ObjectPairList& pairs) const
 	{
-		assert(gridWidth > 0 && "invalid argument");
-		assert(gridHeight > 0 && "invalid argument");
-		assert(cellLength > 0 && "invalid argument");
-
-		m_width = gridWidth;
-		m_height = gridHeight;
-		m_halfWidth = m_width / 2;
-		m_halfHeight = m_height / 2;
-
-		m_cellLength = cellLength;
-		m_numRows = ceil(gridWidth / cellLength);
-		m_numColumns = ceil(gridHeight / cellLength);
+		pairs.clear();
 
-		m_cells = new Cell<T>*[m_numRows];
-		for(int32 row = 0; row < m_numRows; row++)
+		for(int32 bucketIndex = 0; bucketIndex < (int32)m_buckets.size(); bucketIndex++)
 		{
-			m_cells[row] = new Cell<T>[m_numColumns];
-			for(int32 column = 0; column < m_numColumns; column++)
+			const Bucket& bucket = m_buckets[bucketIndex];
+			int32 size = bucket.size();
+
+			for(int32 i = 0; i < size; i++)
 			{
-				m_cells[row][column].init(this, row, column);
+				const Entry& a = m_entries[bucket[i]];
+
+				for(int32 j = i + 1; j < size; j++)
+				{
+					const Entry& b = m_entries[bucket[j]];
+
+					//   ,      
+					int32 column = std::max(a._cells._minColumn, b._cells._minColumn);
+					int32 row = std::max(a._cells._minRow, b._cells._minRow);
+
+					if(column > std::min(a._cells._maxColumn, b._cells._maxColumn)
+						|| row > std::min(a._cells._maxRow, b._cells._maxRow))
+					{
+						//  ,      - 
+						continue;
+					}
+
+					if(getBucketIndex(column, row) != bucketIndex)
+					{
+						continue;
+					}
+
+					if(a._aabb.intersectsWith(b._aabb))
+					{
+						pairs.push_back(ObjectPair(a._object, b._object));
+					}
+				}
 			}
 		}
 	};
 
 	template<class T>
-	inline void CellGrid<T>::destroy()
+	template<class Visitor>
+	inline void CellGrid<T>::castRay(const Point2D& origin, const Point2D& direction, float radius,
+			float maxDistance, Visitor& visitor) const
 	{
-		if(m_cells)
+		if(!m_hasBounds)
+		{
+			return;
+		}
+
+		//    
+		Rect2D bounds(Point2D(m_bounds._minColumn * m_cellLength, m_bounds._minRow * m_cellLength),
+				Point2D((m_bounds._maxColumn + 1) * m_cellLength, (m_bounds._maxRow + 1) * m_cellLength));
+
+		float t = 0.0f;
+		if(!intersectRayRect(origin, direction, bounds, radius, maxDistance, t))
+		{
+			return;
+		}
+
+		const float infinity = std::numeric_limits<float>::max();
+		float boundsExit = infinity;
+		if(direction._x != 0.0f)
+		{
+			float edge = (direction._x > 0.0f) ? (bounds._bottomRight._x + radius) : (bounds._topLeft._x - radius);
+			boundsExit = std::min(boundsExit, (edge - origin._x) / direction._x);
+		}
+		if(direction._y != 0.0f)
+		{
+			float edge = (direction._y > 0.0f) ? (bounds._bottomRight._y + radius) : (bounds._topLeft._y - radius);
+			boundsExit = std::min(boundsExit, (edge - origin._y) / direction._y);
+		}
+
+		m_queryStamp++;
+
+		//      (Amanatides, Woo),   
+		//  ,        
+		int32 column = (int32)floor((origin._x + (t * direction._x)) / m_cellLength);
+		int32 row = (int32)floor((origin._y + (t * direction._y)) / m_cellLength);
+
+		int32 stepColumn = (direction._x > 0.0f) ? 1 : -1;
+		int32 stepRow = (direction._y > 0.0f) ? 1 : -1;
+		float nextColumnT = infinity;
+		float nextRowT = infinity;
+		float deltaColumnT = infinity;
+		float deltaRowT = infinity;
+
+		if(direction._x != 0.0f)
+		{
+			float edge = (column + ((stepColumn > 0) ? 1 : 0)) * m_cellLength;
+			nextColumnT = (edge - origin._x) / direction._x;
+			deltaColumnT = m_cellLength / std::abs(direction._x);
+		}
+		if(direction._y != 0.0f)
+		{
+			float edge = (row + ((stepRow > 0) ? 1 : 0)) * m_cellLength;
+			nextRowT = (edge - origin._y) / direction._y;
+			deltaRowT = m_cellLength / std::abs(direction._y);
+		}
+
+		while(t <= std::min(maxDistance, boundsExit))
 		{
-			for(int32 row = 0; row < m_numRows; row++)
+			float exitT = std::min(std::min(nextColumnT, nextRowT), std::min(maxDistance, boundsExit));
+
+			float x0 = origin._x + (t * direction._x);
+			float y0 = origin._y + (t * direction._y);
+			float x1 = origin._x + (exitT * direction._x);
+			float y1 = origin._y + (exitT * direction._y);
+
+			Rect2D swept(Point2D(std::min(x0, x1) - radius, std::min(y0, y1) - radius),
+					Point2D(std::max(x0, x1) + radius, std::max(y0, y1) + radius));
+			CellRange cells = getCellRange(swept);
+
+			cells._minColumn = std::max(cells._minColumn, m_bounds._minColumn);
+			cells._minRow = std::max(cells._minRow, m_bounds._minRow);
+			cells._maxColumn = std::min(cells._maxColumn, m_bounds._maxColumn);
+			cells._maxRow = std::min(cells._maxRow, m_bounds._maxRow);
+
+			for(int32 cellRow = cells._minRow; cellRow <= cells._maxRow; cellRow++)
+			{
+				for(int32 cellColumn = cells._minColumn; cellColumn <= cells._maxColumn; cellColumn++)
+				{
+					const Bucket& bucket = m_buckets[getBucketIndex(cellColumn, cellRow)];
+
+					for(typename Bucket::const_iterator it = bucket.begin(); it != bucket.end(); ++it)
+					{
+						const Entry& entry = m_entries[*it];
+						if(entry._queryStamp == m_queryStamp)
+						{
+							continue;
+						}
+						entry._queryStamp = m_queryStamp;
+
+						float distance;
+						if(intersectRayRect(origin, direction, entry._aabb, radius, maxDistance, distance))
+						{
+							visitor(entry._object, maxDistance);
+						}
+					}
+				}
+			}
+
+			if(exitT >= std::min(maxDistance, boundsExit))
 			{
-				delete[] m_cells[row];		
+				break;
 			}
 
-			delete[] m_cells;
-			m_cells = 0;
+			// 
+			if(nextColumnT < nextRowT)
+			{
+				t = nextColumnT;
+				nextColumnT += deltaColumnT;
+			}else
+			{
+				t = nextRowT;
+				nextRowT += deltaRowT;
+			}
 		}
+	};
 
-		m_lookupMap.clear();
+	template<class T>
+	inline typename CellGrid<T>::CellRange CellGrid<T>::getCellRange(const Rect2D& aabb) const
+	{
+		float minX = std::min(aabb._topLeft._x, aabb._bottomRight._x);
+		float maxX = std::max(aabb._topLeft._x, aabb._bottomRight._x);
+		float minY = std::min(aabb._topLeft._y, aabb._bottomRight._y);
+		float maxY = std::max(aabb._topLeft._y, aabb._bottomRight._y);
+
+		CellRange cells;
+		cells._minColumn = (int32)floor(minX / m_cellLength);
+		cells._minRow = (int32)floor(minY / m_cellLength);
+		cells._maxColumn = (int32)floor(maxX / m_cellLength);
+		cells._maxRow = (int32)floor(maxY / m_cellLength);
+
+		return cells;
 	};
 
 	template<class T>
-	inline void CellGrid<T>::placeToGrid(const Vector3& position, const T& obj)
+	inline int32 CellGrid<T>::getBucketIndex(int32 column, int32 row) const
 	{
-		removeObject(obj);
+		uint32 hash = ((uint32)column * 73856093u) ^ ((uint32)row * 19349663u);
 
-		Cell<T>* cell = getCell(position);
-		if(cell)
-		{
-			cell->addObject(obj);
-			m_lookupMap[obj] = cell;
-		}
+		return (int32)(hash & (uint32)m_bucketMask);
 	};
 
 	template<class T>
-	inline void CellGrid<T>::removeObject(const T& obj)
+	inline void CellGrid<T>::addToBuckets(ObjectHandle handle)
 	{
-		if(m_lookupMap.count(obj) > 0)
+		const CellRange& cells = m_entries[handle]._cells;
+
+		for(int32 row = cells._minRow; row <= cells._maxRow; row++)
 		{
-			m_lookupMap[obj]->removeObject(obj);
-			m_lookupMap.erase(obj);
+			for(int32 column = cells._minColumn; column <= cells._maxColumn; column++)
+			{
+				//       ,
+				//      
+				Bucket& bucket = m_buckets[getBucketIndex(column, row)];
+				if(std::find(bucket.begin(), bucket.end(), handle) == bucket.end())
+				{
+					bucket.push_back(handle);
+				}
+			}
 		}
 	};
 
 	template<class T>
-	inline Cell<T>* CellGrid<T>::getCell(const Vector3& position)
+	inline void CellGrid<T>::expandBounds(const CellRange& cells)
 	{
-		int32 row = floor(((position._x + m_halfWidth) / m_width) * m_numRows);
-		int32 column = floor(((position._y + m_halfHeight) / m_height) * m_numColumns);
+		if(!m_hasBounds)
+		{
+			m_bounds = cells;
+			m_hasBounds = true;
 
-		return getCell(row, column);
+			return;
+		}
+
+		m_bounds._minColumn = std::min(m_bounds._minColumn, cells._minColumn);
+		m_bounds._minRow = std::min(m_bounds._minRow, cells._minRow);
+		m_bounds._maxColumn = std::max(m_bounds._maxColumn, cells._maxColumn);
+		m_bounds._maxRow = std::max(m_bounds._maxRow, cells._maxRow);
 	};
 
 	template<class T>
-	inline Cell<T>* CellGrid<T>::getCell(int32 row, int32 column)
+	inline void CellGrid<T>::removeFromBuckets(ObjectHandle handle)
 	{
-		if(row >= 0 && row < m_numRows && column >= 0 && column <  m_numColumns)
+		const CellRange& cells = m_entries[handle]._cells;
+
+		for(int32 row = cells._minRow; row <= cells._maxRow; row++)
 		{
-			return &m_cells[row][column];
+			for(int32 column = cells._minColumn; column <= cells._maxColumn; column++)
+			{
+				Bucket& bucket = m_buckets[getBucketIndex(column, row)];
+				typename Bucket::iterator it = std::find(bucket.begin(), bucket.end(), handle);
+				if(it != bucket.end())
+				{
+					//    
+					*it = bucket.back();
+					bucket.pop_back();
+				}
+			}
 		}
-		return 0;
 	};
-
 }
 
 #endif
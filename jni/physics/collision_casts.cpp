@@ -0,0 +1,234 @@
+#include "../common.h"
+#include "collision_casts.h"
+#include "collisions.h"
+
+namespace pegas
+{
+	//------------------------------------------------------------------------------------------------
+	//	CollisionCasts class implementation
+	//------------------------------------------------------------------------------------------------
+	bool CollisionCasts::makeRay(const Vector3& origin, const Vector3& direction, float radius, Ray& ray)
+	{
+		float length = sqrt((direction._x * direction._x) + (direction._y * direction._y));
+		if(length == 0.0f)
+		{
+			return false;
+		}
+
+		ray._originX = origin._x;
+		ray._originY = origin._y;
+		ray._directionX = direction._x / length;
+		ray._directionY = direction._y / length;
+		ray._radius = radius;
+
+		return true;
+	}
+
+	bool CollisionCasts::castCircle(const Ray& ray, float x, float y, float radius, float maxDistance, Hit& hit)
+	{
+		float mx = ray._originX - x;
+		float my = ray._originY - y;
+		float sumRadius = radius + ray._radius;
+		float c = (mx * mx) + (my * my) - (sumRadius * sumRadius);
+
+		if(c < 0.0f)
+		{
+			//starts inside
+			float length = sqrt((mx * mx) + (my * my));
+
+			hit._distance = 0.0f;
+			hit._normalX = (length > 0.0f) ? (mx / length) : -ray._directionX;
+			hit._normalY = (length > 0.0f) ? (my / length) : -ray._directionY;
+
+			return true;
+		}
+
+		//moving away or nothing to hit
+		float b = (mx * ray._directionX) + (my * ray._directionY);
+		if(b > 0.0f || sumRadius <= 0.0f)
+		{
+			return false;
+		}
+
+		float discriminant = (b * b) - c;
+		if(discriminant < 0.0f)
+		{
+			return false;
+		}
+
+		float t = std::max(0.0f, -b - sqrt(discriminant));
+		if(t > maxDistance)
+		{
+			return false;
+		}
+
+		hit._distance = t;
+		hit._normalX = (mx + (t * ray._directionX)) / sumRadius;
+		hit._normalY = (my + (t * ray._directionY)) / sumRadius;
+
+		return true;
+	}
+
+	bool CollisionCasts::castPolygon(const Ray& ray, const float* vertexX, const float* vertexY, int32 stride,
+			int32 numVertices, float maxDistance, Hit& hit)
+	{
+		if(numVertices < 2)
+		{
+			return (numVertices == 1) && castCircle(ray, vertexX[0], vertexY[0], 0.0f, maxDistance, hit);
+		}
+
+		//the centroid tells which side of an edge is outside, whatever the winding
+		float centerX = 0.0f;
+		float centerY = 0.0f;
+		for(int32 i = 0; i < numVertices; i++)
+		{
+			centerX += vertexX[i * stride];
+			centerY += vertexY[i * stride];
+		}
+		centerX /= numVertices;
+		centerY /= numVertices;
+
+		float radius = ray._radius;
+		bool insidePolygon = true;
+		bool insideBand = false;
+		bool found = false;
+		float bestDistance = maxDistance;
+
+		for(int32 i = 0; i < numVertices; i++)
+		{
+			int32 next = (i == (numVertices - 1)) ? 0 : i + 1;
+
+			float x0 = vertexX[i * stride];
+			float y0 = vertexY[i * stride];
+			float edgeX = vertexX[next * stride] - x0;
+			float edgeY = vertexY[next * stride] - y0;
+			float lengthSq = (edgeX * edgeX) + (edgeY * edgeY);
+			if(lengthSq == 0.0f)
+			{
+				continue;
+			}
+
+			//outward unit normal
+			float length = sqrt(lengthSq);
+			float normalX = edgeY / length;
+			float normalY = -edgeX / length;
+			if(((centerX - x0) * normalX) + ((centerY - y0) * normalY) > 0.0f)
+			{
+				normalX = -normalX;
+				normalY = -normalY;
+			}
+
+			//distance of the origin from the edge line, positive outside
+			float deviation = ((ray._originX - x0) * normalX) + ((ray._originY - y0) * normalY);
+			if(deviation > 0.0f)
+			{
+				insidePolygon = false;
+
+				float projection = ((ray._originX - x0) * edgeX) + ((ray._originY - y0) * edgeY);
+				if(deviation < radius && projection >= 0.0f && projection <= lengthSq)
+				{
+					insideBand = true;
+				}
+			}
+
+			//crossing of the edge shifted out by the radius, entering only
+			float speed = (ray._directionX * normalX) + (ray._directionY * normalY);
+			if(speed >= 0.0f || deviation < radius)
+			{
+				continue;
+			}
+
+			float t = (radius - deviation) / speed;
+			if(t > bestDistance)
+			{
+				continue;
+			}
+
+			float hitX = ray._originX + (t * ray._directionX) - x0;
+			float hitY = ray._originY + (t * ray._directionY) - y0;
+			float projection = (hitX * edgeX) + (hitY * edgeY);
+			if(projection < 0.0f || projection > lengthSq)
+			{
+				continue;
+			}
+
+			found = true;
+			bestDistance = t;
+			hit._distance = t;
+			hit._normalX = normalX;
+			hit._normalY = normalY;
+		}
+
+		if(insidePolygon || insideBand)
+		{
+			hit._distance = 0.0f;
+			hit._normalX = -ray._directionX;
+			hit._normalY = -ray._directionY;
+
+			return true;
+		}
+
+		//rounded corners of the inflated polygon
+		if(radius > 0.0f)
+		{
+			Hit vertexHit;
+			for(int32 i = 0; i < numVertices; i++)
+			{
+				if(castCircle(ray, vertexX[i * stride], vertexY[i * stride], 0.0f, bestDistance, vertexHit)
+					&& (!found || vertexHit._distance < bestDistance))
+				{
+					found = true;
+					bestDistance = vertexHit._distance;
+					hit = vertexHit;
+				}
+			}
+		}
+
+		return found;
+	}
+
+	bool CollisionCasts::castHull(ICollisionHull* hull, const Ray& ray, float maxDistance, Hit& hit)
+	{
+		switch(hull->getType())
+		{
+		case ICollisionHull::k_typePoint:
+			{
+				const Vector3& position = static_cast<PointCollisionHull*>(hull)->getCurrentPosition();
+
+				return castCircle(ray, position._x, position._y, 0.0f, maxDistance, hit);
+			}
+		case ICollisionHull::k_typeCircle:
+			{
+				CircleCollisionHull* circle = static_cast<CircleCollisionHull*>(hull);
+				const Vector3& position = circle->getCurrentPosition();
+
+				return castCircle(ray, position._x, position._y, circle->getRadius(), maxDistance, hit);
+			}
+		case ICollisionHull::k_typePolygon:
+		case ICollisionHull::k_typeBox:
+			{
+				const IPhysics::PointList& points = static_cast<PoligonCollisionHull*>(hull)->getPoints();
+				if(points.empty())
+				{
+					return false;
+				}
+
+				return castPolygon(ray, &points[0]._x, &points[0]._y, sizeof(Vector3) / sizeof(float),
+						points.size(), maxDistance, hit);
+			}
+		default:
+			break;
+		}
+
+		return false;
+	}
+
+	void CollisionCasts::makeCastHit(int32 id, const Ray& ray, const Hit& hit, IPhysics::CastHit& result)
+	{
+		result._id = id;
+		result._distance = hit._distance;
+		result._normal = Vector3(hit._normalX, hit._normalY, 0.0f);
+		result._point = Vector3(ray._originX + (hit._distance * ray._directionX) - (hit._normalX * ray._radius),
+				ray._originY + (hit._distance * ray._directionY) - (hit._normalY * ray._radius), 0.0f);
+	}
+}
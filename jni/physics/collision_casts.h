@@ -0,0 +1,57 @@
+#ifndef PEGAS_PHYSICS_COLLISION_CASTS_H
+#define PEGAS_PHYSICS_COLLISION_CASTS_H
+#pragma once
+
+#include "../core/includes.h"
+
+#include "physics.h"
+
+namespace pegas
+{
+	//-------------------------------------------------------------------------
+	//	Ray and circle casts against single shapes. A circle cast is a ray
+	//	cast against the shape inflated by the circle radius (Minkowski sum),
+	//	a ray cast is a circle cast of radius 0. Distances are measured along
+	//	the unit direction of the ray; a ray starting inside the inflated
+	//	shape hits it at distance 0 with the normal against the direction.
+	//	Polygons are expected to be convex, of any winding.
+	//-------------------------------------------------------------------------
+	class CollisionCasts
+	{
+	public:
+		struct Ray
+		{
+			float _originX;
+			float _originY;
+			//unit length
+			float _directionX;
+			float _directionY;
+			//radius of the cast circle, 0 for rays
+			float _radius;
+		};
+
+		struct Hit
+		{
+			float _distance;
+			float _normalX;
+			float _normalY;
+		};
+
+		//fills the ray from IPhysics arguments, false for a zero direction
+		static bool makeRay(const Vector3& origin, const Vector3& direction, float radius, Ray& ray);
+
+		//circle (point if radius is 0) at (x, y)
+		static bool castCircle(const Ray& ray, float x, float y, float radius, float maxDistance, Hit& hit);
+		//vertex i at (vertexX[i * stride], vertexY[i * stride])
+		static bool castPolygon(const Ray& ray, const float* vertexX, const float* vertexY, int32 stride,
+				int32 numVertices, float maxDistance, Hit& hit);
+
+		//cast against any hull, dispatched by the hull type
+		static bool castHull(ICollisionHull* hull, const Ray& ray, float maxDistance, Hit& hit);
+
+		//fills IPhysics::CastHit, the contact point lies on the hull surface
+		static void makeCastHit(int32 id, const Ray& ray, const Hit& hit, IPhysics::CastHit& result);
+	};
+}
+
+#endif
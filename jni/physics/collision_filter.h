@@ -0,0 +1,86 @@
+#ifndef PEGAS_PHYSICS_COLLISION_FILTER_H
+#define PEGAS_PHYSICS_COLLISION_FILTER_H
+#pragma once
+
+#include "../core/includes.h"
+
+namespace pegas
+{
+	//-------------------------------------------------------------------------
+	//	Collision groups as bits of 32 bit masks: one mask of the active
+	//	groups (hulls of these groups look for collisions with neighbours)
+	//	and for every group the mask of groups it may collide with, kept
+	//	symmetric. A pair of hulls is tested when at least one of them is
+	//	in an active group and their groups may collide.
+	//-------------------------------------------------------------------------
+	class CollisionFilter
+	{
+	public:
+		enum
+		{
+			k_maxGroups = 32
+		};
+
+		CollisionFilter()
+		{
+			reset();
+		}
+
+		void reset()
+		{
+			m_activeGroups = 0;
+			for(int32 i = 0; i < k_maxGroups; i++)
+			{
+				m_collisionMasks[i] = 0;
+			}
+		}
+
+		void setGroupActive(int32 group, bool active)
+		{
+			assert(isValidGroup(group) && "collision group out of range");
+
+			if(isValidGroup(group))
+			{
+				m_activeGroups = active ? (m_activeGroups | getBit(group)) : (m_activeGroups & ~getBit(group));
+			}
+		}
+
+		void setPairEnabled(int32 groupA, int32 groupB, bool enabled)
+		{
+			assert(isValidGroup(groupA) && isValidGroup(groupB) && "collision group out of range");
+
+			if(isValidGroup(groupA) && isValidGroup(groupB))
+			{
+				if(enabled)
+				{
+					m_collisionMasks[groupA] |= getBit(groupB);
+					m_collisionMasks[groupB] |= getBit(groupA);
+				}else
+				{
+					m_collisionMasks[groupA] &= ~getBit(groupB);
+					m_collisionMasks[groupB] &= ~getBit(groupA);
+				}
+			}
+		}
+
+		uint32 getActiveGroups() const { return m_activeGroups; }
+		uint32 getCollisionMask(int32 group) const { return m_collisionMasks[group]; }
+
+		bool isGroupActive(int32 group) const { return (m_activeGroups & getBit(group)) != 0; }
+		bool isPairEnabled(int32 groupA, int32 groupB) const { return (m_collisionMasks[groupA] & getBit(groupB)) != 0; }
+
+		bool shouldCollide(int32 groupA, int32 groupB) const
+		{
+			return ((m_activeGroups & (getBit(groupA) | getBit(groupB))) != 0) && isPairEnabled(groupA, groupB);
+		}
+
+		static bool isValidGroup(int32 group) { return group >= 0 && group < k_maxGroups; }
+		static uint32 getBit(int32 group) { return (uint32)1 << group; }
+
+	private:
+		uint32 m_activeGroups;
+		uint32 m_collisionMasks[k_maxGroups];
+	};
+}
+
+#endif
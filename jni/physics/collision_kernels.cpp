@@ -0,0 +1,246 @@
+#include "../common.h"
+#include "collision_kernels.h"
+
+#if defined(PEGAS_USE_SSE2)
+#include <emmintrin.h>
+#elif defined(PEGAS_USE_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace pegas
+{
+	namespace
+	{
+		//reference expressions, the vector code repeats them lane by lane
+		inline bool testCircleEdge(float x, float y, float radiusSq,
+				const CollisionKernels::EdgeArrays& edges, int32 i)
+		{
+			float dx = x - edges._vertexX[i];
+			float dy = y - edges._vertexY[i];
+			if(((dx * dx) + (dy * dy)) < radiusSq)
+			{
+				return true;
+			}
+
+			//deviation from the edge line and projection of the center
+			//on the edge (0 at the start, lengthSq at the end)
+			float deviation = (edges._a[i] * x) + (edges._b[i] * y) + edges._c[i];
+			float projection = (edges._b[i] * dx) - (edges._a[i] * dy);
+
+			return ((deviation * deviation) < (radiusSq * edges._lengthSq[i]))
+					&& (projection >= 0.0f) && (projection <= edges._lengthSq[i]);
+		}
+
+		inline uint8 testCircleCircle(float ax, float ay, float ar, float bx, float by, float br)
+		{
+			float dx = ax - bx;
+			float dy = ay - by;
+			float r = ar + br;
+
+			return (((dx * dx) + (dy * dy)) < (r * r)) ? 1 : 0;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	//	CollisionKernels class implementation
+	//------------------------------------------------------------------------------------------------
+	bool CollisionKernels::circlePolygonScalar(float x, float y, float radius,
+			const EdgeArrays& edges, int32 first, int32 numEdges)
+	{
+		float radiusSq = radius * radius;
+
+		for(int32 i = first; i < (first + numEdges); i++)
+		{
+			if(testCircleEdge(x, y, radiusSq, edges, i))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void CollisionKernels::circleCircleScalar(const float* ax, const float* ay, const float* ar,
+			const float* bx, const float* by, const float* br, int32 count, uint8* results)
+	{
+		for(int32 i = 0; i < count; i++)
+		{
+			results[i] = testCircleCircle(ax[i], ay[i], ar[i], bx[i], by[i], br[i]);
+		}
+	}
+
+#if defined(PEGAS_USE_SSE2)
+
+	bool CollisionKernels::circlePolygon(float x, float y, float radius,
+			const EdgeArrays& edges, int32 first, int32 numEdges)
+	{
+		float radiusSq = radius * radius;
+
+		const __m128 vx = _mm_set1_ps(x);
+		const __m128 vy = _mm_set1_ps(y);
+		const __m128 vRadiusSq = _mm_set1_ps(radiusSq);
+		const __m128 zero = _mm_setzero_ps();
+
+		int32 last = first + numEdges;
+		int32 i = first;
+
+		//four edges at once
+		for(; (i + 4) <= last; i += 4)
+		{
+			__m128 dx = _mm_sub_ps(vx, _mm_loadu_ps(edges._vertexX + i));
+			__m128 dy = _mm_sub_ps(vy, _mm_loadu_ps(edges._vertexY + i));
+			__m128 distanceSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+			__m128 hit = _mm_cmplt_ps(distanceSq, vRadiusSq);
+
+			__m128 a = _mm_loadu_ps(edges._a + i);
+			__m128 b = _mm_loadu_ps(edges._b + i);
+			__m128 c = _mm_loadu_ps(edges._c + i);
+			__m128 lengthSq = _mm_loadu_ps(edges._lengthSq + i);
+
+			__m128 deviation = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, vx), _mm_mul_ps(b, vy)), c);
+			__m128 projection = _mm_sub_ps(_mm_mul_ps(b, dx), _mm_mul_ps(a, dy));
+
+			__m128 near = _mm_cmplt_ps(_mm_mul_ps(deviation, deviation), _mm_mul_ps(vRadiusSq, lengthSq));
+			near = _mm_and_ps(near, _mm_cmpge_ps(projection, zero));
+			near = _mm_and_ps(near, _mm_cmple_ps(projection, lengthSq));
+
+			if(_mm_movemask_ps(_mm_or_ps(hit, near)) != 0)
+			{
+				return true;
+			}
+		}
+
+		for(; i < last; i++)
+		{
+			if(testCircleEdge(x, y, radiusSq, edges, i))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void CollisionKernels::circleCircle(const float* ax, const float* ay, const float* ar,
+			const float* bx, const float* by, const float* br, int32 count, uint8* results)
+	{
+		int32 i = 0;
+
+		for(; (i + 4) <= count; i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(ax + i), _mm_loadu_ps(bx + i));
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(ay + i), _mm_loadu_ps(by + i));
+			__m128 r = _mm_add_ps(_mm_loadu_ps(ar + i), _mm_loadu_ps(br + i));
+			__m128 distanceSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+			int32 mask = _mm_movemask_ps(_mm_cmplt_ps(distanceSq, _mm_mul_ps(r, r)));
+
+			results[i + 0] = mask & 1;
+			results[i + 1] = (mask >> 1) & 1;
+			results[i + 2] = (mask >> 2) & 1;
+			results[i + 3] = (mask >> 3) & 1;
+		}
+
+		for(; i < count; i++)
+		{
+			results[i] = testCircleCircle(ax[i], ay[i], ar[i], bx[i], by[i], br[i]);
+		}
+	}
+
+#elif defined(PEGAS_USE_NEON)
+
+	bool CollisionKernels::circlePolygon(float x, float y, float radius,
+			const EdgeArrays& edges, int32 first, int32 numEdges)
+	{
+		float radiusSq = radius * radius;
+
+		const float32x4_t vx = vdupq_n_f32(x);
+		const float32x4_t vy = vdupq_n_f32(y);
+		const float32x4_t vRadiusSq = vdupq_n_f32(radiusSq);
+		const float32x4_t zero = vdupq_n_f32(0.0f);
+
+		int32 last = first + numEdges;
+		int32 i = first;
+
+		//four edges at once
+		for(; (i + 4) <= last; i += 4)
+		{
+			float32x4_t dx = vsubq_f32(vx, vld1q_f32(edges._vertexX + i));
+			float32x4_t dy = vsubq_f32(vy, vld1q_f32(edges._vertexY + i));
+			float32x4_t distanceSq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+			uint32x4_t hit = vcltq_f32(distanceSq, vRadiusSq);
+
+			float32x4_t a = vld1q_f32(edges._a + i);
+			float32x4_t b = vld1q_f32(edges._b + i);
+			float32x4_t c = vld1q_f32(edges._c + i);
+			float32x4_t lengthSq = vld1q_f32(edges._lengthSq + i);
+
+			float32x4_t deviation = vaddq_f32(vaddq_f32(vmulq_f32(a, vx), vmulq_f32(b, vy)), c);
+			float32x4_t projection = vsubq_f32(vmulq_f32(b, dx), vmulq_f32(a, dy));
+
+			uint32x4_t near = vcltq_f32(vmulq_f32(deviation, deviation), vmulq_f32(vRadiusSq, lengthSq));
+			near = vandq_u32(near, vcgeq_f32(projection, zero));
+			near = vandq_u32(near, vcleq_f32(projection, lengthSq));
+
+			uint32x4_t any = vorrq_u32(hit, near);
+			uint32x2_t any2 = vorr_u32(vget_low_u32(any), vget_high_u32(any));
+			if((vget_lane_u32(any2, 0) | vget_lane_u32(any2, 1)) != 0)
+			{
+				return true;
+			}
+		}
+
+		for(; i < last; i++)
+		{
+			if(testCircleEdge(x, y, radiusSq, edges, i))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void CollisionKernels::circleCircle(const float* ax, const float* ay, const float* ar,
+			const float* bx, const float* by, const float* br, int32 count, uint8* results)
+	{
+		int32 i = 0;
+		uint32 mask[4];
+
+		for(; (i + 4) <= count; i += 4)
+		{
+			float32x4_t dx = vsubq_f32(vld1q_f32(ax + i), vld1q_f32(bx + i));
+			float32x4_t dy = vsubq_f32(vld1q_f32(ay + i), vld1q_f32(by + i));
+			float32x4_t r = vaddq_f32(vld1q_f32(ar + i), vld1q_f32(br + i));
+			float32x4_t distanceSq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+
+			vst1q_u32(mask, vcltq_f32(distanceSq, vmulq_f32(r, r)));
+
+			results[i + 0] = mask[0] ? 1 : 0;
+			results[i + 1] = mask[1] ? 1 : 0;
+			results[i + 2] = mask[2] ? 1 : 0;
+			results[i + 3] = mask[3] ? 1 : 0;
+		}
+
+		for(; i < count; i++)
+		{
+			results[i] = testCircleCircle(ax[i], ay[i], ar[i], bx[i], by[i], br[i]);
+		}
+	}
+
+#else
+
+	bool CollisionKernels::circlePolygon(float x, float y, float radius,
+			const EdgeArrays& edges, int32 first, int32 numEdges)
+	{
+		return circlePolygonScalar(x, y, radius, edges, first, numEdges);
+	}
+
+	void CollisionKernels::circleCircle(const float* ax, const float* ay, const float* ar,
+			const float* bx, const float* by, const float* br, int32 count, uint8* results)
+	{
+		circleCircleScalar(ax, ay, ar, bx, by, br, count, results);
+	}
+
+#endif
+}
@@ -0,0 +1,54 @@
+#ifndef PEGAS_PHYSICS_COLLISION_KERNELS_H
+#define PEGAS_PHYSICS_COLLISION_KERNELS_H
+#pragma once
+
+#include "../core/includes.h"
+
+namespace pegas
+{
+	//-------------------------------------------------------------------------
+	//	Narrowphase kernels over packed arrays, compared by squared distances.
+	//	Every kernel has a scalar reference version and a vector version
+	//	(SSE2 or NEON, see PEGAS_USE_SSE2/PEGAS_USE_NEON in common.h) which
+	//	evaluates the same expressions in the same order without fused
+	//	multiply-add, so both return exactly the same results.
+	//	Without vector instructions the vector version is the scalar one.
+	//-------------------------------------------------------------------------
+	class CollisionKernels
+	{
+	public:
+		enum
+		{
+			//number of pairs the batched kernels take at once
+			k_batchSize = 64
+		};
+
+		//polygon edges: edge i starts at (vertexX[i], vertexY[i]) and lies
+		//on the line A*x + B*y + C = 0, lengthSq = A*A + B*B
+		struct EdgeArrays
+		{
+			const float* _vertexX;
+			const float* _vertexY;
+			const float* _a;
+			const float* _b;
+			const float* _c;
+			const float* _lengthSq;
+		};
+
+		//circle intersects the polygon when it is closer than the radius
+		//to a vertex or to an edge within the edge's length
+		static bool circlePolygonScalar(float x, float y, float radius,
+				const EdgeArrays& edges, int32 first, int32 numEdges);
+		static bool circlePolygon(float x, float y, float radius,
+				const EdgeArrays& edges, int32 first, int32 numEdges);
+
+		//circle/circle test of count (not more than k_batchSize) pairs
+		//gathered into arrays, results[i] is set to 1 for intersecting pairs
+		static void circleCircleScalar(const float* ax, const float* ay, const float* ar,
+				const float* bx, const float* by, const float* br, int32 count, uint8* results);
+		static void circleCircle(const float* ax, const float* ay, const float* ar,
+				const float* bx, const float* by, const float* br, int32 count, uint8* results);
+	};
+}
+
+#endif
@@ -0,0 +1,220 @@
+#include "../common.h"
+#include "collision_pairs.h"
+
+namespace pegas
+{
+	//------------------------------------------------------------------------------------------------
+	//	CollisionPairSet class implementation
+	//------------------------------------------------------------------------------------------------
+	const CollisionPairKey CollisionPairSet::k_emptyKey = 0;
+
+	CollisionPairSet::CollisionPairSet()
+		:m_size(0), m_mask(-1)
+	{
+
+	}
+
+	CollisionPairKey CollisionPairSet::makeKey(int32 idA, int32 idB)
+	{
+		assert(idA != idB && "pair of a hull with itself");
+
+		int32 first = std::max(idA, idB);
+		int32 second = std::min(idA, idB);
+
+		return ((CollisionPairKey)(uint32)first << 32) | (CollisionPairKey)(uint32)second;
+	}
+
+	bool CollisionPairSet::insert(CollisionPairKey key)
+	{
+		assert(key != k_emptyKey && "invalid pair key");
+
+		if(((m_size + 1) * 2) > (int32)m_keys.size())
+		{
+			grow();
+		}
+
+		int32 slot = getHomeSlot(key);
+		while(m_keys[slot] != k_emptyKey)
+		{
+			if(m_keys[slot] == key)
+			{
+				return false;
+			}
+
+			slot = (slot + 1) & m_mask;
+		}
+
+		m_keys[slot] = key;
+		m_size++;
+
+		return true;
+	}
+
+	bool CollisionPairSet::contains(CollisionPairKey key) const
+	{
+		return findSlot(key) >= 0;
+	}
+
+	bool CollisionPairSet::erase(CollisionPairKey key)
+	{
+		int32 hole = findSlot(key);
+		if(hole < 0)
+		{
+			return false;
+		}
+
+		//move back the keys of the probe chain behind the hole,
+		//unless a key would be moved before its home slot
+		int32 slot = hole;
+		while(true)
+		{
+			slot = (slot + 1) & m_mask;
+			if(m_keys[slot] == k_emptyKey)
+			{
+				break;
+			}
+
+			int32 home = getHomeSlot(m_keys[slot]);
+			bool between = (hole <= slot) ? (hole < home && home <= slot) : (hole < home || home <= slot);
+			if(between)
+			{
+				continue;
+			}
+
+			m_keys[hole] = m_keys[slot];
+			hole = slot;
+		}
+
+		m_keys[hole] = k_emptyKey;
+		m_size--;
+
+		return true;
+	}
+
+	void CollisionPairSet::clear()
+	{
+		if(m_size > 0)
+		{
+			std::fill(m_keys.begin(), m_keys.end(), k_emptyKey);
+			m_size = 0;
+		}
+	}
+
+	void CollisionPairSet::swap(CollisionPairSet& other)
+	{
+		m_keys.swap(other.m_keys);
+		std::swap(m_size, other.m_size);
+		std::swap(m_mask, other.m_mask);
+	}
+
+	int32 CollisionPairSet::findSlot(CollisionPairKey key) const
+	{
+		if(m_size == 0)
+		{
+			return -1;
+		}
+
+		int32 slot = getHomeSlot(key);
+		while(m_keys[slot] != k_emptyKey)
+		{
+			if(m_keys[slot] == key)
+			{
+				return slot;
+			}
+
+			slot = (slot + 1) & m_mask;
+		}
+
+		return -1;
+	}
+
+	int32 CollisionPairSet::getHomeSlot(CollisionPairKey key) const
+	{
+		//64 bit finalizer of MurmurHash3, ids of neighbour objects are close
+		//to each other and have to be spread over the whole table
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+
+		return (int32)(key & (uint32)m_mask);
+	}
+
+	void CollisionPairSet::grow()
+	{
+		std::vector<CollisionPairKey> keys;
+		keys.swap(m_keys);
+
+		int32 numSlots = keys.empty() ? 64 : (keys.size() * 2);
+		m_keys.resize(numSlots, k_emptyKey);
+		m_mask = numSlots - 1;
+		m_size = 0;
+
+		for(std::vector<CollisionPairKey>::iterator it = keys.begin(); it != keys.end(); ++it)
+		{
+			if(*it != k_emptyKey)
+			{
+				insert(*it);
+			}
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------
+	//	ContactTracker class implementation
+	//------------------------------------------------------------------------------------------------
+	void ContactTracker::beginUpdate()
+	{
+		m_currentPairs.clear();
+		m_beginPairs.clear();
+		m_stayPairs.clear();
+		m_endPairs.clear();
+	}
+
+	void ContactTracker::addContact(int32 idA, int32 idB)
+	{
+		CollisionPairKey key = CollisionPairSet::makeKey(idA, idB);
+		if(!m_currentPairs.insert(key))
+		{
+			return;
+		}
+
+		IPhysics::CollisionPair pair(CollisionPairSet::getFirstId(key), CollisionPairSet::getSecondId(key));
+		if(m_previousPairs.contains(key))
+		{
+			m_stayPairs.push_back(pair);
+		}else
+		{
+			m_beginPairs.push_back(pair);
+		}
+	}
+
+	void ContactTracker::endUpdate()
+	{
+		for(int32 i = 0; i < m_previousPairs.getNumSlots(); i++)
+		{
+			if(!m_previousPairs.isUsed(i))
+			{
+				continue;
+			}
+
+			CollisionPairKey key = m_previousPairs.getKey(i);
+			if(!m_currentPairs.contains(key))
+			{
+				IPhysics::CollisionPair pair(CollisionPairSet::getFirstId(key), CollisionPairSet::getSecondId(key));
+				m_endPairs.push_back(pair);
+			}
+		}
+
+		m_previousPairs.swap(m_currentPairs);
+	}
+
+	void ContactTracker::clear()
+	{
+		m_previousPairs.clear();
+		m_currentPairs.clear();
+		m_beginPairs.clear();
+		m_stayPairs.clear();
+		m_endPairs.clear();
+	}
+}
@@ -0,0 +1,89 @@
+#ifndef PEGAS_PHYSICS_COLLISION_PAIRS_H
+#define PEGAS_PHYSICS_COLLISION_PAIRS_H
+#pragma once
+
+#include "../core/includes.h"
+
+#include "physics.h"
+
+namespace pegas
+{
+	typedef uint64 CollisionPairKey;
+
+	//-------------------------------------------------------------------------
+	//	Set of pair keys in one flat array with open addressing: linear
+	//	probing on insert and lookup, backward shift on erase (no tombstones).
+	//	The array grows by doubling when it is half full and never shrinks,
+	//	so a set reused from frame to frame stops allocating after warm up.
+	//-------------------------------------------------------------------------
+	class CollisionPairSet
+	{
+	public:
+		CollisionPairSet();
+
+		//key of the unordered pair of hull ids, the larger id in the high word
+		static CollisionPairKey makeKey(int32 idA, int32 idB);
+		static int32 getFirstId(CollisionPairKey key) { return (int32)(uint32)(key >> 32); }
+		static int32 getSecondId(CollisionPairKey key) { return (int32)(uint32)key; }
+
+		//returns false if the key is already in the set
+		bool insert(CollisionPairKey key);
+		bool contains(CollisionPairKey key) const;
+		//returns false if there was no such key
+		bool erase(CollisionPairKey key);
+		void clear();
+		void swap(CollisionPairSet& other);
+
+		int32 size() const { return m_size; }
+		bool empty() const { return m_size == 0; }
+
+		//iteration over the slots: for(i = 0; i < getNumSlots(); i++) if(isUsed(i)) getKey(i)
+		int32 getNumSlots() const { return m_keys.size(); }
+		bool isUsed(int32 slot) const { return m_keys[slot] != k_emptyKey; }
+		CollisionPairKey getKey(int32 slot) const { return m_keys[slot]; }
+
+	private:
+		//ids of a pair are different, so a key of two equal ids marks empty slots
+		static const CollisionPairKey k_emptyKey;
+
+		int32 findSlot(CollisionPairKey key) const;
+		int32 getHomeSlot(CollisionPairKey key) const;
+		void grow();
+
+		std::vector<CollisionPairKey> m_keys;
+		int32 m_size;
+		int32 m_mask;
+	};
+
+	//-------------------------------------------------------------------------
+	//	Contact state of hull pairs between updates. Every update the physics
+	//	calls beginUpdate(), then addContact() for each intersecting pair (a
+	//	pair added twice counts once) and endUpdate(). Pairs are then sorted
+	//	into three lists: contact begin (not intersecting in the previous
+	//	update), contact stay and contact end (intersecting in the previous
+	//	update, but not in this one). A pair of an unregistered hull ends on
+	//	the next update. Pairs are (larger id, smaller id), like the pair keys.
+	//-------------------------------------------------------------------------
+	class ContactTracker
+	{
+	public:
+		void beginUpdate();
+		void addContact(int32 idA, int32 idB);
+		void endUpdate();
+		void clear();
+
+		IPhysics::CollisionPairList& getBeginPairs() { return m_beginPairs; }
+		IPhysics::CollisionPairList& getStayPairs() { return m_stayPairs; }
+		IPhysics::CollisionPairList& getEndPairs() { return m_endPairs; }
+
+	private:
+		CollisionPairSet m_previousPairs;
+		CollisionPairSet m_currentPairs;
+
+		IPhysics::CollisionPairList m_beginPairs;
+		IPhysics::CollisionPairList m_stayPairs;
+		IPhysics::CollisionPairList m_endPairs;
+	};
+}
+
+#endif
@@ -0,0 +1,734 @@
+#include "../common.h"
+#include "collision_world.h"
+
+namespace pegas
+{
+	//------------------------------------------------------------------------------------------------
+	//	CollisionWorld class implementation
+	//------------------------------------------------------------------------------------------------
+	CollisionWorld::CollisionWorld()
+	{
+
+	}
+
+	void CollisionWorld::clear()
+	{
+		m_ids.clear();
+		m_types.clear();
+		m_groups.clear();
+		m_minX.clear();
+		m_minY.clear();
+		m_maxX.clear();
+		m_maxY.clear();
+		m_positionX.clear();
+		m_positionY.clear();
+		m_initialX.clear();
+		m_initialY.clear();
+		m_previousX.clear();
+		m_previousY.clear();
+		m_hasPreviousPosition.clear();
+		m_radius.clear();
+		m_firstVertex.clear();
+		m_numVertices.clear();
+
+		m_vertexX.clear();
+		m_vertexY.clear();
+		m_initialVertexX.clear();
+		m_initialVertexY.clear();
+		m_edgeA.clear();
+		m_edgeB.clear();
+		m_edgeC.clear();
+		m_edgeLengthSq.clear();
+
+		m_handleToIndex.clear();
+		m_indexToHandle.clear();
+		m_freeHandles.clear();
+	}
+
+	HullHandle CollisionWorld::createHull(int32 id, int32 group, int32 type, const Vector3& position)
+	{
+		HullHandle handle;
+		if(m_freeHandles.empty())
+		{
+			handle = m_handleToIndex.size();
+			m_handleToIndex.push_back(k_invalidHandle);
+		}else
+		{
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+		}
+
+		int32 index = m_ids.size();
+		m_handleToIndex[handle] = index;
+		m_indexToHandle.push_back(handle);
+
+		m_ids.push_back(id);
+		m_types.push_back(type);
+		m_groups.push_back(group);
+		m_minX.push_back(position._x);
+		m_minY.push_back(position._y);
+		m_maxX.push_back(position._x);
+		m_maxY.push_back(position._y);
+		m_positionX.push_back(position._x);
+		m_positionY.push_back(position._y);
+		m_initialX.push_back(position._x);
+		m_initialY.push_back(position._y);
+		m_previousX.push_back(position._x);
+		m_previousY.push_back(position._y);
+		m_hasPreviousPosition.push_back(0);
+		m_radius.push_back(0.0f);
+		m_firstVertex.push_back(m_vertexX.size());
+		m_numVertices.push_back(0);
+
+		return handle;
+	}
+
+	HullHandle CollisionWorld::createPoint(int32 id, int32 group, const Vector3& position)
+	{
+		return createHull(id, group, ICollisionHull::k_typePoint, position);
+	}
+
+	HullHandle CollisionWorld::createCircle(int32 id, int32 group, const Vector3& position, float radius)
+	{
+		HullHandle handle = createHull(id, group, ICollisionHull::k_typeCircle, position);
+		int32 index = m_handleToIndex[handle];
+
+		m_radius[index] = radius;
+		updateBounds(index);
+
+		return handle;
+	}
+
+	HullHandle CollisionWorld::createPolygon(int32 id, int32 group, const IPhysics::PointList& points)
+	{
+		Vector3 position;
+		for(size_t i = 0; i < points.size(); i++)
+		{
+			position = position + points[i];
+		}
+		position = position / points.size();
+
+		HullHandle handle = createHull(id, group, ICollisionHull::k_typePolygon, position);
+		int32 index = m_handleToIndex[handle];
+
+		m_numVertices[index] = points.size();
+		for(size_t i = 0; i < points.size(); i++)
+		{
+			m_vertexX.push_back(points[i]._x);
+			m_vertexY.push_back(points[i]._y);
+			m_initialVertexX.push_back(points[i]._x);
+			m_initialVertexY.push_back(points[i]._y);
+		}
+		m_edgeA.resize(m_vertexX.size());
+		m_edgeB.resize(m_vertexX.size());
+		m_edgeC.resize(m_vertexX.size());
+		m_edgeLengthSq.resize(m_vertexX.size());
+		updateBounds(index);
+
+		return handle;
+	}
+
+	void CollisionWorld::destroyHull(HullHandle handle)
+	{
+		int32 index = m_handleToIndex[handle];
+		int32 last = m_ids.size() - 1;
+
+		//polygon vertices are kept packed: cut the range out
+		//and shift the ranges of the polygons stored after it
+		int32 firstVertex = m_firstVertex[index];
+		int32 numVertices = m_numVertices[index];
+		if(numVertices > 0)
+		{
+			m_vertexX.erase(m_vertexX.begin() + firstVertex, m_vertexX.begin() + firstVertex + numVertices);
+			m_vertexY.erase(m_vertexY.begin() + firstVertex, m_vertexY.begin() + firstVertex + numVertices);
+			m_initialVertexX.erase(m_initialVertexX.begin() + firstVertex,
+					m_initialVertexX.begin() + firstVertex + numVertices);
+			m_initialVertexY.erase(m_initialVertexY.begin() + firstVertex,
+					m_initialVertexY.begin() + firstVertex + numVertices);
+			m_edgeA.erase(m_edgeA.begin() + firstVertex, m_edgeA.begin() + firstVertex + numVertices);
+			m_edgeB.erase(m_edgeB.begin() + firstVertex, m_edgeB.begin() + firstVertex + numVertices);
+			m_edgeC.erase(m_edgeC.begin() + firstVertex, m_edgeC.begin() + firstVertex + numVertices);
+			m_edgeLengthSq.erase(m_edgeLengthSq.begin() + firstVertex,
+					m_edgeLengthSq.begin() + firstVertex + numVertices);
+
+			for(int32 i = 0; i <= last; i++)
+			{
+				if(m_firstVertex[i] > firstVertex)
+				{
+					m_firstVertex[i] -= numVertices;
+				}
+			}
+		}
+
+		//last hull takes the freed slot
+		if(index != last)
+		{
+			m_ids[index] = m_ids[last];
+			m_types[index] = m_types[last];
+			m_groups[index] = m_groups[last];
+			m_minX[index] = m_minX[last];
+			m_minY[index] = m_minY[last];
+			m_maxX[index] = m_maxX[last];
+			m_maxY[index] = m_maxY[last];
+			m_positionX[index] = m_positionX[last];
+			m_positionY[index] = m_positionY[last];
+			m_initialX[index] = m_initialX[last];
+			m_initialY[index] = m_initialY[last];
+			m_previousX[index] = m_previousX[last];
+			m_previousY[index] = m_previousY[last];
+			m_hasPreviousPosition[index] = m_hasPreviousPosition[last];
+			m_radius[index] = m_radius[last];
+			m_firstVertex[index] = m_firstVertex[last];
+			m_numVertices[index] = m_numVertices[last];
+
+			HullHandle lastHandle = m_indexToHandle[last];
+			m_indexToHandle[index] = lastHandle;
+			m_handleToIndex[lastHandle] = index;
+		}
+
+		m_ids.pop_back();
+		m_types.pop_back();
+		m_groups.pop_back();
+		m_minX.pop_back();
+		m_minY.pop_back();
+		m_maxX.pop_back();
+		m_maxY.pop_back();
+		m_positionX.pop_back();
+		m_positionY.pop_back();
+		m_initialX.pop_back();
+		m_initialY.pop_back();
+		m_previousX.pop_back();
+		m_previousY.pop_back();
+		m_hasPreviousPosition.pop_back();
+		m_radius.pop_back();
+		m_firstVertex.pop_back();
+		m_numVertices.pop_back();
+		m_indexToHandle.pop_back();
+
+		m_handleToIndex[handle] = k_invalidHandle;
+		m_freeHandles.push_back(handle);
+	}
+
+	void CollisionWorld::updatePreviousPositions()
+	{
+		m_previousX = m_positionX;
+		m_previousY = m_positionY;
+		std::fill(m_hasPreviousPosition.begin(), m_hasPreviousPosition.end(), 1);
+	}
+
+	void CollisionWorld::moveHull(HullHandle handle, const Vector3& offset, bool absolute)
+	{
+		int32 index = m_handleToIndex[handle];
+
+		int32 first = m_firstVertex[index];
+		int32 last = first + m_numVertices[index];
+		for(int32 i = first; i < last; i++)
+		{
+			m_vertexX[i] = (absolute ? m_initialVertexX[i] : m_vertexX[i]) + offset._x;
+			m_vertexY[i] = (absolute ? m_initialVertexY[i] : m_vertexY[i]) + offset._y;
+		}
+
+		m_positionX[index] = (absolute ? m_initialX[index] : m_positionX[index]) + offset._x;
+		m_positionY[index] = (absolute ? m_initialY[index] : m_positionY[index]) + offset._y;
+
+		updateBounds(index);
+	}
+
+	void CollisionWorld::rotateHull(HullHandle handle, float degreesOffset, bool absolute)
+	{
+		int32 index = m_handleToIndex[handle];
+
+		Matrix4x4 mat;
+		mat.identity();
+		mat.rotateZ(degreesOffset);
+
+		int32 first = m_firstVertex[index];
+		int32 last = first + m_numVertices[index];
+		for(int32 i = first; i < last; i++)
+		{
+			Vector3 point = absolute ? Vector3(m_initialVertexX[i], m_initialVertexY[i], 0.0f)
+					: Vector3(m_vertexX[i], m_vertexY[i], 0.0f);
+			point = point * mat;
+
+			m_vertexX[i] = point._x;
+			m_vertexY[i] = point._y;
+		}
+
+		Vector3 position = absolute ? Vector3(m_initialX[index], m_initialY[index], 0.0f)
+				: Vector3(m_positionX[index], m_positionY[index], 0.0f);
+		position = position * mat;
+
+		m_positionX[index] = position._x;
+		m_positionY[index] = position._y;
+
+		updateBounds(index);
+	}
+
+	void CollisionWorld::transformHull(HullHandle handle, const Matrix4x4& m)
+	{
+		int32 index = m_handleToIndex[handle];
+
+		int32 first = m_firstVertex[index];
+		int32 last = first + m_numVertices[index];
+		for(int32 i = first; i < last; i++)
+		{
+			Vector3 point = Vector3(m_initialVertexX[i], m_initialVertexY[i], 0.0f) * m;
+
+			m_vertexX[i] = point._x;
+			m_vertexY[i] = point._y;
+		}
+
+		Vector3 position = Vector3(m_initialX[index], m_initialY[index], 0.0f) * m;
+
+		m_positionX[index] = position._x;
+		m_positionY[index] = position._y;
+
+		updateBounds(index);
+	}
+
+	void CollisionWorld::updateBounds(int32 index)
+	{
+		switch(m_types[index])
+		{
+		case ICollisionHull::k_typeCircle:
+			{
+				float radius = m_radius[index];
+
+				m_minX[index] = m_positionX[index] - radius;
+				m_minY[index] = m_positionY[index] - radius;
+				m_maxX[index] = m_positionX[index] + radius;
+				m_maxY[index] = m_positionY[index] + radius;
+			}
+			break;
+		case ICollisionHull::k_typePolygon:
+		case ICollisionHull::k_typeBox:
+			{
+				int32 first = m_firstVertex[index];
+				int32 last = first + m_numVertices[index];
+
+				float minX = m_vertexX[first];
+				float minY = m_vertexY[first];
+				float maxX = minX;
+				float maxY = minY;
+
+				for(int32 i = first; i < last; i++)
+				{
+					int32 i1 = (i == (last - 1)) ? first : i + 1;
+
+					m_edgeA[i] = m_vertexY[i] - m_vertexY[i1];
+					m_edgeB[i] = m_vertexX[i1] - m_vertexX[i];
+					m_edgeC[i] = (m_vertexX[i] * m_vertexY[i1]) - (m_vertexX[i1] * m_vertexY[i]);
+					m_edgeLengthSq[i] = (m_edgeA[i] * m_edgeA[i]) + (m_edgeB[i] * m_edgeB[i]);
+
+					minX = std::min(minX, m_vertexX[i]);
+					minY = std::min(minY, m_vertexY[i]);
+					maxX = std::max(maxX, m_vertexX[i]);
+					maxY = std::max(maxY, m_vertexY[i]);
+				}
+
+				m_minX[index] = minX;
+				m_minY[index] = minY;
+				m_maxX[index] = maxX;
+				m_maxY[index] = maxY;
+
+				//4-point polygon with axis aligned edges is a box and is tested by
+				//its bounds, turned off the axes it is a polygon again
+				m_types[index] = isAxisAligned(first, last - first)
+						? ICollisionHull::k_typeBox : ICollisionHull::k_typePolygon;
+			}
+			break;
+		default:
+			m_minX[index] = m_maxX[index] = m_positionX[index];
+			m_minY[index] = m_maxY[index] = m_positionY[index];
+			break;
+		}
+	}
+
+	bool CollisionWorld::castHull(int32 index, const CollisionCasts::Ray& ray,
+			float maxDistance, CollisionCasts::Hit& hit) const
+	{
+		switch(m_types[index])
+		{
+		case ICollisionHull::k_typePoint:
+			return CollisionCasts::castCircle(ray, m_positionX[index], m_positionY[index], 0.0f, maxDistance, hit);
+		case ICollisionHull::k_typeCircle:
+			return CollisionCasts::castCircle(ray, m_positionX[index], m_positionY[index],
+					m_radius[index], maxDistance, hit);
+		case ICollisionHull::k_typePolygon:
+		case ICollisionHull::k_typeBox:
+			{
+				int32 first = m_firstVertex[index];
+
+				return CollisionCasts::castPolygon(ray, &m_vertexX[first], &m_vertexY[first], 1,
+						m_numVertices[index], maxDistance, hit);
+			}
+		default:
+			break;
+		}
+
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	//	Collision checkers, same math as in Intersections, over the packed arrays
+	//-----------------------------------------------------------------------------------------------
+	bool CollisionWorld::isIntersects(int32 indexA, int32 indexB) const
+	{
+		int32 typeA = m_types[indexA];
+		int32 typeB = m_types[indexB];
+
+		if(typeA > typeB)
+		{
+			std::swap(indexA, indexB);
+			std::swap(typeA, typeB);
+		}
+
+		switch(typeA)
+		{
+		case ICollisionHull::k_typePoint:
+			switch(typeB)
+			{
+			case ICollisionHull::k_typePoint:
+				return testPointPoint(indexA, indexB);
+			case ICollisionHull::k_typeCircle:
+				return testPointCircle(indexA, indexB);
+			case ICollisionHull::k_typePolygon:
+				return testPointPolygon(indexA, indexB);
+			case ICollisionHull::k_typeBox:
+				return testPointBox(indexA, indexB);
+			}
+			break;
+		case ICollisionHull::k_typeCircle:
+			switch(typeB)
+			{
+			case ICollisionHull::k_typeCircle:
+				return testCircleCircle(indexA, indexB);
+			case ICollisionHull::k_typePolygon:
+				return testCirclePolygon(indexA, indexB);
+			case ICollisionHull::k_typeBox:
+				return testCircleBox(indexA, indexB);
+			}
+			break;
+		case ICollisionHull::k_typePolygon:
+			//box keeps its vertices and edges, against a polygon it is a polygon
+			return testPolygonPolygon(indexA, indexB);
+		case ICollisionHull::k_typeBox:
+			return testBoxBox(indexA, indexB);
+		}
+
+		return false;
+	}
+
+	template<bool (CollisionWorld::*kernel)(int32, int32) const>
+	void CollisionWorld::testBatch(const HullPairList& pairs, HullPairList& hits) const
+	{
+		for(HullPairList::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+		{
+			if((this->*kernel)(it->_indexA, it->_indexB))
+			{
+				hits.push_back(*it);
+			}
+		}
+	}
+
+	void CollisionWorld::testPairs(int32 pairType, const HullPairList& pairs, HullPairList& hits) const
+	{
+		enum
+		{
+			k_point = ICollisionHull::k_typePoint,
+			k_circle = ICollisionHull::k_typeCircle,
+			k_polygon = ICollisionHull::k_typePolygon,
+			k_box = ICollisionHull::k_typeBox
+		};
+
+		switch(pairType)
+		{
+		case (k_point * ICollisionHull::k_typeTotal) + k_point:
+			testBatch<&CollisionWorld::testPointPoint>(pairs, hits);
+			break;
+		case (k_point * ICollisionHull::k_typeTotal) + k_circle:
+			testBatch<&CollisionWorld::testPointCircle>(pairs, hits);
+			break;
+		case (k_point * ICollisionHull::k_typeTotal) + k_polygon:
+			testBatch<&CollisionWorld::testPointPolygon>(pairs, hits);
+			break;
+		case (k_circle * ICollisionHull::k_typeTotal) + k_circle:
+			testCircleCircleBatch(pairs, hits);
+			break;
+		case (k_circle * ICollisionHull::k_typeTotal) + k_polygon:
+			testCirclePolygonBatch(pairs, hits);
+			break;
+		case (k_polygon * ICollisionHull::k_typeTotal) + k_polygon:
+		case (k_polygon * ICollisionHull::k_typeTotal) + k_box:
+			testBatch<&CollisionWorld::testPolygonPolygon>(pairs, hits);
+			break;
+		case (k_point * ICollisionHull::k_typeTotal) + k_box:
+			testBatch<&CollisionWorld::testPointBox>(pairs, hits);
+			break;
+		case (k_circle * ICollisionHull::k_typeTotal) + k_box:
+			testBatch<&CollisionWorld::testCircleBox>(pairs, hits);
+			break;
+		case (k_box * ICollisionHull::k_typeTotal) + k_box:
+			testBatch<&CollisionWorld::testBoxBox>(pairs, hits);
+			break;
+		default:
+			assert(false && "pair type with the types in descending order");
+			break;
+		}
+	}
+
+	bool CollisionWorld::testPointPoint(int32 a, int32 b) const
+	{
+		const float epsilon = 0.001;
+		bool b1 = std::abs(m_positionX[a] - m_positionX[b]) < epsilon;
+		bool b2 = std::abs(m_positionY[a] - m_positionY[b]) < epsilon;
+
+		return (b1 && b2);
+	}
+
+	bool CollisionWorld::testPointCircle(int32 point, int32 circle) const
+	{
+		float dx = m_positionX[point] - m_positionX[circle];
+		float dy = m_positionY[point] - m_positionY[circle];
+
+		return ((dx * dx) + (dy * dy)) <= (m_radius[circle] * m_radius[circle]);
+	}
+
+	bool CollisionWorld::testPointPolygon(int32 point, int32 polygon) const
+	{
+		float x = m_positionX[point];
+		float y = m_positionY[point];
+
+		int32 first = m_firstVertex[polygon];
+		int32 last = first + m_numVertices[polygon];
+
+		for(int32 i = first; i < last; i++)
+		{
+			float D = (m_edgeA[i] * x) + (m_edgeB[i] * y) + m_edgeC[i];
+			if(D > 0)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool CollisionWorld::testCircleCircle(int32 a, int32 b) const
+	{
+		uint8 result;
+		CollisionKernels::circleCircleScalar(&m_positionX[a], &m_positionY[a], &m_radius[a],
+				&m_positionX[b], &m_positionY[b], &m_radius[b], 1, &result);
+
+		return (result != 0);
+	}
+
+	bool CollisionWorld::testCirclePolygon(int32 circle, int32 polygon) const
+	{
+		return CollisionKernels::circlePolygon(m_positionX[circle], m_positionY[circle], m_radius[circle],
+				getEdgeArrays(), m_firstVertex[polygon], m_numVertices[polygon]);
+	}
+
+	void CollisionWorld::testCircleCircleBatch(const HullPairList& pairs, HullPairList& hits) const
+	{
+		//positions and radii are gathered into small arrays,
+		//the kernel tests k_batchSize pairs at once
+		float ax[CollisionKernels::k_batchSize];
+		float ay[CollisionKernels::k_batchSize];
+		float ar[CollisionKernels::k_batchSize];
+		float bx[CollisionKernels::k_batchSize];
+		float by[CollisionKernels::k_batchSize];
+		float br[CollisionKernels::k_batchSize];
+		uint8 results[CollisionKernels::k_batchSize];
+
+		int32 numPairs = pairs.size();
+		for(int32 start = 0; start < numPairs; start += CollisionKernels::k_batchSize)
+		{
+			int32 count = std::min((int32)CollisionKernels::k_batchSize, numPairs - start);
+
+			for(int32 i = 0; i < count; i++)
+			{
+				const HullPair& pair = pairs[start + i];
+
+				ax[i] = m_positionX[pair._indexA];
+				ay[i] = m_positionY[pair._indexA];
+				ar[i] = m_radius[pair._indexA];
+				bx[i] = m_positionX[pair._indexB];
+				by[i] = m_positionY[pair._indexB];
+				br[i] = m_radius[pair._indexB];
+			}
+
+			CollisionKernels::circleCircle(ax, ay, ar, bx, by, br, count, results);
+
+			for(int32 i = 0; i < count; i++)
+			{
+				if(results[i] != 0)
+				{
+					hits.push_back(pairs[start + i]);
+				}
+			}
+		}
+	}
+
+	void CollisionWorld::testCirclePolygonBatch(const HullPairList& pairs, HullPairList& hits) const
+	{
+		CollisionKernels::EdgeArrays edges = getEdgeArrays();
+
+		for(HullPairList::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+		{
+			int32 circle = it->_indexA;
+			int32 polygon = it->_indexB;
+
+			if(CollisionKernels::circlePolygon(m_positionX[circle], m_positionY[circle], m_radius[circle],
+					edges, m_firstVertex[polygon], m_numVertices[polygon]))
+			{
+				hits.push_back(*it);
+			}
+		}
+	}
+
+	CollisionKernels::EdgeArrays CollisionWorld::getEdgeArrays() const
+	{
+		CollisionKernels::EdgeArrays edges;
+
+		bool empty = m_vertexX.empty();
+		edges._vertexX = empty ? NULL : &m_vertexX[0];
+		edges._vertexY = empty ? NULL : &m_vertexY[0];
+		edges._a = empty ? NULL : &m_edgeA[0];
+		edges._b = empty ? NULL : &m_edgeB[0];
+		edges._c = empty ? NULL : &m_edgeC[0];
+		edges._lengthSq = empty ? NULL : &m_edgeLengthSq[0];
+
+		return edges;
+	}
+
+	bool CollisionWorld::testPointBox(int32 point, int32 box) const
+	{
+		float x = m_positionX[point];
+		float y = m_positionY[point];
+
+		return (x >= m_minX[box]) && (x <= m_maxX[box]) && (y >= m_minY[box]) && (y <= m_maxY[box]);
+	}
+
+	bool CollisionWorld::testCircleBox(int32 circle, int32 box) const
+	{
+		//distance from the center to the closest point of the box
+		float x = std::min(std::max(m_positionX[circle], m_minX[box]), m_maxX[box]);
+		float y = std::min(std::max(m_positionY[circle], m_minY[box]), m_maxY[box]);
+		float dx = m_positionX[circle] - x;
+		float dy = m_positionY[circle] - y;
+
+		return ((dx * dx) + (dy * dy)) < (m_radius[circle] * m_radius[circle]);
+	}
+
+	bool CollisionWorld::testBoxBox(int32 a, int32 b) const
+	{
+		return (m_minX[a] < m_maxX[b]) && (m_minX[b] < m_maxX[a])
+				&& (m_minY[a] < m_maxY[b]) && (m_minY[b] < m_maxY[a]);
+	}
+
+	bool CollisionWorld::isAxisAligned(int32 first, int32 numVertices) const
+	{
+		//same rule as BoxCollisionHull::isAxisAligned
+		if(numVertices != 4)
+		{
+			return false;
+		}
+
+		bool horizontal[4];
+		for(int32 i = 0; i < 4; i++)
+		{
+			int32 i0 = first + i;
+			int32 i1 = first + ((i + 1) % 4);
+
+			bool sameX = (m_vertexX[i0] == m_vertexX[i1]);
+			bool sameY = (m_vertexY[i0] == m_vertexY[i1]);
+			if(sameX == sameY)
+			{
+				return false;
+			}
+
+			horizontal[i] = sameY;
+		}
+
+		return (horizontal[0] != horizontal[1]) && (horizontal[0] == horizontal[2])
+				&& (horizontal[1] == horizontal[3]);
+	}
+
+	bool CollisionWorld::testPolygonPolygon(int32 a, int32 b) const
+	{
+		//mirrors Intersections::isIntersectsPolygonPolygon:
+		//separated when all the vertices of one polygon lie outside of the same edge of the other
+		int32 firstA = m_firstVertex[a];
+		int32 lastA = firstA + m_numVertices[a];
+		int32 firstB = m_firstVertex[b];
+		int32 lastB = firstB + m_numVertices[b];
+
+		for(int32 pass = 0; pass < 2; pass++)
+		{
+			for(int32 j = firstB; j < lastB; j++)
+			{
+				int32 i = firstA;
+				while(i < lastA && (m_vertexX[i] * m_edgeA[j]) + (m_vertexY[i] * m_edgeB[j]) + m_edgeC[j] > 0)
+				{
+					i++;
+				}
+
+				if(i == lastA)
+				{
+					return false;
+				}
+			}
+
+			std::swap(firstA, firstB);
+			std::swap(lastA, lastB);
+		}
+
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------
+	//	CollisionHullView class implementation
+	//------------------------------------------------------------------------------------------------
+	CollisionHullView::CollisionHullView(CollisionWorld* world, HullHandle handle)
+		:ICollisionHull(world->getId(world->getIndex(handle)), world->getGroup(world->getIndex(handle))),
+		 m_world(world), m_handle(handle)
+	{
+
+	}
+
+	int32 CollisionHullView::getType()
+	{
+		return m_world->getType(m_world->getIndex(m_handle));
+	}
+
+	void CollisionHullView::moveObject(const Vector3& offset, bool absolute)
+	{
+		m_world->moveHull(m_handle, offset, absolute);
+	}
+
+	void CollisionHullView::rotateObject(float degreesOffset, bool absolute)
+	{
+		m_world->rotateHull(m_handle, degreesOffset, absolute);
+	}
+
+	void CollisionHullView::transformObject(const Matrix4x4& m)
+	{
+		m_world->transformHull(m_handle, m);
+	}
+
+	Vector3 CollisionHullView::getPosition()
+	{
+		int32 index = m_world->getIndex(m_handle);
+
+		return Vector3(m_world->getPositionX(index), m_world->getPositionY(index), 0.0f);
+	}
+
+	Rect2D CollisionHullView::getAABB()
+	{
+		int32 index = m_world->getIndex(m_handle);
+
+		return Rect2D(Point2D(m_world->getMinX(index), m_world->getMinY(index)),
+				Point2D(m_world->getMaxX(index), m_world->getMaxY(index)));
+	}
+}
@@ -0,0 +1,182 @@
+#ifndef PEGAS_PHYSICS_COLLISION_WORLD_H
+#define PEGAS_PHYSICS_COLLISION_WORLD_H
+#pragma once
+
+#include "../core/includes.h"
+
+#include "physics.h"
+#include "collision_kernels.h"
+#include "collision_casts.h"
+
+namespace pegas
+{
+	typedef int32 HullHandle;
+
+	//-------------------------------------------------------------------------
+	//	Collision hulls stored as structure of arrays.
+	//	Every hull has a stable handle and a dense index: hull data lives at
+	//	the dense index in packed arrays (type, group, AABB, position, radius,
+	//	polygon vertex range), removal moves the last hull into the freed slot.
+	//	Polygon vertices of all hulls share one pair of coordinate buffers.
+	//	A polygon of 4 points with axis aligned edges has the type k_typeBox
+	//	and is tested by its bounds until it is turned off the axes.
+	//-------------------------------------------------------------------------
+	class CollisionWorld
+	{
+	public:
+		enum
+		{
+			k_invalidHandle = -1,
+			k_numPairTypes = ICollisionHull::k_typeTotal * ICollisionHull::k_typeTotal
+		};
+
+		//candidate pair by dense indices, the type of the first hull
+		//is not greater than the type of the second one
+		struct HullPair
+		{
+			int32 _indexA;
+			int32 _indexB;
+		};
+		typedef std::vector<HullPair> HullPairList;
+
+	public:
+		CollisionWorld();
+
+		void clear();
+
+		HullHandle createPoint(int32 id, int32 group, const Vector3& position);
+		HullHandle createCircle(int32 id, int32 group, const Vector3& position, float radius);
+		HullHandle createPolygon(int32 id, int32 group, const IPhysics::PointList& points);
+		void destroyHull(HullHandle handle);
+
+		void moveHull(HullHandle handle, const Vector3& offset, bool absolute);
+		void rotateHull(HullHandle handle, float degreesOffset, bool absolute);
+		void transformHull(HullHandle handle, const Matrix4x4& m);
+
+		//narrowphase test of two hulls by their dense indices
+		bool isIntersects(int32 indexA, int32 indexB) const;
+
+		//pairs of one type combination form a batch, all pairs of the batch
+		//are tested by the same kernel; intersecting pairs are appended to hits
+		static int32 getPairType(int32 typeA, int32 typeB) { return (typeA * ICollisionHull::k_typeTotal) + typeB; }
+		void testPairs(int32 pairType, const HullPairList& pairs, HullPairList& hits) const;
+
+		//ray or circle cast against one hull by its dense index
+		bool castHull(int32 index, const CollisionCasts::Ray& ray, float maxDistance, CollisionCasts::Hit& hit) const;
+
+		int32 getNumHulls() const { return m_ids.size(); }
+		int32 getIndex(HullHandle handle) const { return m_handleToIndex[handle]; }
+		HullHandle getHandle(int32 index) const { return m_indexToHandle[index]; }
+
+		int32 getId(int32 index) const { return m_ids[index]; }
+		int32 getType(int32 index) const { return m_types[index]; }
+		int32 getGroup(int32 index) const { return m_groups[index]; }
+		float getMinX(int32 index) const { return m_minX[index]; }
+		float getMinY(int32 index) const { return m_minY[index]; }
+		float getMaxX(int32 index) const { return m_maxX[index]; }
+		float getMaxY(int32 index) const { return m_maxY[index]; }
+		float getPositionX(int32 index) const { return m_positionX[index]; }
+		float getPositionY(int32 index) const { return m_positionY[index]; }
+		float getRadius(int32 index) const { return m_radius[index]; }
+
+		//positions at the last physics update, fast hulls are swept from them;
+		//a hull created after the last update has no previous position
+		bool hasPreviousPosition(int32 index) const { return m_hasPreviousPosition[index] != 0; }
+		float getPreviousX(int32 index) const { return m_previousX[index]; }
+		float getPreviousY(int32 index) const { return m_previousY[index]; }
+		void updatePreviousPositions();
+		void offsetPreviousPosition(int32 index, const Vector3& offset)
+		{
+			m_previousX[index] += offset._x;
+			m_previousY[index] += offset._y;
+		}
+
+	private:
+		HullHandle createHull(int32 id, int32 group, int32 type, const Vector3& position);
+		void updateBounds(int32 index);
+
+		bool testPointPoint(int32 a, int32 b) const;
+		bool testPointCircle(int32 point, int32 circle) const;
+		bool testPointPolygon(int32 point, int32 polygon) const;
+		bool testCircleCircle(int32 a, int32 b) const;
+		bool testCirclePolygon(int32 circle, int32 polygon) const;
+		bool testPolygonPolygon(int32 a, int32 b) const;
+		bool testPointBox(int32 point, int32 box) const;
+		bool testCircleBox(int32 circle, int32 box) const;
+		bool testBoxBox(int32 a, int32 b) const;
+
+		bool isAxisAligned(int32 first, int32 numVertices) const;
+
+		template<bool (CollisionWorld::*kernel)(int32, int32) const>
+		void testBatch(const HullPairList& pairs, HullPairList& hits) const;
+		void testCircleCircleBatch(const HullPairList& pairs, HullPairList& hits) const;
+		void testCirclePolygonBatch(const HullPairList& pairs, HullPairList& hits) const;
+
+		CollisionKernels::EdgeArrays getEdgeArrays() const;
+
+		//per hull data, indexed by the dense index
+		std::vector<int32> m_ids;
+		std::vector<int32> m_types;
+		std::vector<int32> m_groups;
+		std::vector<float> m_minX;
+		std::vector<float> m_minY;
+		std::vector<float> m_maxX;
+		std::vector<float> m_maxY;
+		std::vector<float> m_positionX;
+		std::vector<float> m_positionY;
+		std::vector<float> m_initialX;
+		std::vector<float> m_initialY;
+		std::vector<float> m_previousX;
+		std::vector<float> m_previousY;
+		std::vector<uint8> m_hasPreviousPosition;
+		std::vector<float> m_radius;
+		std::vector<int32> m_firstVertex;
+		std::vector<int32> m_numVertices;
+
+		//polygon vertices, current and initial (as registered),
+		//and edge lines A*x + B*y + C = 0 from the vertex i to the next one
+		//with squared lengths A*A + B*B, recalculated whenever the vertices change
+		std::vector<float> m_vertexX;
+		std::vector<float> m_vertexY;
+		std::vector<float> m_initialVertexX;
+		std::vector<float> m_initialVertexY;
+		std::vector<float> m_edgeA;
+		std::vector<float> m_edgeB;
+		std::vector<float> m_edgeC;
+		std::vector<float> m_edgeLengthSq;
+
+		std::vector<int32> m_handleToIndex;
+		std::vector<HullHandle> m_indexToHandle;
+		std::vector<HullHandle> m_freeHandles;
+
+	private:
+		CollisionWorld(const CollisionWorld& other);
+		CollisionWorld& operator=(const CollisionWorld& other);
+	};
+
+	//ICollisionHull interface over a hull stored in CollisionWorld,
+	//holds nothing but the world and the handle
+	class CollisionHullView: public ICollisionHull
+	{
+	public:
+		CollisionHullView(CollisionWorld* world, HullHandle handle);
+
+		virtual int32 getType();
+
+		virtual void moveObject(const Vector3& offset, bool absolute);
+		virtual void rotateObject(float degreesOffset, bool absolute);
+		virtual void transformObject(const Matrix4x4& m);
+
+		virtual Vector3 getPosition();
+		virtual Rect2D getAABB();
+		virtual void draw(Gfx* gfx) { }
+
+		HullHandle getHandle() const { return m_handle; }
+
+	private:
+		CollisionWorld* m_world;
+		HullHandle m_handle;
+	};
+}
+
+#endif
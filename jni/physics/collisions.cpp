@@ -7,11 +7,18 @@ namespace pegas
 	//	PointCollisionHull class implementation
 	//------------------------------------------------------------------------------------------------
 	PointCollisionHull::PointCollisionHull(int32 id, int32 group, const Vector3& position)
-		:ICollisionHull(id, group), m_initialPosition(position), m_currentPosition(position)
+		:ICollisionHull(id, group), m_initialPosition(position), m_currentPosition(position),
+		 m_previousPosition(position), m_hasPreviousPosition(false)
 	{
 
 	}
 
+	void PointCollisionHull::updatePreviousPosition()
+	{
+		m_previousPosition = m_currentPosition;
+		m_hasPreviousPosition = true;
+	}
+
 	void PointCollisionHull::moveObject(const Vector3& offset, bool absolute)
 	{
 		m_currentPosition = absolute ? (m_initialPosition + offset) : (m_currentPosition + offset);
@@ -77,7 +84,8 @@ namespace pegas
 	//	PoligonCollisionHull class implementation
 	//---------------------------------------------------------------------------------------------------
 	PoligonCollisionHull::PoligonCollisionHull(int32 id, int32 group, const IPhysics::PointList& points)
-		:ICollisionHull(id, group), m_initalPoints(points.begin(), points.end()), m_currentPoints(points.begin(), points.end())
+		:ICollisionHull(id, group), m_initalPoints(points.begin(), points.end()), m_currentPoints(points.begin(), points.end()),
+		 m_edges(points.size()), m_edgeArrays(points.size() * 6)
 	{
 		for(int i = 0; i < m_currentPoints.size(); i++)
 		{
@@ -85,6 +93,8 @@ namespace pegas
 		}
 		m_currentPosition = m_currentPosition / m_currentPoints.size();
 		m_initialPosition = m_currentPosition;
+
+		updateEdges();
 	}
 
 	void PoligonCollisionHull::moveObject(const Vector3& offset, bool absolute)
@@ -95,6 +105,8 @@ namespace pegas
 		}
 
 		m_currentPosition = absolute ? (m_initialPosition + offset) : (m_currentPosition + offset);
+
+		updateEdges();
 	}
 
 	void PoligonCollisionHull::rotateObject(float degreesOffset, bool absolute)
@@ -110,6 +122,8 @@ namespace pegas
 		}
 
 		m_currentPosition = absolute ? (m_initialPosition * mat) : (m_currentPosition * mat);
+
+		updateEdges();
 	}
 
 	void PoligonCollisionHull::transformObject(const Matrix4x4& m)
@@ -120,6 +134,65 @@ namespace pegas
 		}
 
 		m_currentPosition = m_initialPosition * m;
+
+		updateEdges();
+	}
+
+	void PoligonCollisionHull::updateEdges()
+	{
+		int32 numPoints = m_currentPoints.size();
+		if(numPoints == 0)
+		{
+			m_aabb = Rect2D(Point2D(0.0f, 0.0f), Point2D(0.0f, 0.0f));
+			return;
+		}
+
+		float minX = m_currentPoints[0]._x;
+		float minY = m_currentPoints[0]._y;
+		float maxX = minX;
+		float maxY = minY;
+
+		for(int32 i = 0; i < numPoints; i++)
+		{
+			const Vector3& p0 = m_currentPoints[i];
+			const Vector3& p1 = m_currentPoints[(i == (numPoints - 1)) ? 0 : i + 1];
+
+			EdgePlane& edge = m_edges[i];
+			edge._a = p0._y - p1._y;
+			edge._b = p1._x - p0._x;
+			edge._c = (p0._x * p1._y) - (p1._x * p0._y);
+			edge._lengthSq = (edge._a * edge._a) + (edge._b * edge._b);
+
+			m_edgeArrays[i] = p0._x;
+			m_edgeArrays[numPoints + i] = p0._y;
+			m_edgeArrays[(numPoints * 2) + i] = edge._a;
+			m_edgeArrays[(numPoints * 3) + i] = edge._b;
+			m_edgeArrays[(numPoints * 4) + i] = edge._c;
+			m_edgeArrays[(numPoints * 5) + i] = edge._lengthSq;
+
+			minX = (minX > p0._x) ? p0._x : minX;
+			minY = (minY > p0._y) ? p0._y : minY;
+			maxX = (maxX < p0._x) ? p0._x : maxX;
+			maxY = (maxY < p0._y) ? p0._y : maxY;
+		}
+
+		m_aabb = Rect2D(Point2D(minX, minY), Point2D(maxX, maxY));
+	}
+
+	CollisionKernels::EdgeArrays PoligonCollisionHull::getEdgeArrays() const
+	{
+		int32 numEdges = m_edges.size();
+		const float* data = numEdges > 0 ? &m_edgeArrays[0] : 0;
+
+		CollisionKernels::EdgeArrays edges;
+		edges._vertexX = data;
+		edges._vertexY = data + numEdges;
+		edges._a = data + (numEdges * 2);
+		edges._b = data + (numEdges * 3);
+		edges._c = data + (numEdges * 4);
+		edges._lengthSq = data + (numEdges * 5);
+
+		return edges;
 	}
 
 	Vector3 PoligonCollisionHull::getPosition()
@@ -129,24 +202,7 @@ namespace pegas
 
 	Rect2D PoligonCollisionHull::getAABB()
 	{
-		float minX = std::numeric_limits<float>::max();
-		float minY = std::numeric_limits<float>::max();
-		float maxX = std::numeric_limits<float>::min();
-		float maxY = std::numeric_limits<float>::min();
-
-		for(IPhysics::PointList::iterator it = m_currentPoints.begin();
-			it != m_currentPoints.end(); ++it)
-		{
-			float x = (*it)._x;
-			float y = (*it)._y;
-
-			minX = (minX > x) ? x : minX;
-			minY = (minY > y) ? y : minY;
-			maxX = (maxX < x) ? x : maxX;
-			maxY = (maxY < y) ? y : maxY;
-		}
-
-		return Rect2D(Point2D(minX, minY), Point2D(maxX, maxY));
+		return m_aabb;
 	}
 
 	void PoligonCollisionHull::draw(Gfx* gfx)
@@ -176,226 +232,337 @@ namespace pegas
 		graph.drawLine(fromX, fromY, toX, toY, color);*/
 	}
 
-	//-----------------------------------------------------------------------------------------------
-	//	Collision checkers
-	//-----------------------------------------------------------------------------------------------
-	bool Intersections::isIntersectsPointCircle(ICollisionHull* point, ICollisionHull* circle)
+	//---------------------------------------------------------------------------------------------------
+	//	BoxCollisionHull class implementation
+	//---------------------------------------------------------------------------------------------------
+	BoxCollisionHull::BoxCollisionHull(int32 id, int32 group, const IPhysics::PointList& points)
+		:PoligonCollisionHull(id, group, points)
 	{
-		PointCollisionHull* pointCH = dynamic_cast<PointCollisionHull*>(point);
-		CircleCollisionHull* circleCH = dynamic_cast<CircleCollisionHull*>(circle);
+		m_isAxisAligned = isAxisAligned(m_currentPoints);
+	}
 
-		Vector3 dv = pointCH->getPosition() - circleCH->getPosition();
-		float distance = dv.length();
+	void BoxCollisionHull::moveObject(const Vector3& offset, bool absolute)
+	{
+		PoligonCollisionHull::moveObject(offset, absolute);
 
-		return (distance <= circleCH->getRadius());
+		m_isAxisAligned = isAxisAligned(m_currentPoints);
 	}
 
-	bool Intersections::isIntersectsCirclePoint(ICollisionHull* circle, ICollisionHull* point)
+	void BoxCollisionHull::rotateObject(float degreesOffset, bool absolute)
 	{
-		return isIntersectsPointCircle(point, circle);
+		PoligonCollisionHull::rotateObject(degreesOffset, absolute);
+
+		m_isAxisAligned = isAxisAligned(m_currentPoints);
 	}
 
-	bool Intersections::isIntersectsPointPolygon(ICollisionHull* point, ICollisionHull* polygon)
+	void BoxCollisionHull::transformObject(const Matrix4x4& m)
 	{
-		PointCollisionHull* pointCH = dynamic_cast<PointCollisionHull*>(point);
-		PoligonCollisionHull* poligonCH = dynamic_cast<PoligonCollisionHull*>(polygon);
+		PoligonCollisionHull::transformObject(m);
 
-		Vector3 position = pointCH->getPosition();
-		IPhysics::PointList points = poligonCH->getPoints();
+		m_isAxisAligned = isAxisAligned(m_currentPoints);
+	}
 
-		int i0, i1;
-		float A, B, C, D;
-		Vector3 P0, P1;
-		for(int i = 0; i < points.size(); i++)
+	bool BoxCollisionHull::isAxisAligned(const IPhysics::PointList& points)
+	{
+		if(points.size() != 4)
 		{
-			i0 = i;
-			i1 = (i == (points.size() - 1)) ? 0 : i + 1;
-
-			P0 = points[i0];
-			P1 = points[i1];
+			return false;
+		}
 
-			A = P0._y - P1._y;
-			B = P1._x - P0._x;
-			C = (P0._x * P1._y) - (P1._x * P0._y);
-			D =  (A * position._x) + (B * position._y) + C;
+		//edges go horizontal, vertical, horizontal, vertical (or the other way round)
+		//and none of them is degenerate
+		bool horizontal[4];
+		for(int32 i = 0; i < 4; i++)
+		{
+			const Vector3& p0 = points[i];
+			const Vector3& p1 = points[(i + 1) % 4];
 
-			if(D > 0)
+			bool sameX = (p0._x == p1._x);
+			bool sameY = (p0._y == p1._y);
+			if(sameX == sameY)
 			{
 				return false;
 			}
+
+			horizontal[i] = sameY;
 		}
 
-		return true;
+		return (horizontal[0] != horizontal[1]) && (horizontal[0] == horizontal[2])
+				&& (horizontal[1] == horizontal[3]);
 	}
 
-	bool Intersections::isIntersectsPolygonPoint(ICollisionHull* polygon, ICollisionHull* point)
+	void BoxCollisionHull::makePoints(const Rect2D& box, IPhysics::PointList& points)
 	{
-		return isIntersectsPointPolygon(point, polygon);
+		points.clear();
+		points.push_back(Vector3(box._topLeft._x, box._topLeft._y, 0.0f));
+		points.push_back(Vector3(box._bottomRight._x, box._topLeft._y, 0.0f));
+		points.push_back(Vector3(box._bottomRight._x, box._bottomRight._y, 0.0f));
+		points.push_back(Vector3(box._topLeft._x, box._bottomRight._y, 0.0f));
 	}
 
-	bool Intersections::isIntersectsCirclePolygon(ICollisionHull* circle, ICollisionHull* polygon)
+	//-----------------------------------------------------------------------------------------------
+	//	Collision checkers
+	//-----------------------------------------------------------------------------------------------
+	namespace
 	{
-		CircleCollisionHull* circleCH = dynamic_cast<CircleCollisionHull*>(circle);
-		PoligonCollisionHull* poligonCH = dynamic_cast<PoligonCollisionHull*>(polygon);
-		Vector3 position = circleCH->getPosition();
-		Vector3 dotPosition = position;
-		dotPosition._z = 1.0f;
+		//points moved by (shiftX, shiftY) are all on the outer side of one of the edges
+		bool isSeparatedByEdge(const PoligonCollisionHull::EdgeList& edges, const IPhysics::PointList& points,
+				float shiftX, float shiftY)
+		{
+			for(size_t i = 0; i < edges.size(); i++)
+			{
+				const PoligonCollisionHull::EdgePlane& edge = edges[i];
+
+				size_t j = 0;
+				while(j < points.size()
+					&& ((points[j]._x + shiftX) * edge._a) + ((points[j]._y + shiftY) * edge._b) + edge._c > 0)
+				{
+					j++;
+				}
+
+				if(j == points.size())
+				{
+					return true;
+				}
+			}
 
-		float radius = circleCH->getRadius();
-		IPhysics::PointList points = poligonCH->getPoints();
+			return false;
+		}
 
-		for(int i = 0; i < points.size(); i++)
+		//second half of the double dispatch, the type of the first hull is already known
+		template<int32 typeA>
+		inline bool dispatchIntersection(ICollisionHull* a, ICollisionHull* b)
 		{
-			Vector3 vDistance = position - points[i];
-			float distance = vDistance.length();
-			if(distance < radius)
+			switch(b->getType())
 			{
-				return true;
+			case ICollisionHull::k_typePoint:
+				return checkIntersection<typeA, ICollisionHull::k_typePoint>(a, b);
+			case ICollisionHull::k_typeCircle:
+				return checkIntersection<typeA, ICollisionHull::k_typeCircle>(a, b);
+			case ICollisionHull::k_typePolygon:
+				return checkIntersection<typeA, ICollisionHull::k_typePolygon>(a, b);
+			case ICollisionHull::k_typeBox:
+				return checkIntersection<typeA, ICollisionHull::k_typeBox>(a, b);
 			}
 
-			Vector3 p1 = points[i];
-			Vector3 p2 = (i == points.size() - 1) ? points[0] : points[i + 1];
+			return false;
+		}
 
-			Vector3 line;
-			line._x = p1._y - p2._y; //A
-			line._y = p2._x - p1._x; //B
-			line._z = p1._x * (p2._y - p1._y) - p1._y * (p2._x - p1._x); //C
+		template<int32 typeA>
+		inline bool dispatchIntersection(ICollisionHull* a, ICollisionHull* b, const Vector3& shift)
+		{
+			switch(b->getType())
+			{
+			case ICollisionHull::k_typePoint:
+				return checkIntersection<typeA, ICollisionHull::k_typePoint>(a, b, shift);
+			case ICollisionHull::k_typeCircle:
+				return checkIntersection<typeA, ICollisionHull::k_typeCircle>(a, b, shift);
+			case ICollisionHull::k_typePolygon:
+				return checkIntersection<typeA, ICollisionHull::k_typePolygon>(a, b, shift);
+			case ICollisionHull::k_typeBox:
+				return checkIntersection<typeA, ICollisionHull::k_typeBox>(a, b, shift);
+			}
 
-			Vector3 line2(line._x, line._y, 0.0f);
-			float denominator = line2.length();
-			if(denominator == 0.0f) denominator = 1.0f;
+			return false;
+		}
+	}
 
-			float deviation = line.dotProduct(dotPosition);
-			deviation = std::abs(deviation) / denominator;
-			if(deviation < radius)
-			{
-				Vector3 v1 = position - p1;
-				Vector3 v2 = position - p2;
-				Vector3 l0 = p1 - p2;
+	bool Intersections::isIntersects(ICollisionHull* a, ICollisionHull* b)
+	{
+		switch(a->getType())
+		{
+		case ICollisionHull::k_typePoint:
+			return dispatchIntersection<ICollisionHull::k_typePoint>(a, b);
+		case ICollisionHull::k_typeCircle:
+			return dispatchIntersection<ICollisionHull::k_typeCircle>(a, b);
+		case ICollisionHull::k_typePolygon:
+			return dispatchIntersection<ICollisionHull::k_typePolygon>(a, b);
+		case ICollisionHull::k_typeBox:
+			return dispatchIntersection<ICollisionHull::k_typeBox>(a, b);
+		}
 
-				float dot1 = l0.dotProduct(v1);
-				float dot2 = l0.dotProduct(v2);
-				if((dot1 * dot2) <= 0.0f)
-				{
-					return true;
-				}
-			}
+		return false;
+	}
+
+	bool Intersections::isIntersects(ICollisionHull* a, ICollisionHull* b, const Vector3& shift)
+	{
+		switch(a->getType())
+		{
+		case ICollisionHull::k_typePoint:
+			return dispatchIntersection<ICollisionHull::k_typePoint>(a, b, shift);
+		case ICollisionHull::k_typeCircle:
+			return dispatchIntersection<ICollisionHull::k_typeCircle>(a, b, shift);
+		case ICollisionHull::k_typePolygon:
+			return dispatchIntersection<ICollisionHull::k_typePolygon>(a, b, shift);
+		case ICollisionHull::k_typeBox:
+			return dispatchIntersection<ICollisionHull::k_typeBox>(a, b, shift);
 		}
 
 		return false;
 	}
 
+	bool Intersections::isIntersectsPointCircle(ICollisionHull* point, ICollisionHull* circle)
+	{
+		return checkIntersection<ICollisionHull::k_typePoint, ICollisionHull::k_typeCircle>(point, circle);
+	}
+
+	bool Intersections::isIntersectsCirclePoint(ICollisionHull* circle, ICollisionHull* point)
+	{
+		return checkIntersection<ICollisionHull::k_typeCircle, ICollisionHull::k_typePoint>(circle, point);
+	}
+
+	bool Intersections::isIntersectsPointPolygon(ICollisionHull* point, ICollisionHull* polygon)
+	{
+		return checkIntersection<ICollisionHull::k_typePoint, ICollisionHull::k_typePolygon>(point, polygon);
+	}
+
+	bool Intersections::isIntersectsPolygonPoint(ICollisionHull* polygon, ICollisionHull* point)
+	{
+		return checkIntersection<ICollisionHull::k_typePolygon, ICollisionHull::k_typePoint>(polygon, point);
+	}
+
+	bool Intersections::isIntersectsCirclePolygon(ICollisionHull* circle, ICollisionHull* polygon)
+	{
+		return checkIntersection<ICollisionHull::k_typeCircle, ICollisionHull::k_typePolygon>(circle, polygon);
+	}
+
 	bool Intersections::isIntersectsPolygonCircle(ICollisionHull* polygon, ICollisionHull* circle)
 	{
-		return isIntersectsCirclePolygon(circle, polygon);
+		return checkIntersection<ICollisionHull::k_typePolygon, ICollisionHull::k_typeCircle>(polygon, circle);
 	}
 
 	bool Intersections::isIntersectsPointPoint(ICollisionHull* point1, ICollisionHull* point2)
 	{
-		PointCollisionHull* pointCH1 = dynamic_cast<PointCollisionHull*>(point1);
-		PointCollisionHull* pointCH2 = dynamic_cast<PointCollisionHull*>(point2);
+		return checkIntersection<ICollisionHull::k_typePoint, ICollisionHull::k_typePoint>(point1, point2);
+	}
 
-		Vector3 p1 = pointCH1->getPosition();
-		Vector3 p2 = pointCH2->getPosition();
+	bool Intersections::isIntersectsCircleCircle(ICollisionHull* circle1, ICollisionHull* circle2)
+	{
+		return checkIntersection<ICollisionHull::k_typeCircle, ICollisionHull::k_typeCircle>(circle1, circle2);
+	}
+
+	bool Intersections::isIntersectsPolygonPolygon(ICollisionHull* polygon1, ICollisionHull* polygon2)
+	{
+		return checkIntersection<ICollisionHull::k_typePolygon, ICollisionHull::k_typePolygon>(polygon1, polygon2);
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	//	Typed kernels
+	//-----------------------------------------------------------------------------------------------
+	bool Intersections::check(const PointCollisionHull& point1, const PointCollisionHull& point2, const Vector3& shift)
+	{
+		const Vector3& p1 = point1.getCurrentPosition();
+		const Vector3& p2 = point2.getCurrentPosition();
 
 		const float epsilon = 0.001;
-		bool b1 = abs(p1._x - p2._x) < epsilon;
-		bool b2 = abs(p1._y - p2._y) < epsilon;
+		bool b1 = abs(p1._x - (p2._x + shift._x)) < epsilon;
+		bool b2 = abs(p1._y - (p2._y + shift._y)) < epsilon;
 
 		return (b1 && b2);
 	}
 
-	bool Intersections::isIntersectsCircleCircle(ICollisionHull* circle1, ICollisionHull* circle2)
+	bool Intersections::check(const PointCollisionHull& point, const CircleCollisionHull& circle, const Vector3& shift)
 	{
-		CircleCollisionHull* circleCH1 = dynamic_cast<CircleCollisionHull*>(circle1);
-		CircleCollisionHull* circleCH2 = dynamic_cast<CircleCollisionHull*>(circle2);
+		const Vector3& p1 = point.getCurrentPosition();
+		const Vector3& p2 = circle.getCurrentPosition();
 
-		Vector3 p1 = circleCH1->getPosition();
-		Vector3 p2 = circleCH2->getPosition();
-		float r1 = circleCH1->getRadius();
-		float r2 = circleCH2->getRadius();
+		float dx = p1._x - (p2._x + shift._x);
+		float dy = p1._y - (p2._y + shift._y);
 
-		Vector3 dv = p1 - p2;
-		float distance = dv.length();
-
-		return (distance < (r1 + r2));
+		return ((dx * dx) + (dy * dy)) <= (circle.getRadius() * circle.getRadius());
 	}
 
-	bool Intersections::isIntersectsPolygonPolygon(ICollisionHull* polygon1, ICollisionHull* polygon2)
+	bool Intersections::check(const PointCollisionHull& point, const PoligonCollisionHull& polygon, const Vector3& shift)
 	{
-		PoligonCollisionHull* poligonCH1 = dynamic_cast<PoligonCollisionHull*>(polygon1);
-		PoligonCollisionHull* poligonCH2 = dynamic_cast<PoligonCollisionHull*>(polygon2);
+		const Vector3& position = point.getCurrentPosition();
+		const PoligonCollisionHull::EdgeList& edges = polygon.getEdges();
+		float x = position._x - shift._x;
+		float y = position._y - shift._y;
 
-		IPhysics::PointList points1 = poligonCH1->getPoints();
-		IPhysics::PointList points2 = poligonCH2->getPoints();
+		for(int32 i = 0; i < edges.size(); i++)
+		{
+			const PoligonCollisionHull::EdgePlane& edge = edges[i];
 
-		std::vector<float> A1(points1.size());
-		std::vector<float> B1(points1.size());
-		std::vector<float> C1(points1.size());
+			float D =  (edge._a * x) + (edge._b * y) + edge._c;
+			if(D > 0)
+			{
+				return false;
+			}
+		}
 
-		std::vector<float> A2(points2.size());
-		std::vector<float> B2(points2.size());
-		std::vector<float> C2(points2.size());
+		return true;
+	}
 
-		int i0, i1;
-		float D;
-		Vector3 P0, P1;
+	bool Intersections::check(const CircleCollisionHull& circle1, const CircleCollisionHull& circle2, const Vector3& shift)
+	{
+		const Vector3& p1 = circle1.getCurrentPosition();
+		const Vector3& p2 = circle2.getCurrentPosition();
 
-		for(int i = 0; i < points1.size(); i++)
-		{
-			i0 = i;
-			i1 = (i == (points1.size() - 1)) ? 0 : i + 1;
+		float dx = p1._x - (p2._x + shift._x);
+		float dy = p1._y - (p2._y + shift._y);
+		float r = circle1.getRadius() + circle2.getRadius();
 
-			P0 = points1[i0];
-			P1 = points1[i1];
+		return ((dx * dx) + (dy * dy)) < (r * r);
+	}
 
-			A1[i] = P0._y - P1._y;
-			B1[i] = P1._x - P0._x;
-			C1[i] = (P0._x * P1._y) - (P1._x * P0._y);
-		}
+	bool Intersections::check(const CircleCollisionHull& circle, const PoligonCollisionHull& polygon, const Vector3& shift)
+	{
+		const Vector3& position = circle.getCurrentPosition();
+
+		return CollisionKernels::circlePolygon(position._x - shift._x, position._y - shift._y, circle.getRadius(),
+				polygon.getEdgeArrays(), 0, polygon.getEdges().size());
+	}
 
-		for(int i = 0; i < points2.size(); i++)
+	bool Intersections::check(const PoligonCollisionHull& polygon1, const PoligonCollisionHull& polygon2, const Vector3& shift)
+	{
+		//separating axis test: convex polygons do not intersect when all the
+		//vertices of one of them lie outside of the same edge of the other
+		if(isSeparatedByEdge(polygon2.getEdges(), polygon1.getPoints(), -shift._x, -shift._y))
 		{
-			i0 = i;
-			i1 = (i == (points2.size() - 1)) ? 0 : i + 1;
+			return false;
+		}
 
-			P0 = points2[i0];
-			P1 = points2[i1];
+		return !isSeparatedByEdge(polygon1.getEdges(), polygon2.getPoints(), shift._x, shift._y);
+	}
 
-			A2[i] = P0._y - P1._y;
-			B2[i] = P1._x - P0._x;
-			C2[i] = (P0._x * P1._y) - (P1._x * P0._y);
-		}
+	bool Intersections::check(const PointCollisionHull& point, const BoxCollisionHull& box, const Vector3& shift)
+	{
+		const Vector3& position = point.getCurrentPosition();
+		const Rect2D& bounds = box.getBounds();
+		float x = position._x - shift._x;
+		float y = position._y - shift._y;
 
-		//cheking 1 against 2
-		for(int i = 0; i < points1.size(); i++)
-		{
-			for(int j = 0; j < points2.size(); j++)
-			{
-				P0 = points1[i];
-				D = (P0._x * A2[j]) + (P0._y * B2[j]) + C2[j];
-				if(D > 0)
-				{
-					return true;
-				}
-			}
-		}//cheking 1 against 2
+		return (x >= bounds._topLeft._x) && (x <= bounds._bottomRight._x)
+				&& (y >= bounds._topLeft._y) && (y <= bounds._bottomRight._y);
+	}
 
-		//cheking 2 against 1
-		for(int i = 0; i < points2.size(); i++)
-		{
-			for(int j = 0; j < points1.size(); j++)
-			{
-				P0 = points2[i];
-				D = (P0._x * A1[j]) + (P0._y * B1[j]) + C1[j];
-				if(D > 0)
-				{
-					return true;
-				}
-			}
-		}//cheking 2 against 1
+	bool Intersections::check(const CircleCollisionHull& circle, const BoxCollisionHull& box, const Vector3& shift)
+	{
+		//distance from the center to the closest point of the box
+		const Vector3& position = circle.getCurrentPosition();
+		const Rect2D& bounds = box.getBounds();
+		float radius = circle.getRadius();
+		float centerX = position._x - shift._x;
+		float centerY = position._y - shift._y;
+
+		float x = std::min(std::max(centerX, bounds._topLeft._x), bounds._bottomRight._x);
+		float y = std::min(std::max(centerY, bounds._topLeft._y), bounds._bottomRight._y);
+		float dx = centerX - x;
+		float dy = centerY - y;
+
+		return ((dx * dx) + (dy * dy)) < (radius * radius);
+	}
 
-		return false;
+	bool Intersections::check(const BoxCollisionHull& box1, const BoxCollisionHull& box2, const Vector3& shift)
+	{
+		const Rect2D& bounds1 = box1.getBounds();
+		const Rect2D& bounds2 = box2.getBounds();
+		float left1 = bounds1._topLeft._x - shift._x;
+		float right1 = bounds1._bottomRight._x - shift._x;
+		float top1 = bounds1._topLeft._y - shift._y;
+		float bottom1 = bounds1._bottomRight._y - shift._y;
+
+		return (left1 < bounds2._bottomRight._x) && (bounds2._topLeft._x < right1)
+				&& (top1 < bounds2._bottomRight._y) && (bounds2._topLeft._y < bottom1);
 	}
 }
-
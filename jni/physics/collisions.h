@@ -10,12 +10,76 @@
 #pragma once
 
 #include "physics.h"
+#include "collision_kernels.h"
 
 namespace pegas
 {
+	class PointCollisionHull;
+	class CircleCollisionHull;
+	class PoligonCollisionHull;
+	class BoxCollisionHull;
+
 	class Intersections
 	{
 	public:
+		//resolves the pair of hull types with two switches and calls
+		//the statically typed kernel, no RTTI involved
+		static bool isIntersects(ICollisionHull* a, ICollisionHull* b);
+		//the same with b moved by shift (hulls of different scroll layers),
+		//the hulls stay untouched and nothing is copied
+		static bool isIntersects(ICollisionHull* a, ICollisionHull* b, const Vector3& shift);
+
+		//statically typed kernels, the second hull is tested as moved by shift
+		static bool check(const PointCollisionHull& point1, const PointCollisionHull& point2,
+				const Vector3& shift = Vector3());
+		static bool check(const PointCollisionHull& point, const CircleCollisionHull& circle,
+				const Vector3& shift = Vector3());
+		static bool check(const PointCollisionHull& point, const PoligonCollisionHull& polygon,
+				const Vector3& shift = Vector3());
+		static bool check(const CircleCollisionHull& circle1, const CircleCollisionHull& circle2,
+				const Vector3& shift = Vector3());
+		static bool check(const CircleCollisionHull& circle, const PoligonCollisionHull& polygon,
+				const Vector3& shift = Vector3());
+		static bool check(const PoligonCollisionHull& polygon1, const PoligonCollisionHull& polygon2,
+				const Vector3& shift = Vector3());
+		static bool check(const PointCollisionHull& point, const BoxCollisionHull& box,
+				const Vector3& shift = Vector3());
+		static bool check(const CircleCollisionHull& circle, const BoxCollisionHull& box,
+				const Vector3& shift = Vector3());
+		static bool check(const BoxCollisionHull& box1, const BoxCollisionHull& box2,
+				const Vector3& shift = Vector3());
+
+		//b moved by shift is a moved by -shift
+		static bool check(const CircleCollisionHull& circle, const PointCollisionHull& point,
+				const Vector3& shift = Vector3())
+		{
+			return check(point, circle, Vector3(-shift._x, -shift._y, -shift._z));
+		}
+
+		static bool check(const PoligonCollisionHull& polygon, const PointCollisionHull& point,
+				const Vector3& shift = Vector3())
+		{
+			return check(point, polygon, Vector3(-shift._x, -shift._y, -shift._z));
+		}
+
+		static bool check(const PoligonCollisionHull& polygon, const CircleCollisionHull& circle,
+				const Vector3& shift = Vector3())
+		{
+			return check(circle, polygon, Vector3(-shift._x, -shift._y, -shift._z));
+		}
+
+		static bool check(const BoxCollisionHull& box, const PointCollisionHull& point,
+				const Vector3& shift = Vector3())
+		{
+			return check(point, box, Vector3(-shift._x, -shift._y, -shift._z));
+		}
+
+		static bool check(const BoxCollisionHull& box, const CircleCollisionHull& circle,
+				const Vector3& shift = Vector3())
+		{
+			return check(circle, box, Vector3(-shift._x, -shift._y, -shift._z));
+		}
+
 		static bool isIntersectsPointCircle(ICollisionHull* point, ICollisionHull* circle);
 		static bool isIntersectsCirclePoint(ICollisionHull* circle, ICollisionHull* point);
 
@@ -44,9 +108,22 @@ namespace pegas
 		virtual Rect2D getAABB();
 		virtual void draw(Gfx* gfx) { }
 
+		const Vector3& getCurrentPosition() const { return m_currentPosition; }
+
+		//position at the last physics update: a hull moving fast is swept
+		//from it to the current one. A hull that has not been through
+		//an update yet has no previous position and is not swept
+		bool hasPreviousPosition() const { return m_hasPreviousPosition; }
+		const Vector3& getPreviousPosition() const { return m_previousPosition; }
+		void updatePreviousPosition();
+		//keeps the sweep when the hull is moved with its coordinate frame (scroll layer rebase)
+		void offsetPreviousPosition(const Vector3& offset) { m_previousPosition = m_previousPosition + offset; }
+
 	protected:
 		Vector3 m_initialPosition;
 		Vector3 m_currentPosition;
+		Vector3 m_previousPosition;
+		bool m_hasPreviousPosition;
 	};
 
 	class CircleCollisionHull: public PointCollisionHull
@@ -65,6 +142,18 @@ namespace pegas
 
 	class PoligonCollisionHull: public ICollisionHull
 	{
+	public:
+		//edge line A*x + B*y + C = 0 from the vertex i to the vertex i + 1,
+		//lengthSq - squared edge length, A*A + B*B
+		struct EdgePlane
+		{
+			float _a;
+			float _b;
+			float _c;
+			float _lengthSq;
+		};
+		typedef std::vector<EdgePlane> EdgeList;
+
 	public:
 		PoligonCollisionHull(int32 id, int32 group, const IPhysics::PointList& points);
 
@@ -76,16 +165,94 @@ namespace pegas
 
 		virtual Vector3 getPosition();
 		virtual Rect2D getAABB();
-		IPhysics::PointList getPoints() const { return m_currentPoints; }
+		const IPhysics::PointList& getPoints() const { return m_currentPoints; }
+		const EdgeList& getEdges() const { return m_edges; }
+		//the same edges as separate arrays, for CollisionKernels
+		CollisionKernels::EdgeArrays getEdgeArrays() const;
+		const Rect2D& getBounds() const { return m_aabb; }
 
 		virtual void draw(Gfx* gfx);
 
 	protected:
+		//recalculates edge planes and AABB of the current points,
+		//called whenever the points change
+		void updateEdges();
+
 		IPhysics::PointList m_initalPoints;
 		IPhysics::PointList m_currentPoints;
+		EdgeList m_edges;
+		//vertexX, vertexY, a, b, c and lengthSq of all edges, one run after another
+		std::vector<float> m_edgeArrays;
+		Rect2D m_aabb;
 		Vector3 m_initialPosition;
 		Vector3 m_currentPosition;
 	};
+
+	//polygon of 4 points with axis aligned edges, tested by its bounds;
+	//while rotated off the axes it reports k_typePolygon and is tested as a polygon
+	class BoxCollisionHull: public PoligonCollisionHull
+	{
+	public:
+		BoxCollisionHull(int32 id, int32 group, const IPhysics::PointList& points);
+
+		virtual int32 getType() { return m_isAxisAligned ? k_typeBox : k_typePolygon; }
+
+		virtual void moveObject(const Vector3& offset, bool absolute);
+		virtual void rotateObject(float degreesOffset, bool absolute);
+		virtual void transformObject(const Matrix4x4& m);
+
+		static bool isAxisAligned(const IPhysics::PointList& points);
+		static void makePoints(const Rect2D& box, IPhysics::PointList& points);
+
+	protected:
+		bool m_isAxisAligned;
+	};
+
+	//-------------------------------------------------------------------------
+	//	Compile time double dispatch: hull type constant -> hull class.
+	//	checkIntersection<typeA, typeB> casts the hulls with static_cast
+	//	(the type is already known from getType()) and calls the matching
+	//	Intersections::check overload, the choice is made by the compiler.
+	//-------------------------------------------------------------------------
+	template<int32 type> struct CollisionHullClass;
+
+	template<> struct CollisionHullClass<ICollisionHull::k_typePoint>
+	{
+		typedef PointCollisionHull Type;
+	};
+
+	template<> struct CollisionHullClass<ICollisionHull::k_typeCircle>
+	{
+		typedef CircleCollisionHull Type;
+	};
+
+	template<> struct CollisionHullClass<ICollisionHull::k_typePolygon>
+	{
+		typedef PoligonCollisionHull Type;
+	};
+
+	template<> struct CollisionHullClass<ICollisionHull::k_typeBox>
+	{
+		typedef BoxCollisionHull Type;
+	};
+
+	template<int32 typeA, int32 typeB>
+	inline bool checkIntersection(ICollisionHull* a, ICollisionHull* b)
+	{
+		typedef typename CollisionHullClass<typeA>::Type HullA;
+		typedef typename CollisionHullClass<typeB>::Type HullB;
+
+		return Intersections::check(*static_cast<HullA*>(a), *static_cast<HullB*>(b));
+	}
+
+	template<int32 typeA, int32 typeB>
+	inline bool checkIntersection(ICollisionHull* a, ICollisionHull* b, const Vector3& shift)
+	{
+		typedef typename CollisionHullClass<typeA>::Type HullA;
+		typedef typename CollisionHullClass<typeB>::Type HullB;
+
+		return Intersections::check(*static_cast<HullA*>(a), *static_cast<HullB*>(b), shift);
+	}
 }
 
 #endif /* PHYSICS_COLLISIONS_H_ */
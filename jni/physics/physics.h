@@ -22,15 +22,22 @@ namespace pegas
 			k_typePoint = 0,
 			k_typeCircle,
 			k_typePolygon,
+			k_typeBox,
 			k_typeTotal
 		};
 	public:
 		ICollisionHull(int32 id, int32 collisionGroup):
-		  m_id(id), m_collisionGroup(collisionGroup) {}
+		  m_id(id), m_collisionGroup(collisionGroup), m_treeHandle(k_invalidSpatialHandle), m_scrollLayer(0) {}
 		virtual ~ICollisionHull() {}
 
 		int32 getId() const { return m_id; }
 		int32 getCollisionGroup() const { return m_collisionGroup; }
+		//     IPhysics,   
+		SpatialHandle getTreeHandle() const { return m_treeHandle; }
+		void setTreeHandle(SpatialHandle handle) { m_treeHandle = handle; }
+		// ,    IPhysics  
+		int32 getScrollLayer() const { return m_scrollLayer; }
+		void setScrollLayer(int32 layer) { m_scrollLayer = layer; }
 		virtual int32 getType() = 0;
 
 		virtual void moveObject(const Vector3& offset, bool absolute) = 0;
@@ -44,6 +51,8 @@ namespace pegas
 	protected:
 		int32 m_id;
 		int32 m_collisionGroup;
+		SpatialHandle m_treeHandle;
+		int32 m_scrollLayer;
 	};
 
 	class IPhysics
@@ -51,12 +60,57 @@ namespace pegas
 	public:
 		typedef std::vector<Vector3> PointList;
 		typedef std::pair<int32, int32> CollisionPair;
-		typedef std::list<CollisionPair> CollisionPairList;
+		typedef std::vector<CollisionPair> CollisionPairList;
 		typedef CollisionPairList::iterator CollisionPairListIt;
 
 		typedef ptr<ICollisionHull> CollisionHullPtr;
+
+		// castRay/castCircle:    ,   
+		// ,          
+		struct CastHit
+		{
+			int32 _id;
+			float _distance;
+			Vector3 _point;
+			Vector3 _normal;
+		};
+
+		//     update (getStats).    
+		//castRay/castCircle   update     
+		struct Stats
+		{
+			enum
+			{
+				k_phaseBroadphase = 0,	// -
+				k_phaseNarrowphase,		//  
+				k_phaseSweep,			//     
+				k_phaseContacts,		/// 
+				k_numPhases
+			};
+
+			// update,     (1,  -     )
+			int32 _numUpdates;
+			int32 _numHulls;
+			int32 _numCandidatePairs;
+			//      (ICollisionHull::k_type...), [ ][ ]
+			int32 _numTests[ICollisionHull::k_typeTotal][ICollisionHull::k_typeTotal];
+			int32 _numHits;
+			int32 _numSweeps;
+			int32 _numCasts;
+			// ,    ,    
+			int32 _numNodesVisited;
+			//      - moveObject/rotateObject/transformObject
+			int32 _numReinsertions;
+			//
+			double _phaseTime[k_numPhases];
+			double _updateTime;
+		};
+
+		enum
+		{
+			k_allGroups = 0xFFFFFFFF
+		};
 		typedef std::map<int32, CollisionHullPtr> CollisionHullMap;
-		typedef std::set<int32> CollisionPairsHashes;
 
 	public:
 		virtual ~IPhysics() { }
@@ -75,15 +129,51 @@ namespace pegas
 		virtual bool registerPoint(int32 id, int32 group, const Vector3& position) = 0;
 		virtual bool registerCircle(int32 id, int32 group, const Vector3& position, float radius) = 0;
 		virtual bool registerPoligon(int32 id, int32 group, const PointList& points) = 0;
+		// ,    (    ,    )
+		//  4   ,  ,    
+		virtual bool registerBox(int32 id, int32 group, const Rect2D& box) = 0;
 		virtual void unregisterCollisionHull(int32 id) = 0;
 
 		virtual void moveObject(int32 id, const Vector3& offset, bool absolute = true) = 0;
 		virtual void rotateObject(int32 id, float degreesOffset, bool absolute = true) = 0;
 		virtual void transformObject(int32 id, const Matrix4x4& m) = 0;
 
+		// .   ,    update
+		//    ,     (swept test),
+		// update   ,   
 		virtual void update() = 0;
+		//,     ( ),
+		// ( id,  id)       
 		virtual CollisionPairList& getCollidedPairs() = 0;
+		//,     ,    
+		virtual CollisionPairList& getContactStayPairs() = 0;
+		//,     ,   ( ),
+		//      
+		virtual CollisionPairList& getContactEndPairs() = 0;
 		virtual bool isIntersects(ICollisionHull* a, ICollisionHull* b) = 0;
+
+		//   origin + direction * t (0 <= t <= maxDistance, direction )
+		//  ,     groupMask.     ,
+		// 0.  false,     
+		virtual bool castRay(const Vector3& origin, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups) = 0;
+		//     radius,     
+		virtual bool castCircle(const Vector3& origin, float radius, const Vector3& direction, float maxDistance,
+				CastHit& hit, uint32 groupMask = k_allGroups) = 0;
+
+		// : ,   ,     (moveObject,
+		//transformObject  ..),          . 
+		//   (,  ) -   setScrollLayerOffset.
+		// 0 -  ,   . createScrollLayer    
+		virtual int32 createScrollLayer() = 0;
+		virtual void setScrollLayerOffset(int32 layer, const Vector3& offset) = 0;
+		virtual Vector3 getScrollLayerOffset(int32 layer) = 0;
+		//   ,       
+		virtual bool attachToScrollLayer(int32 id, int32 layer) = 0;
+
+		//  update
+		virtual const Stats& getStats() = 0;
+
 		virtual void debugDraw(Gfx* gfx) = 0;
 	};
 }
@@ -0,0 +1,97 @@
+#include "../common.h"
+#include "physics_stats.h"
+
+#include <time.h>
+
+namespace pegas
+{
+	//------------------------------------------------------------------------------------------------
+	//	PhysicsStats class implementation
+	//------------------------------------------------------------------------------------------------
+	PhysicsStats::PhysicsStats()
+		:m_updateStart(0.0), m_phaseStart(0.0)
+	{
+		clear();
+	}
+
+	void PhysicsStats::clear()
+	{
+		reset(m_current);
+		reset(m_last);
+	}
+
+	void PhysicsStats::beginUpdate()
+	{
+		m_updateStart = now();
+		m_phaseStart = m_updateStart;
+	}
+
+	void PhysicsStats::endPhase(int32 phase)
+	{
+		double time = now();
+
+		m_current._phaseTime[phase] += time - m_phaseStart;
+		m_phaseStart = time;
+	}
+
+	void PhysicsStats::endUpdate(int32 numHulls)
+	{
+		m_current._numUpdates = 1;
+		m_current._numHulls = numHulls;
+		m_current._updateTime = m_phaseStart - m_updateStart;
+
+		m_last = m_current;
+		reset(m_current);
+	}
+
+	void PhysicsStats::reset(IPhysics::Stats& stats)
+	{
+		memset(&stats, 0, sizeof(stats));
+	}
+
+	void PhysicsStats::accumulate(IPhysics::Stats& total, const IPhysics::Stats& frame)
+	{
+		total._numUpdates += frame._numUpdates;
+		total._numHulls = frame._numHulls;
+		total._numCandidatePairs += frame._numCandidatePairs;
+		for(int32 i = 0; i < ICollisionHull::k_typeTotal; i++)
+		{
+			for(int32 j = 0; j < ICollisionHull::k_typeTotal; j++)
+			{
+				total._numTests[i][j] += frame._numTests[i][j];
+			}
+		}
+		total._numHits += frame._numHits;
+		total._numSweeps += frame._numSweeps;
+		total._numCasts += frame._numCasts;
+		total._numNodesVisited += frame._numNodesVisited;
+		total._numReinsertions += frame._numReinsertions;
+		for(int32 i = 0; i < IPhysics::Stats::k_numPhases; i++)
+		{
+			total._phaseTime[i] += frame._phaseTime[i];
+		}
+		total._updateTime += frame._updateTime;
+	}
+
+	int32 PhysicsStats::getNumTests(const IPhysics::Stats& stats)
+	{
+		int32 numTests = 0;
+		for(int32 i = 0; i < ICollisionHull::k_typeTotal; i++)
+		{
+			for(int32 j = 0; j < ICollisionHull::k_typeTotal; j++)
+			{
+				numTests += stats._numTests[i][j];
+			}
+		}
+
+		return numTests;
+	}
+
+	double PhysicsStats::now()
+	{
+		timespec timeValue;
+		clock_gettime(CLOCK_MONOTONIC, &timeValue);
+
+		return timeValue.tv_sec + (timeValue.tv_nsec * 1.0e-9);
+	}
+}
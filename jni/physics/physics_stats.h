@@ -0,0 +1,59 @@
+#ifndef PEGAS_PHYSICS_STATS_H
+#define PEGAS_PHYSICS_STATS_H
+#pragma once
+
+#include "../core/includes.h"
+
+#include "physics.h"
+
+namespace pegas
+{
+	//-------------------------------------------------------------------------
+	//	Collects IPhysics::Stats of a physics implementation. Counters go to
+	//	the stats of the update in progress (getCurrent) at any time; update()
+	//	calls beginUpdate(), endPhase() after every phase and endUpdate(),
+	//	which publishes the stats (getLast) and starts the next ones. Costs
+	//	a few integer increments and one clock read per phase, so it is
+	//	left on in release builds.
+	//-------------------------------------------------------------------------
+	class PhysicsStats
+	{
+	public:
+		PhysicsStats();
+
+		void clear();
+
+		IPhysics::Stats& getCurrent() { return m_current; }
+		const IPhysics::Stats& getLast() const { return m_last; }
+
+		void beginUpdate();
+		//the time since the previous phase (or beginUpdate) goes to the phase
+		void endPhase(int32 phase);
+		void endUpdate(int32 numHulls);
+
+		void addTest(int32 typeA, int32 typeB)
+		{
+			if(typeA > typeB)
+			{
+				std::swap(typeA, typeB);
+			}
+
+			m_current._numTests[typeA][typeB]++;
+		}
+
+		static void reset(IPhysics::Stats& stats);
+		//sums the counters and times of frame into total (_numHulls is the latest)
+		static void accumulate(IPhysics::Stats& total, const IPhysics::Stats& frame);
+		static int32 getNumTests(const IPhysics::Stats& stats);
+		//monotonic wall clock, seconds
+		static double now();
+
+	private:
+		IPhysics::Stats m_current;
+		IPhysics::Stats m_last;
+		double m_updateStart;
+		double m_phaseStart;
+	};
+}
+
+#endif
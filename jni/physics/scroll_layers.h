@@ -0,0 +1,116 @@
+#ifndef PEGAS_PHYSICS_SCROLL_LAYERS_H
+#define PEGAS_PHYSICS_SCROLL_LAYERS_H
+#pragma once
+
+#include "../core/includes.h"
+
+namespace pegas
+{
+	//-------------------------------------------------------------------------
+	//	Scroll layers of a physics implementation. A hull attached to a layer
+	//	is given in layer coordinates, its world position is the layer
+	//	position plus the layer offset; layer 0 is the world and never moves.
+	//	Hulls are stored at the layer position plus the layer base. The base
+	//	catches up with the offset only when the implementation rebases the
+	//	layer (moves its hulls), between rebases the stored hulls are shifted
+	//	on the fly by getShift() = offset - base.
+	//-------------------------------------------------------------------------
+	class ScrollLayers
+	{
+	public:
+		enum
+		{
+			k_worldLayer = 0
+		};
+
+		ScrollLayers()
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			m_layers.clear();
+			m_layers.push_back(Layer());
+			m_hullLayers.clear();
+		}
+
+		int32 createLayer()
+		{
+			m_layers.push_back(Layer());
+
+			return m_layers.size() - 1;
+		}
+
+		int32 getNumLayers() const { return m_layers.size(); }
+		bool isValidLayer(int32 layer) const { return layer >= 0 && layer < (int32)m_layers.size(); }
+
+		const Vector3& getOffset(int32 layer) const { return m_layers[layer]._offset; }
+		const Vector3& getBase(int32 layer) const { return m_layers[layer]._base; }
+		Vector3 getShift(int32 layer) const { return m_layers[layer]._offset - m_layers[layer]._base; }
+		bool isShifted(int32 layer) const
+		{
+			return m_layers[layer]._offset._x != m_layers[layer]._base._x
+					|| m_layers[layer]._offset._y != m_layers[layer]._base._y;
+		}
+
+		void setOffset(int32 layer, const Vector3& offset) { m_layers[layer]._offset = offset; }
+		//the hulls of the layer have been moved by getShift()
+		void rebase(int32 layer) { m_layers[layer]._base = m_layers[layer]._offset; }
+
+		int32 getHullLayer(int32 id) const
+		{
+			if(m_hullLayers.empty())
+			{
+				return k_worldLayer;
+			}
+
+			HullLayerMap::const_iterator it = m_hullLayers.find(id);
+
+			return (it != m_hullLayers.end()) ? it->second : (int32)k_worldLayer;
+		}
+
+		void setHullLayer(int32 id, int32 layer)
+		{
+			if(layer == k_worldLayer)
+			{
+				m_hullLayers.erase(id);
+			}else
+			{
+				m_hullLayers[id] = layer;
+			}
+		}
+
+		void removeHull(int32 id)
+		{
+			m_hullLayers.erase(id);
+		}
+
+		//ids of the hulls attached to the layer, in ascending order
+		void getLayerHulls(int32 layer, std::vector<int32>& ids) const
+		{
+			ids.clear();
+			for(HullLayerMap::const_iterator it = m_hullLayers.begin(); it != m_hullLayers.end(); ++it)
+			{
+				if(it->second == layer)
+				{
+					ids.push_back(it->first);
+				}
+			}
+		}
+
+	private:
+		struct Layer
+		{
+			Vector3 _offset;
+			Vector3 _base;
+		};
+
+		typedef std::map<int32, int32> HullLayerMap;
+
+		std::vector<Layer> m_layers;
+		HullLayerMap m_hullLayers;
+	};
+}
+
+#endif
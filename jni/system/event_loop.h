@@ -5,6 +5,7 @@
 
 namespace pegas
 {
+#ifdef ANDROID
 	class EventLoop
 	{
 	public:
@@ -31,6 +32,33 @@ namespace pegas
 		bool m_enabled;
 		bool m_quit;
 	};
+#endif
+
+#ifdef PEGAS_HOST
+	//headless event loop: plays the activity lifecycle the way android does
+	//(start, window, focus, steps..., focus lost, window destroyed, stop, destroy)
+	//and steps the activity until it asks to quit or maxSteps is reached (0 - no limit)
+	class EventLoop
+	{
+	public:
+		EventLoop(int32 maxSteps = 0);
+
+		void run(IActivityHandler* activityHandler);
+		int32 getStepsDone() const { return m_stepsDone; }
+
+	protected:
+		void activate();
+		void deactivate();
+
+	private:
+		IActivityHandler* m_activityHandler;
+
+		int32 m_maxSteps;
+		int32 m_stepsDone;
+		bool m_enabled;
+		bool m_quit;
+	};
+#endif
 }
 
 #endif /* EVENT_LOOP_H_ */
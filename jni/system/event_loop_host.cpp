@@ -0,0 +1,91 @@
+#include "../common.h"
+
+#include "event_loop.h"
+#include "log.h"
+
+#ifdef PEGAS_HOST
+
+namespace pegas
+{
+		EventLoop::EventLoop(int32 maxSteps)
+			:m_activityHandler(NULL),
+			 m_maxSteps(maxSteps), m_stepsDone(0),
+			 m_enabled(false), m_quit(false)
+		{
+
+		}
+
+		void EventLoop::run(IActivityHandler* activityHandler)
+		{
+			m_activityHandler = activityHandler;
+			m_stepsDone = 0;
+
+			LOGI("starting host event loop");
+
+			m_activityHandler->onStart();
+			m_activityHandler->onResume();
+			m_activityHandler->onCreateWindow();
+
+			activate();
+			if(m_enabled)
+			{
+				m_activityHandler->onGainFocus();
+			}
+
+			while(m_enabled && !m_quit)
+			{
+				if(m_activityHandler->onStep() != STATUS_OK)
+				{
+					m_quit = true;
+				}
+
+				m_stepsDone++;
+				if(m_maxSteps > 0 && m_stepsDone >= m_maxSteps)
+				{
+					m_quit = true;
+				}
+			}
+
+			if(m_enabled)
+			{
+				m_activityHandler->onLostFocus();
+			}
+
+			m_activityHandler->onPause();
+			deactivate();
+
+			m_activityHandler->onDestroyWindow();
+			m_activityHandler->onStop();
+			m_activityHandler->onDestroy();
+
+			LOGI("exiting host event loop [steps: %d]", m_stepsDone);
+		}
+
+		void EventLoop::activate()
+		{
+			if(!m_enabled)
+			{
+				m_quit = false;
+				m_enabled = true;
+
+				if(m_activityHandler->onActivate() != STATUS_OK)
+				{
+					LOGE("activity activation failed");
+
+					m_quit = true;
+					m_enabled = false;
+				}
+			}
+		}
+
+		void EventLoop::deactivate()
+		{
+			if(m_enabled)
+			{
+				m_activityHandler->onDeactivate();
+				m_enabled = false;
+			}
+		}
+}
+
+#endif //PEGAS_HOST
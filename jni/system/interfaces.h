@@ -170,7 +170,6 @@ namespace pegas
 			virtual void onMouseWheel(NumNothes wheel, MouseFlags flags) = 0;
 		};
 
-#ifdef ANDROID
 		class IActivityHandler
 		{
 		public:
@@ -196,6 +195,7 @@ namespace pegas
 			virtual void onLostFocus() {}
 		};
 
+#ifdef ANDROID
 		class IInputHandler
 		{
 		public:
@@ -1,10 +1,83 @@
 #include "log.h"
 
 #include <stdarg.h>
+
+#ifdef PEGAS_HOST
+#include <stdio.h>
+#else
 #include <android/log.h>
+#endif
 
 namespace pegas
 {
+#ifdef PEGAS_HOST
+		static FILE* gs_logFile = NULL;
+
+		static void hostLogPrint(const char* level, const char* tag, const char* message, va_list args)
+		{
+			FILE* output = (gs_logFile != NULL) ? gs_logFile : stdout;
+
+			fprintf(output, "%s/%s: ", level, tag);
+			vfprintf(output, message, args);
+			fprintf(output, "\n");
+		}
+
+		bool Log::setOutputFile(const char* fileName)
+		{
+			if(gs_logFile != NULL)
+			{
+				fclose(gs_logFile);
+				gs_logFile = NULL;
+			}
+
+			if(fileName != NULL)
+			{
+				gs_logFile = fopen(fileName, "w");
+			}
+
+			return (fileName == NULL) || (gs_logFile != NULL);
+		}
+
+		void Log::error(const char* tag, const char* message, ...)
+		{
+			va_list args;
+			va_start(args, message);
+
+			hostLogPrint("E", tag, message, args);
+
+			va_end(args);
+		}
+
+		void Log::warning(const char* tag, const char* message, ...)
+		{
+			va_list args;
+			va_start(args, message);
+
+			hostLogPrint("W", tag, message, args);
+
+			va_end(args);
+		}
+
+		void Log::info(const char* tag, const char* message, ...)
+		{
+			va_list args;
+			va_start(args, message);
+
+			hostLogPrint("I", tag, message, args);
+
+			va_end(args);
+		}
+
+		void Log::debug(const char* tag, const char* message, ...)
+		{
+			va_list args;
+			va_start(args, message);
+
+			hostLogPrint("D", tag, message, args);
+
+			va_end(args);
+		}
+#else
 		void Log::error(const char* tag, const char* message, ...)
 		{
 			va_list args;
@@ -48,6 +121,7 @@ namespace pegas
 
 			va_end(args);
 		}
+#endif
 }
 
 
@@ -10,6 +10,11 @@ namespace pegas
 		static void warning(const char* tag, const char* message, ...);
 		static void info(const char* tag, const char* message, ...);
 		static void debug(const char* tag, const char* message, ...);
+
+#ifdef PEGAS_HOST
+		//host log sink: stdout by default, or a file if set (NULL - back to stdout)
+		static bool setOutputFile(const char* fileName);
+#endif
 	};
 }
 
@@ -116,7 +116,7 @@ namespace pegas
 	}
 
 
-
+#ifdef ANDROID
 	/************************************************************************
 	 * 	AssetResource class implementation
 	 ***********************************************************************/
@@ -166,6 +166,7 @@ namespace pegas
 	const void* AssetResource::bufferize() {
 		return AAsset_getBuffer(m_asset);
 	}
+#endif
 }
 
 
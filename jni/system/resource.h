@@ -36,7 +36,7 @@ namespace pegas
 		std::ifstream m_inputStream;
 	};
 
-
+#ifdef ANDROID
 	class AssetResource: public Resource
 	{
 	public:
@@ -53,6 +53,7 @@ namespace pegas
 		AAssetManager* m_assetManager;
 		AAsset* m_asset;
 	};
+#endif
 }
 
 #endif /* RESOURCE_H_ */
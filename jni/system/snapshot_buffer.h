@@ -0,0 +1,117 @@
+#ifndef PEGAS_SNAPSHOT_BUFFER_H_
+#define PEGAS_SNAPSHOT_BUFFER_H_
+
+#include <pthread.h>
+
+namespace pegas
+{
+	//two snapshots handed from the thread that owns the data to readers on
+	//other threads. Readers take the last published snapshot with acquire()
+	//and give it back with release(); it does not change in between. The
+	//owner fills the other snapshot between beginPublish() and endPublish(),
+	//usually at a frame boundary: beginPublish() waits until the last reader
+	//of the snapshot to be refilled has released it, readers never wait for
+	//the owner. Only one thread publishes.
+	template<typename Snapshot>
+	class SnapshotBuffer
+	{
+	public:
+		SnapshotBuffer();
+		~SnapshotBuffer();
+
+		//any thread
+		const Snapshot* acquire();
+		void release(const Snapshot* snapshot);
+
+		//publishing thread only
+		const Snapshot& getPublished() const { return m_snapshots[m_published]; }
+		Snapshot& beginPublish();
+		void endPublish();
+
+	private:
+		Snapshot m_snapshots[2];
+		int32 m_numReaders[2];
+		int32 m_published;
+
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_releaseCondition;
+
+	private:
+		SnapshotBuffer(const SnapshotBuffer& other);
+		SnapshotBuffer& operator=(const SnapshotBuffer& other);
+	};
+
+	//-----------------------------------------------------------------------------
+	//	SnapshotBuffer class implementation
+	//-----------------------------------------------------------------------------
+	template<typename Snapshot>
+	inline SnapshotBuffer<Snapshot>::SnapshotBuffer()
+		:m_published(0)
+	{
+		m_numReaders[0] = m_numReaders[1] = 0;
+
+		pthread_mutex_init(&m_mutex, NULL);
+		pthread_cond_init(&m_releaseCondition, NULL);
+	}
+
+	template<typename Snapshot>
+	inline SnapshotBuffer<Snapshot>::~SnapshotBuffer()
+	{
+		assert(m_numReaders[0] == 0 && m_numReaders[1] == 0 && "snapshot buffer destroyed while read");
+
+		pthread_cond_destroy(&m_releaseCondition);
+		pthread_mutex_destroy(&m_mutex);
+	}
+
+	template<typename Snapshot>
+	inline const Snapshot* SnapshotBuffer<Snapshot>::acquire()
+	{
+		pthread_mutex_lock(&m_mutex);
+		int32 index = m_published;
+		m_numReaders[index]++;
+		pthread_mutex_unlock(&m_mutex);
+
+		return &m_snapshots[index];
+	}
+
+	template<typename Snapshot>
+	inline void SnapshotBuffer<Snapshot>::release(const Snapshot* snapshot)
+	{
+		int32 index = (snapshot == &m_snapshots[0]) ? 0 : 1;
+		assert(snapshot == &m_snapshots[index] && "snapshot is not from this buffer");
+
+		pthread_mutex_lock(&m_mutex);
+		assert(m_numReaders[index] > 0 && "snapshot released more times than acquired");
+		if(--m_numReaders[index] == 0)
+		{
+			pthread_cond_signal(&m_releaseCondition);
+		}
+		pthread_mutex_unlock(&m_mutex);
+	}
+
+	template<typename Snapshot>
+	inline Snapshot& SnapshotBuffer<Snapshot>::beginPublish()
+	{
+		//nobody can acquire the unpublished snapshot, only old readers are waited for
+		int32 index = 1 - m_published;
+
+		pthread_mutex_lock(&m_mutex);
+		while(m_numReaders[index] > 0)
+		{
+			pthread_cond_wait(&m_releaseCondition, &m_mutex);
+		}
+		pthread_mutex_unlock(&m_mutex);
+
+		return m_snapshots[index];
+	}
+
+	template<typename Snapshot>
+	inline void SnapshotBuffer<Snapshot>::endPublish()
+	{
+		pthread_mutex_lock(&m_mutex);
+		m_published = 1 - m_published;
+		pthread_mutex_unlock(&m_mutex);
+	}
+}
+
+#endif /* PEGAS_SNAPSHOT_BUFFER_H_ */
@@ -8,7 +8,7 @@
 namespace pegas
 {
 	Timer::Timer()
-		:m_elapsed(0.0f), m_lastTime(0.0f)
+		:m_elapsed(0.0f), m_lastTime(0.0f), m_fixedStep(0.0), m_simulatedTime(0.0)
 	{
 		LOGI("Timer constructor");
 	}
@@ -21,12 +21,27 @@ namespace pegas
 
 	void Timer::update()
 	{
+		if(m_fixedStep > 0.0)
+		{
+			m_simulatedTime += m_fixedStep;
+		}
+
 		double currentTime = now();
 		m_elapsed = (float)(currentTime - m_lastTime);
 	}
 
+	void Timer::setFixedStep(double seconds)
+	{
+		m_fixedStep = seconds;
+	}
+
 	double Timer::now()
 	{
+		if(m_fixedStep > 0.0)
+		{
+			return m_simulatedTime;
+		}
+
 		timespec timeValue;
 		clock_gettime(CLOCK_MONOTONIC, &timeValue);
 
@@ -14,9 +14,15 @@ namespace pegas
 		double now();
 		float elapsed();
 
+		//fixed step mode: now() returns simulated time advanced by 'seconds'
+		//on every update() instead of the system clock (0 - system clock)
+		void setFixedStep(double seconds);
+
 	private:
 		float m_elapsed;
 		double m_lastTime;
+		double m_fixedStep;
+		double m_simulatedTime;
 	};
 }
 
@@ -0,0 +1,156 @@
+#include "../common.h"
+
+#include "worker_pool.h"
+#include "log.h"
+
+#include <unistd.h>
+
+namespace pegas
+{
+	WorkerPool::WorkerPool()
+		:m_numThreads(0), m_task(0), m_generation(0), m_numBusy(0), m_quit(false)
+	{
+		pthread_mutex_init(&m_mutex, NULL);
+		pthread_cond_init(&m_startCondition, NULL);
+		pthread_cond_init(&m_doneCondition, NULL);
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		destroy();
+
+		pthread_cond_destroy(&m_doneCondition);
+		pthread_cond_destroy(&m_startCondition);
+		pthread_mutex_destroy(&m_mutex);
+	}
+
+	void WorkerPool::create(int32 numThreads)
+	{
+		destroy();
+
+		LOGI("WorkerPool::create %d threads", numThreads);
+
+		m_quit = false;
+		m_threads.resize(numThreads);
+		m_contexts.resize(numThreads);
+
+		for(int32 i = 0; i < numThreads; i++)
+		{
+			m_contexts[i]._pool = this;
+			m_contexts[i]._workerIndex = i + 1;
+			m_contexts[i]._generation = m_generation;
+
+			if(pthread_create(&m_threads[i], NULL, threadProc, &m_contexts[i]) != 0)
+			{
+				LOGE("WorkerPool: failed to create thread %d", i);
+
+				m_threads.resize(i);
+				break;
+			}
+		}
+
+		m_numThreads = m_threads.size();
+	}
+
+	void WorkerPool::destroy()
+	{
+		if(m_threads.empty())
+		{
+			return;
+		}
+
+		pthread_mutex_lock(&m_mutex);
+		m_quit = true;
+		pthread_cond_broadcast(&m_startCondition);
+		pthread_mutex_unlock(&m_mutex);
+
+		for(size_t i = 0; i < m_threads.size(); i++)
+		{
+			pthread_join(m_threads[i], NULL);
+		}
+
+		m_threads.clear();
+		m_contexts.clear();
+		m_numThreads = 0;
+	}
+
+	void WorkerPool::execute(IWorkerTask* task)
+	{
+		assert(task != NULL && "task is null");
+
+		int32 numWorkers = getNumWorkers();
+		if(m_numThreads > 0)
+		{
+			pthread_mutex_lock(&m_mutex);
+			m_task = task;
+			m_numBusy = m_numThreads;
+			m_generation++;
+			pthread_cond_broadcast(&m_startCondition);
+			pthread_mutex_unlock(&m_mutex);
+		}
+
+		task->run(0, numWorkers);
+
+		if(m_numThreads > 0)
+		{
+			pthread_mutex_lock(&m_mutex);
+			while(m_numBusy > 0)
+			{
+				pthread_cond_wait(&m_doneCondition, &m_mutex);
+			}
+			m_task = 0;
+			pthread_mutex_unlock(&m_mutex);
+		}
+	}
+
+	int32 WorkerPool::getNumProcessors()
+	{
+		long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+
+		return (numProcessors > 0) ? (int32)numProcessors : 1;
+	}
+
+	void* WorkerPool::threadProc(void* param)
+	{
+		ThreadContext* context = static_cast<ThreadContext*>(param);
+		context->_pool->workerLoop(context->_workerIndex);
+
+		return NULL;
+	}
+
+	void WorkerPool::workerLoop(int32 workerIndex)
+	{
+		//generation seen at creation, a task started before the thread
+		//reached the lock is still picked up
+		int32 generation = m_contexts[workerIndex - 1]._generation;
+
+		pthread_mutex_lock(&m_mutex);
+		while(true)
+		{
+			while(!m_quit && generation == m_generation)
+			{
+				pthread_cond_wait(&m_startCondition, &m_mutex);
+			}
+
+			if(m_quit)
+			{
+				break;
+			}
+
+			generation = m_generation;
+			IWorkerTask* task = m_task;
+			int32 numWorkers = m_numThreads + 1;
+			pthread_mutex_unlock(&m_mutex);
+
+			task->run(workerIndex, numWorkers);
+
+			pthread_mutex_lock(&m_mutex);
+			m_numBusy--;
+			if(m_numBusy == 0)
+			{
+				pthread_cond_signal(&m_doneCondition);
+			}
+		}
+		pthread_mutex_unlock(&m_mutex);
+	}
+}
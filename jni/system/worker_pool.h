@@ -0,0 +1,64 @@
+#ifndef PEGAS_WORKER_POOL_H_
+#define PEGAS_WORKER_POOL_H_
+
+#include <pthread.h>
+
+namespace pegas
+{
+	//work split between the workers of a pool: run() is called once on
+	//every worker with its index (0 is the thread calling execute())
+	class IWorkerTask
+	{
+	public:
+		virtual ~IWorkerTask() {}
+
+		virtual void run(int32 workerIndex, int32 numWorkers) = 0;
+	};
+
+	//fixed set of pthreads sleeping on a condition variable between tasks.
+	//execute() wakes them, runs the calling thread as worker 0 and returns
+	//when every worker has finished the task. Tasks are not queued: the
+	//pool runs one task at a time and only one thread calls execute().
+	class WorkerPool
+	{
+	public:
+		WorkerPool();
+		~WorkerPool();
+
+		//numThreads threads besides the calling one (0 - no threads at all)
+		void create(int32 numThreads);
+		void destroy();
+
+		int32 getNumWorkers() const { return m_numThreads + 1; }
+		void execute(IWorkerTask* task);
+
+		//number of processors online (at least 1)
+		static int32 getNumProcessors();
+
+	private:
+		struct ThreadContext
+		{
+			WorkerPool* _pool;
+			int32 _workerIndex;
+			int32 _generation;
+		};
+
+		static void* threadProc(void* param);
+		void workerLoop(int32 workerIndex);
+
+		std::vector<pthread_t> m_threads;
+		std::vector<ThreadContext> m_contexts;
+		int32 m_numThreads;
+
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_startCondition;
+		pthread_cond_t m_doneCondition;
+
+		IWorkerTask* m_task;
+		int32 m_generation;
+		int32 m_numBusy;
+		bool m_quit;
+	};
+}
+
+#endif /* PEGAS_WORKER_POOL_H_ */